@@ -0,0 +1,151 @@
+/*
+ *  File: adikbank.cpp
+ *  Construit une banque de sons précompilée (.adkbank), chargée par projection en mémoire
+ *  Usage: adikbank [-r sampleRate] [-f float32|int16] [-m manifest] [-d mediaDir] [output.adkbank]
+ *  */
+//----------------------------------------
+
+#include "audiosample.h"
+#include "samplebank.h"
+#include "samplecache.h"
+#include "constants.h"
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <unistd.h> // Pour getopt
+
+//----------------------------------------
+
+// Ligne du manifeste: chemin relatif au répertoire des sons, et points de boucle optionnels (en frames)
+struct ManifestEntry {
+    std::string name;
+    int64_t loopStart = -1;
+    int64_t loopEnd = -1;
+};
+//----------------------------------------
+
+static void usage(const char* progName) {
+    std::cerr << "Usage: " << progName << " [-r sampleRate] [-f float32|int16] [-m manifest] [-d mediaDir] [output.adkbank]\n"
+              << "  -r: fréquence de la banque, celle du moteur qui la lira (défaut: " << adikdrum::SAMPLE_RATE << ")\n"
+              << "  -f: format des données (défaut: float32, lu sans copie; int16 divise la taille par 2)\n"
+              << "  -m: manifeste, un son par ligne: chemin [début fin de boucle] (défaut: SOUND_LIST)\n"
+              << "  -d: répertoire des sons (défaut: " << adikdrum::MEDIA_DIR << ")\n"
+              << "La banque doit rester dans le répertoire où elle est écrite (défaut: "
+              << adikdrum::SAMPLE_BANK_PATH << "):\n"
+              << "les noms des sons y sont relatifs.\n";
+}
+//----------------------------------------
+
+static bool readManifest(const std::string& filePath, std::vector<ManifestEntry>& entries) {
+    std::ifstream file(filePath);
+    if (!file) {
+        std::cerr << "Erreur: Impossible d'ouvrir le manifeste: " << filePath << std::endl;
+        return false;
+    }
+    std::string line;
+    while (std::getline(file, line)) {
+        line.erase(std::find(line.begin(), line.end(), '#'), line.end()); // Commentaires
+        std::istringstream iss(line);
+        ManifestEntry entry;
+        if (!(iss >> entry.name)) continue; // Ligne vide
+        if (iss >> entry.loopStart && !(iss >> entry.loopEnd)) {
+            std::cerr << "Erreur: Fin de boucle manquante pour " << entry.name << std::endl;
+            return false;
+        }
+        entries.push_back(entry);
+    }
+    return true;
+}
+//----------------------------------------
+
+int main(int argc, char* argv[]) {
+    int sampleRate = adikdrum::SAMPLE_RATE;
+    adikdrum::SampleBank::Format format = adikdrum::SampleBank::Format::Float32;
+    std::string manifestFile;
+    std::string mediaDir = adikdrum::MEDIA_DIR;
+    std::string outputFile = adikdrum::SAMPLE_BANK_PATH;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "r:f:m:d:h")) != -1) {
+        switch (opt) {
+            case 'r': sampleRate = std::atoi(optarg); break;
+            case 'f':
+                if (std::string(optarg) == "float32") {
+                    format = adikdrum::SampleBank::Format::Float32;
+                } else if (std::string(optarg) == "int16") {
+                    format = adikdrum::SampleBank::Format::Int16;
+                } else {
+                    usage(argv[0]);
+                    return 1;
+                }
+                break;
+            case 'm': manifestFile = optarg; break;
+            case 'd': mediaDir = optarg; break;
+            default: usage(argv[0]); return opt == 'h' ? 0 : 1;
+        }
+    }
+    if (optind < argc) {
+        outputFile = argv[optind];
+    }
+    if (std::find(adikdrum::SUPPORTED_SAMPLE_RATES.begin(), adikdrum::SUPPORTED_SAMPLE_RATES.end(), sampleRate)
+            == adikdrum::SUPPORTED_SAMPLE_RATES.end()) {
+        std::cerr << "Erreur: Fréquence d'échantillonnage non supportée: " << sampleRate << " Hz." << std::endl;
+        return 1;
+    }
+
+    std::vector<ManifestEntry> manifest;
+    if (manifestFile.empty()) {
+        for (const auto& name : adikdrum::SOUND_LIST) {
+            manifest.push_back({name});
+        }
+    } else if (!readManifest(manifestFile, manifest)) {
+        return 1;
+    }
+
+    const auto startTime = std::chrono::steady_clock::now();
+    // Noms relatifs au répertoire de la banque: c'est ainsi que le moteur les cherche
+    const auto bankDir = std::filesystem::absolute(outputFile).lexically_normal().parent_path();
+    // Les conversions de fréquence déjà faites par le moteur sont reprises
+    adikdrum::SampleCache cache(adikdrum::SAMPLE_CACHE_DIR);
+    std::vector<std::shared_ptr<adikdrum::AudioSample>> samples; // Gardent les données jusqu'à l'écriture
+    std::vector<adikdrum::SampleBank::Source> sources;
+    for (const auto& entry : manifest) {
+        const std::string filePath = mediaDir + "/" + entry.name;
+        auto sample = std::make_shared<adikdrum::AudioSample>(filePath, sampleRate, &cache);
+        if (sample->getLength() == 0) {
+            std::cerr << "Erreur: Impossible de charger " << filePath << std::endl;
+            return 1;
+        }
+        adikdrum::SampleBank::Source source;
+        source.name = std::filesystem::absolute(filePath).lexically_normal().lexically_relative(bankDir).generic_string();
+        source.data = sample->getData();
+        source.numFrames = sample->getNumFrames();
+        source.numChannels = sample->getNumChannels();
+        source.sampleRate = sampleRate;
+        source.bitDepth = sample->getBitDepth();
+        source.loopStart = entry.loopStart;
+        source.loopEnd = entry.loopEnd;
+        source.filePath = filePath;
+        sources.push_back(source);
+        samples.push_back(std::move(sample));
+    }
+
+    if (!adikdrum::SampleBank::write(outputFile, sources, format, sampleRate)) {
+        return 1;
+    }
+    const double elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+    std::cout << "Banque: " << outputFile << ", " << sources.size() << " sons à " << sampleRate << " Hz ("
+              << (format == adikdrum::SampleBank::Format::Int16 ? "int16" : "float32") << "), "
+              << std::filesystem::file_size(outputFile) << " octets, en " << elapsedMs << " ms." << std::endl;
+
+    return 0;
+}
+//----------------------------------------
@@ -0,0 +1,431 @@
+/*
+ *  File: adikbench.cpp
+ *  Micro-benchmarks du moteur audio: AudioMixer::mixSoundData, AudioSound::readData, SimpleDelay::processData,
+ *  mixkernels::gainClip, resampler::process (linear, hermite, sinc)
+ *  Résultats en JSON (ns/frame et marge en voix par coeur), pour suivre les régressions entre versions.
+ *  Usage: adikbench [-q] [-l scalar|sse2|avx2] [-o output.json]
+ *         adikbench -v (vérifie les noyaux vectorisés contre la version scalaire, la lecture des sons
+ *         compacts contre celle des sons en float, et le morceau compilé)
+ *  */
+//----------------------------------------
+
+#include "audiomixer.h"
+#include "audiosound.h"
+#include "simpledelay.h"
+#include "mixkernels.h"
+#include "resampler.h"
+#include "song.h"
+#include "constants.h"
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include <memory>
+#include <cmath>
+#include <unistd.h> // Pour getopt
+
+using namespace adikdrum;
+using BenchClock = std::chrono::steady_clock;
+
+//----------------------------------------
+
+struct BenchConfig {
+    size_t numVoices;
+    float speed;
+    size_t numChannels; // Canaux des sons sources
+    bool delay;
+    size_t blockSize;
+};
+
+struct BenchResult {
+    std::string kernel;
+    BenchConfig config;
+    double nsPerFrame;      // Temps par frame de sortie, toutes voix comprises
+    double nsPerVoiceFrame; // Temps par frame et par voix
+    double voicesPerCore;   // Nombre de voix tenables sur un coeur en temps réel
+};
+
+static const int sampleRate = SAMPLE_RATE;
+static const size_t framesPerRun = 16384; // Frames de sortie mesurées par répétition
+static const size_t soundFrames = 32768;  // Longueur des sons, suffisante pour speed <= 2
+static const int numRepeats = 3;          // On garde la meilleure des répétitions
+
+//----------------------------------------
+
+static std::vector<float> genNoise(size_t numSamples, unsigned int seed) {
+    std::mt19937 gen(seed);
+    std::uniform_real_distribution<float> distrib(-0.5f, 0.5f);
+    std::vector<float> data(numSamples);
+    for (auto& sample : data) sample = distrib(gen);
+    return data;
+}
+//----------------------------------------
+
+static BenchResult makeResult(const std::string& kernel, const BenchConfig& config, double bestNs, size_t numFrames, size_t numVoices) {
+    BenchResult result;
+    result.kernel = kernel;
+    result.config = config;
+    result.nsPerFrame = bestNs / numFrames;
+    result.nsPerVoiceFrame = result.nsPerFrame / numVoices;
+    // Budget temps réel d'une frame, divisé par le coût d'une voix
+    const double budgetNs = 1e9 / sampleRate;
+    result.voicesPerCore = result.nsPerVoiceFrame > 0.0 ? budgetNs / result.nsPerVoiceFrame : 0.0;
+    return result;
+}
+//----------------------------------------
+
+static BenchResult benchMixer(const BenchConfig& config) {
+    AudioMixer mixer(config.numVoices, std::max(config.numVoices, AudioMixer::defaultMaxVoices));
+    mixer.init(sampleRate, 2, 16, config.blockSize);
+
+    // Un son par voix: la position de lecture est dans la voix (VoiceState), des sons distincts
+    // ne font que répartir les adresses lues, comme un kit réel
+    auto data = genNoise(soundFrames * config.numChannels, 1);
+    std::vector<SoundPtr> sounds;
+    for (size_t i = 0; i < config.numVoices; ++i) {
+        sounds.push_back(std::make_shared<AudioSound>(data, config.numChannels, sampleRate));
+        sounds.back()->setSpeed(config.speed);
+        mixer.setDelayActive(i, config.delay);
+        mixer.setChannelPan(i, (static_cast<float>(i % 9) - 4.0f) / 4.0f);
+    }
+
+    std::vector<float> output(config.blockSize * 2);
+    double bestNs = 0.0;
+    for (int rep = 0; rep < numRepeats; ++rep) {
+        for (size_t i = 0; i < config.numVoices; ++i) {
+            mixer.play(i, sounds[i]);
+        }
+        double totalNs = 0.0;
+        for (size_t done = 0; done < framesPerRun; done += config.blockSize) {
+            std::fill(output.begin(), output.end(), 0.0f);
+            auto start = BenchClock::now();
+            mixer.mixSoundData(output.data(), config.blockSize, 2);
+            totalNs += std::chrono::duration<double, std::nano>(BenchClock::now() - start).count();
+        }
+        if (rep == 0 || totalNs < bestNs) bestNs = totalNs;
+    }
+    return makeResult("mixSoundData", config, bestNs, framesPerRun, config.numVoices);
+}
+//----------------------------------------
+
+static BenchResult benchReadData(const BenchConfig& config) {
+    AudioSound sound(genNoise(soundFrames * config.numChannels, 2), config.numChannels, sampleRate);
+    sound.setSpeed(config.speed);
+    std::vector<float> buffer(config.blockSize * config.numChannels);
+    double bestNs = 0.0;
+    for (int rep = 0; rep < numRepeats; ++rep) {
+        sound.resetCurPos();
+        sound.setActive(true);
+        auto start = BenchClock::now();
+        for (size_t done = 0; done < framesPerRun; done += config.blockSize) {
+            sound.readData(buffer.data(), config.blockSize);
+        }
+        double totalNs = std::chrono::duration<double, std::nano>(BenchClock::now() - start).count();
+        if (rep == 0 || totalNs < bestNs) bestNs = totalNs;
+    }
+    return makeResult("readData", config, bestNs, framesPerRun, 1);
+}
+//----------------------------------------
+
+static BenchResult benchResample(const BenchConfig& config, resampler::Interpolation interp) {
+    auto data = genNoise(soundFrames * config.numChannels, 5);
+    std::vector<float> buffer(config.blockSize * config.numChannels);
+    const uint64_t increment = resampler::speedToIncrement(config.speed);
+    double bestNs = 0.0;
+    for (int rep = 0; rep < numRepeats; ++rep) {
+        uint64_t phase = 0;
+        auto start = BenchClock::now();
+        for (size_t done = 0; done < framesPerRun; done += config.blockSize) {
+            resampler::process(buffer.data(), config.blockSize, data.data(), soundFrames, config.numChannels,
+                    phase, increment, interp);
+        }
+        double totalNs = std::chrono::duration<double, std::nano>(BenchClock::now() - start).count();
+        if (rep == 0 || totalNs < bestNs) bestNs = totalNs;
+    }
+    return makeResult(std::string("resample:") + resampler::getInterpolationName(interp), config, bestNs, framesPerRun, 1);
+}
+//----------------------------------------
+
+static BenchResult benchDelay(const BenchConfig& config) {
+    // Même réglage que les délais du mixer
+    const float delayTime = 0.500f;
+    SimpleDelay delay(static_cast<size_t>(delayTime * sampleRate), sampleRate);
+    delay.setDelayTime(delayTime);
+    delay.setFeedback(0.5f);
+    delay.setGain(0.5f);
+    delay.setActive(true);
+    auto buffer = genNoise(config.blockSize * config.numChannels, 3);
+    double bestNs = 0.0;
+    for (int rep = 0; rep < numRepeats; ++rep) {
+        auto start = BenchClock::now();
+        for (size_t done = 0; done < framesPerRun; done += config.blockSize) {
+            delay.processData(buffer.data(), config.blockSize, config.numChannels);
+        }
+        double totalNs = std::chrono::duration<double, std::nano>(BenchClock::now() - start).count();
+        if (rep == 0 || totalNs < bestNs) bestNs = totalNs;
+    }
+    return makeResult("processData", config, bestNs, framesPerRun, 1);
+}
+//----------------------------------------
+
+static BenchResult benchGainClip(const BenchConfig& config) {
+    // Sortie stéréo: numChannels ne s'applique pas ici
+    auto input = genNoise(config.blockSize * 2, 4);
+    std::vector<float> output(input.size());
+    double bestNs = 0.0;
+    for (int rep = 0; rep < numRepeats; ++rep) {
+        auto start = BenchClock::now();
+        for (size_t done = 0; done < framesPerRun; done += config.blockSize) {
+            mixkernels::gainClip(output.data(), input.data(), input.size(), 2.5f);
+        }
+        double totalNs = std::chrono::duration<double, std::nano>(BenchClock::now() - start).count();
+        if (rep == 0 || totalNs < bestNs) bestNs = totalNs;
+    }
+    return makeResult("gainClip", config, bestNs, framesPerRun, 1);
+}
+//----------------------------------------
+
+static float maxDiff(const std::vector<float>& a, const std::vector<float>& b) {
+    float diff = 0.0f;
+    for (size_t i = 0; i < a.size(); ++i) {
+        diff = std::max(diff, std::fabs(a[i] - b[i]));
+    }
+    return diff;
+}
+//----------------------------------------
+
+// Compare chaque niveau SIMD supporté à la version scalaire, sur des longueurs
+// qui ne sont pas multiples de la largeur des vecteurs et des buffers non alignés,
+// et la lecture des sons compacts (int16, int24) à celle des mêmes données en float.
+static bool verifyKernels() {
+    const float tolerance = 1e-6f;
+    const mixkernels::SimdLevel initialLevel = mixkernels::getSimdLevel();
+    bool ok = true;
+    for (auto level : {mixkernels::SimdLevel::SSE2, mixkernels::SimdLevel::AVX2}) {
+        if (!mixkernels::setSimdLevel(level)) {
+            std::cerr << mixkernels::getSimdLevelName(level) << ": non supporté par ce CPU." << std::endl;
+            continue;
+        }
+        float worst = 0.0f;
+        for (size_t numFrames : {0, 1, 3, 7, 8, 15, 17, 64, 255, 1027}) {
+            for (size_t shift : {0, 1}) {
+                auto in = genNoise(numFrames * 2 + shift, static_cast<unsigned int>(numFrames + 10));
+                auto base = genNoise(numFrames * 2 + shift, static_cast<unsigned int>(numFrames + 20));
+                const float* src = in.data() + shift;
+                const size_t len = numFrames * 2 + shift;
+
+                auto expected = base, actual = base;
+                mixkernels::scalar::panMonoToStereo(expected.data() + shift, src, numFrames, 0.7f, 1.3f);
+                mixkernels::panMonoToStereo(actual.data() + shift, src, numFrames, 0.7f, 1.3f);
+                worst = std::max(worst, maxDiff(expected, actual));
+
+                expected = base; actual = base;
+                mixkernels::scalar::addStereo(expected.data() + shift, src, numFrames, 0.4f, 1.6f);
+                mixkernels::addStereo(actual.data() + shift, src, numFrames, 0.4f, 1.6f);
+                worst = std::max(worst, maxDiff(expected, actual));
+
+                expected.assign(len, 0.0f); actual.assign(len, 0.0f);
+                mixkernels::scalar::gainClip(expected.data() + shift, src, numFrames * 2, 2.5f);
+                mixkernels::gainClip(actual.data() + shift, src, numFrames * 2, 2.5f);
+                worst = std::max(worst, maxDiff(expected, actual));
+            }
+        }
+        // Resampler: débuts et fins de son, positions fractionnaires, mono et stéréo
+        for (auto interp : {resampler::Interpolation::Linear, resampler::Interpolation::Hermite, resampler::Interpolation::Sinc}) {
+            for (size_t numChannels : {1, 2}) {
+                for (double speed : {0.37, 1.0, 1.5, 2.0}) {
+                    const size_t srcFrames = 301;
+                    auto src = genNoise(srcFrames * numChannels, static_cast<unsigned int>(numChannels + 30));
+                    std::vector<float> expected(1100 * numChannels, 0.0f), actual(expected);
+                    const uint64_t increment = resampler::speedToIncrement(speed);
+                    uint64_t phaseExpected = resampler::phaseOne / 3, phaseActual = phaseExpected;
+                    const size_t n1 = resampler::scalar::process(expected.data(), expected.size() / numChannels,
+                            src.data(), srcFrames, numChannels, phaseExpected, increment, interp);
+                    const size_t n2 = resampler::process(actual.data(), actual.size() / numChannels,
+                            src.data(), srcFrames, numChannels, phaseActual, increment, interp);
+                    worst = std::max(worst, maxDiff(expected, actual));
+                    if (n1 != n2 || phaseExpected != phaseActual) worst = std::max(worst, 1.0f);
+                }
+            }
+        }
+        // Sons compacts (int16, int24): même résultat que le son converti en float, y compris
+        // aux limites des fenêtres de conversion (son plus long que la fenêtre)
+        for (auto format : {resampler::SampleFormat::Int16, resampler::SampleFormat::Int24}) {
+            for (auto interp : {resampler::Interpolation::Linear, resampler::Interpolation::Hermite, resampler::Interpolation::Sinc}) {
+                for (size_t numChannels : {1, 2}) {
+                    for (double speed : {0.37, 1.0, 1.5, 2.0}) {
+                        const size_t srcFrames = 3001;
+                        const size_t numSamples = srcFrames * numChannels;
+                        std::mt19937 gen(static_cast<unsigned int>(numChannels + 40));
+                        std::vector<int16_t> data16(numSamples);
+                        std::vector<int32_t> data24(numSamples);
+                        for (size_t i = 0; i < numSamples; ++i) {
+                            data16[i] = static_cast<int16_t>(std::uniform_int_distribution<int>(-32768, 32767)(gen));
+                            data24[i] = std::uniform_int_distribution<int32_t>(-8388608, 8388607)(gen);
+                        }
+                        const void* src = format == resampler::SampleFormat::Int16
+                            ? static_cast<const void*>(data16.data()) : static_cast<const void*>(data24.data());
+                        std::vector<float> srcFloat(numSamples);
+                        resampler::convertSamples(srcFloat.data(), src, format, 0, numSamples);
+                        std::vector<float> expected(7000 * numChannels, 0.0f), actual(expected);
+                        const uint64_t increment = resampler::speedToIncrement(speed);
+                        uint64_t phaseExpected = resampler::phaseOne / 3, phaseActual = phaseExpected;
+                        const size_t n1 = resampler::process(expected.data(), expected.size() / numChannels,
+                                srcFloat.data(), srcFrames, numChannels, phaseExpected, increment, interp);
+                        const size_t n2 = resampler::process(actual.data(), actual.size() / numChannels,
+                                src, format, srcFrames, numChannels, phaseActual, increment, interp);
+                        worst = std::max(worst, maxDiff(expected, actual));
+                        if (n1 != n2 || phaseExpected != phaseActual) worst = std::max(worst, 1.0f);
+                    }
+                }
+            }
+        }
+        const bool levelOk = worst <= tolerance;
+        std::cerr << mixkernels::getSimdLevelName(level) << ": écart max " << worst
+                  << (levelOk ? " (OK)" : " (ÉCHEC)") << std::endl;
+        ok = ok && levelOk;
+    }
+    mixkernels::setSimdLevel(initialLevel);
+    return ok;
+}
+//----------------------------------------
+
+// Un morceau compilé après la suppression d'une section doit jouer les sections restantes comme avant
+static bool verifySong() {
+    AdikPattern first(2), second(1);
+    first.genData(3);
+    second.genData(5);
+    Song single, song;
+    single.addSection(first.getBars(), SongSection());
+    song.addSection(first.getBars(), SongSection());
+    song.addSection(second.getBars(), SongSection());
+    song.removeSection(1);
+    auto expected = single.compile(sampleRate, 120.0);
+    auto actual = song.compile(sampleRate, 120.0);
+    const bool ok = !expected->events.empty() && actual->events.size() == expected->events.size()
+        && actual->bars.size() == expected->bars.size() && actual->numFrames == expected->numFrames;
+    std::cerr << "Morceau: " << actual->events.size() << " coups sur " << expected->events.size()
+              << " après suppression d'une section" << (ok ? " (OK)" : " (ÉCHEC)") << std::endl;
+    return ok;
+}
+//----------------------------------------
+
+static void writeJson(std::ostream& out, const std::vector<BenchResult>& results) {
+    out << "{\n"
+        << "  \"sampleRate\": " << sampleRate << ",\n"
+        << "  \"framesPerRun\": " << framesPerRun << ",\n"
+        << "  \"simd\": \"" << mixkernels::getSimdLevelName(mixkernels::getSimdLevel()) << "\",\n"
+        << "  \"results\": [\n";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const auto& r = results[i];
+        out << "    {\"kernel\": \"" << r.kernel << "\""
+            << ", \"voices\": " << r.config.numVoices
+            << ", \"speed\": " << r.config.speed
+            << ", \"channels\": " << r.config.numChannels
+            << ", \"delay\": " << (r.config.delay ? "true" : "false")
+            << ", \"blockSize\": " << r.config.blockSize
+            << ", \"nsPerFrame\": " << r.nsPerFrame
+            << ", \"nsPerVoiceFrame\": " << r.nsPerVoiceFrame
+            << ", \"voicesPerCore\": " << r.voicesPerCore
+            << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n"
+        << "}\n";
+}
+//----------------------------------------
+
+int main(int argc, char* argv[]) {
+    bool quick = false;
+    bool verify = false;
+    std::string outputFile;
+    std::string levelName;
+    int opt;
+    while ((opt = getopt(argc, argv, "qvl:o:h")) != -1) {
+        switch (opt) {
+            case 'q': quick = true; break;
+            case 'v': verify = true; break;
+            case 'l': levelName = optarg; break;
+            case 'o': outputFile = optarg; break;
+            default:
+                std::cerr << "Usage: " << argv[0] << " [-q] [-v] [-l scalar|sse2|avx2] [-o output.json]\n"
+                          << "  -q: balayage réduit\n"
+                          << "  -v: vérifie les noyaux vectorisés contre la version scalaire, et le morceau compilé\n"
+                          << "  -l: force le jeu d'instructions des noyaux de mixage\n"
+                          << "  -o: fichier de sortie JSON (défaut: sortie standard)\n";
+                return opt == 'h' ? 0 : 1;
+        }
+    }
+
+    if (verify) {
+        const bool kernelsOk = verifyKernels();
+        const bool songOk = verifySong();
+        return kernelsOk && songOk ? 0 : 1;
+    }
+    if (!levelName.empty()) {
+        bool found = false;
+        for (auto level : {mixkernels::SimdLevel::Scalar, mixkernels::SimdLevel::SSE2, mixkernels::SimdLevel::AVX2}) {
+            if (levelName == mixkernels::getSimdLevelName(level)) {
+                found = true;
+                if (!mixkernels::setSimdLevel(level)) {
+                    std::cerr << "Erreur: " << levelName << " n'est pas supporté par ce CPU." << std::endl;
+                    return 1;
+                }
+            }
+        }
+        if (!found) {
+            std::cerr << "Erreur: Jeu d'instructions inconnu: " << levelName << std::endl;
+            return 1;
+        }
+    }
+
+    const std::vector<size_t> voiceCounts = quick ? std::vector<size_t>{1, 16, 256} : std::vector<size_t>{1, 4, 16, 64, 128, 256};
+    const std::vector<float> speeds = {1.0f, 1.5f};
+    const std::vector<size_t> channelCounts = {1, 2};
+    const std::vector<bool> delays = {false, true};
+    const std::vector<size_t> blockSizes = quick ? std::vector<size_t>{32, 256, 4096} : std::vector<size_t>{32, 64, 128, 256, 512, 1024, 2048, 4096};
+
+    // Les messages du moteur vont sur stderr, la sortie standard est réservée au JSON
+    std::ostream jsonOut(std::cout.rdbuf());
+    std::cout.rdbuf(std::cerr.rdbuf());
+
+    std::vector<BenchResult> results;
+    for (size_t blockSize : blockSizes) {
+        for (size_t numChannels : channelCounts) {
+            for (float speed : speeds) {
+                results.push_back(benchReadData({1, speed, numChannels, false, blockSize}));
+                for (size_t numVoices : voiceCounts) {
+                    for (bool delay : delays) {
+                        results.push_back(benchMixer({numVoices, speed, numChannels, delay, blockSize}));
+                    }
+                }
+            }
+            for (auto interp : {resampler::Interpolation::Linear, resampler::Interpolation::Hermite, resampler::Interpolation::Sinc}) {
+                results.push_back(benchResample({1, 1.5f, numChannels, false, blockSize}, interp));
+            }
+            results.push_back(benchDelay({1, 1.0f, numChannels, true, blockSize}));
+        }
+        results.push_back(benchGainClip({1, 1.0f, 2, false, blockSize}));
+        std::cerr << "Bloc de " << blockSize << " frames terminé." << std::endl;
+    }
+
+    if (outputFile.empty()) {
+        writeJson(jsonOut, results);
+    } else {
+        std::ofstream file(outputFile);
+        if (!file) {
+            std::cerr << "Erreur: Impossible d'écrire " << outputFile << std::endl;
+            return 1;
+        }
+        writeJson(file, results);
+    }
+
+    jsonOut.flush();
+    std::cout.rdbuf(jsonOut.rdbuf());
+    return 0;
+}
+//----------------------------------------
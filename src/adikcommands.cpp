@@ -171,6 +171,123 @@ const std::map<std::string, CommandAction> COMMAND_MAP = {
         },
         "speed <changement>: Change la vitesse de lecture (+/- 0.25 par exemple)."
     }},
+    {"poly", {
+        [](AdikDrum* drum, const std::vector<std::string>& args) {
+            if (drum && args.size() == 1) {
+                try {
+                    int maxPolyphony = std::stoi(args[0]);
+                    if (maxPolyphony >= 0) {
+                        drum->changePolyphony(static_cast<size_t>(maxPolyphony));
+                    }
+                } catch (const std::exception& e) {
+                    std::cerr << "Erreur Poly: " << e.what() << std::endl;
+                }
+            }
+        },
+        "poly <voix>: Nombre de coups simultanés du son courant (0: illimité)."
+    }},
+    {"interp", {
+        [](AdikDrum* drum, const std::vector<std::string>& args) {
+            if (drum && args.size() == 1) {
+                drum->changeInterpolation(args[0]);
+            }
+        },
+        "interp <linear|hermite|sinc>: Interpolation des sons joués à une autre vitesse."
+    }},
+    {"prefetch", {
+        [](AdikDrum* drum, const std::vector<std::string>& args) {
+            if (drum && args.size() == 1) {
+                try {
+                    float prefetchMs = std::stof(args[0]);
+                    drum->changePrefetch(prefetchMs);
+                } catch (const std::exception& e) {
+                    std::cerr << "Erreur Prefetch: " << e.what() << std::endl;
+                }
+            }
+        },
+        "prefetch <ms>: Profondeur de préchargement des sons longs lus en continu depuis le disque."
+    }},
+    {"kit", {
+        [](AdikDrum* drum, const std::vector<std::string>& args) {
+            if (drum && args.size() == 1) {
+                drum->changeKit(args[0]);
+            } else if (drum) {
+                drum->showKits();
+            }
+        },
+        "kit [nom]: Change de kit pendant la lecture, à la mesure suivante (sans nom: kits disponibles)."
+    }},
+    {"storage", {
+        [](AdikDrum* drum, const std::vector<std::string>& args) {
+            if (drum && args.size() == 1) {
+                drum->changeSampleStorage(args[0]);
+            }
+        },
+        "storage <float32|compact>: Stockage des sons du kit (compact: int16 ou 24 bits, sans perte)."
+    }},
+    {"budget", {
+        [](AdikDrum* drum, const std::vector<std::string>& args) {
+            if (drum && args.size() == 1) {
+                try {
+                    int budgetMb = std::stoi(args[0]);
+                    if (budgetMb >= 0) {
+                        drum->changeMemoryBudget(static_cast<size_t>(budgetMb));
+                    }
+                } catch (const std::exception& e) {
+                    std::cerr << "Erreur Budget: " << e.what() << std::endl;
+                }
+            }
+        },
+        "budget <Mo>: Mémoire des sons décodés (0: illimité); les sons les moins joués ne gardent que leur attaque."
+    }},
+    {"memory", {
+        [](AdikDrum* drum, const std::vector<std::string>& args) {
+            if (drum && args.size() == 1) {
+                try {
+                    int numSound = std::stoi(args[0]);
+                    if (numSound > 0) {
+                        drum->showMemoryReport(static_cast<size_t>(numSound));
+                    }
+                } catch (const std::exception& e) {
+                    std::cerr << "Erreur Memory: " << e.what() << std::endl;
+                }
+            } else if (drum) {
+                drum->showMemoryReport();
+            }
+        },
+        "memory [son]: Mémoire des sons du kit et économie du stockage compact, pour le son courant ou donné."
+    }},
+    {"song", {
+        [](AdikDrum* drum, const std::vector<std::string>& args) {
+            if (!drum) return;
+            try {
+                if (args.empty()) {
+                    drum->showSong();
+                } else if (args[0] == "add") {
+                    const int repeats = args.size() > 1 ? std::stoi(args[1]) : 1;
+                    const double bpm = args.size() > 2 ? std::stod(args[2]) : 0.0;
+                    const int velocity = args.size() > 3 ? std::stoi(args[3]) : 127;
+                    if (repeats > 0) {
+                        drum->addSongSection(static_cast<size_t>(repeats), bpm, velocity);
+                    }
+                } else if (args[0] == "del" && args.size() == 2) {
+                    const int numSection = std::stoi(args[1]);
+                    if (numSection > 0) {
+                        drum->removeSongSection(static_cast<size_t>(numSection));
+                    }
+                } else if (args[0] == "clear") {
+                    drum->clearSong();
+                } else if (args[0] == "play") {
+                    drum->setSongMode(true);
+                } else if (args[0] == "stop") {
+                    drum->setSongMode(false);
+                }
+            } catch (const std::exception& e) {
+                std::cerr << "Erreur Song: " << e.what() << std::endl;
+            }
+        },
+        "song [add [répétitions] [bpm] [vélocité] | del <n> | clear | play | stop]: Morceau fait de copies du pattern courant (sons mutés coupés)."
+    }},
     {"delay", {
         [](AdikDrum* drum, [[maybe_unused]] const std::vector<std::string>& args) {
             if (drum) {
@@ -187,6 +304,22 @@ const std::map<std::string, CommandAction> COMMAND_MAP = {
         },
         "clear: Efface tous les pas du son courant."
     }},
+    {"undo", {
+        [](AdikDrum* drum, [[maybe_unused]] const std::vector<std::string>& args) {
+            if (drum) {
+                drum->undo();
+            }
+        },
+        "undo: Annule la dernière modification du pattern."
+    }},
+    {"redo", {
+        [](AdikDrum* drum, [[maybe_unused]] const std::vector<std::string>& args) {
+            if (drum) {
+                drum->redo();
+            }
+        },
+        "redo: Rétablit la dernière modification annulée."
+    }},
     {"record", {
         [](AdikDrum* drum, [[maybe_unused]] const std::vector<std::string>& args) {
             if (drum) {
@@ -219,22 +352,40 @@ const std::map<std::string, CommandAction> COMMAND_MAP = {
     {"load", {
         [](AdikDrum* drum, const std::vector<std::string>& args) {
             if (drum && args.size() == 1) {
-                // drum->loadPattern(args[0]); // Supposons que loadPattern prend un nom de fichier
+                drum->loadProject(args[0]);
             } else if (drum && args.empty()) {
-                drum->loadPattern(); // S'il y a une version sans argument (par défaut/dernier)
+                drum->loadProject(); // Recharge le dernier projet
             }
         },
-        "load [fichier]: Charge un pattern depuis un fichier ou le dernier chargé."
+        "load [fichier]: Charge un projet (pattern, tempo, sons et kit) ou recharge le dernier."
     }},
     {"save", {
         [](AdikDrum* drum, const std::vector<std::string>& args) {
             if (drum && args.size() == 1) {
-                // drum->savePattern(args[0]); // Supposons que savePattern prend un nom de fichier
+                drum->saveProject(args[0]);
             } else if (drum && args.empty()) {
-                // drum->savePattern(); // S'il y a une version sans argument (sauvegarde par défaut)
+                drum->saveProject(); // Dernier projet chargé ou sauvegardé
+            }
+        },
+        "save [fichier]: Sauvegarde le projet dans un fichier (.adkp) ou le dernier utilisé."
+    }},
+    {"export", {
+        [](AdikDrum* drum, const std::vector<std::string>& args) {
+            if (drum) {
+                drum->exportProject(args.empty() ? std::string() : args[0]);
+            }
+        },
+        "export [fichier]: Exporte le projet en texte (.txt), pour comparer deux versions."
+    }},
+    {"stats", {
+        [](AdikDrum* drum, const std::vector<std::string>& args) {
+            if (drum && args.size() == 1 && args[0] == "reset") {
+                drum->resetDspStats();
+            } else if (drum) {
+                drum->showDspStats();
             }
         },
-        "save [fichier]: Sauvegarde le pattern dans un fichier ou le dernier utilisé."
+        "stats [reset]: Affiche la charge DSP, les xruns et les voix actives, ou remet les compteurs à zéro."
     }},
     {"help", {
         [](AdikDrum* drum, [[maybe_unused]] const std::vector<std::string>& args) {
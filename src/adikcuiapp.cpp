@@ -7,6 +7,7 @@
 #include <termios.h>
 #include <unistd.h>
 #include <sstream>
+#include <cstdlib>
 
 namespace adikdrum {
 
@@ -58,6 +59,8 @@ void AdikCUIApp::run() {
     char key;
     while (read(STDIN_FILENO, &key, 1) == 1) {
         if (key == 'Q') break;
+        // Sons chargés en arrière-plan (read est bloquant: pris en compte à chaque touche)
+        adikDrum_.pollLoadedSounds();
 
         if (key == '\n') { // Touche Enter
             adikDrum_.selectStep();
@@ -121,6 +124,7 @@ void AdikCUIApp::run() {
                 adikDrum_.moveCursorLeft();
             } // End arrow keys conditions
         } // End main key handling
+        adikDrum_.pollPattern(); // Modifications du pattern publiées pour le thread audio
     } // End the while Loop
 
 }
@@ -165,10 +169,18 @@ void AdikCUIApp::displayGrid(const std::vector<std::vector<bool>>& grid, std::pa
 
 } // namespace adikdrum
 
-int main() {
+int main(int argc, char* argv[]) {
     adikdrum::AdikDrum adikDrumApp(nullptr); // Créer AdikDrum sans UIApp pour l'instant
     adikdrum::AdikCUIApp consoleUI(adikDrumApp); // Créer AdikCUIApp en passant une référence à AdikDrum
     adikDrumApp.uiApp_ = &consoleUI; // Assigner l'UIApp à AdikDrum
+
+    // Usage: adikcui [-r sampleRate]
+    int opt;
+    while ((opt = getopt(argc, argv, "r:h")) != -1) {
+        if (opt == 'r' && adikDrumApp.setSampleRate(std::atoi(optarg))) continue;
+        std::cerr << "Usage: " << argv[0] << " [-r 44100|48000|96000]" << std::endl;
+        return opt == 'h' ? 0 : 1;
+    }
     if (!adikDrumApp.initApp()) {
         return false; // Changer le code de retour en cas d'erreur
     }
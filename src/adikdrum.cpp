@@ -14,15 +14,18 @@
 #include "drumplayer.h"
 #include "audiomixer.h"
 #include "constants.h"
+#include "memusage.h"
 
 #include <iostream>
 #include <string>
 #include <vector>
 #include <cmath>
+#include <iomanip>
 #include <algorithm>
 #include <map>
 #include <utility> // Pour utiliser std::pair
 #include <random>
+#include <filesystem>
 
 // for performance checking
 #include <thread>
@@ -44,10 +47,11 @@ void beep() {
 AdikDrum::AdikDrum(UIApp* uiApp)
     : uiApp_(uiApp),
       cursorPos({0, 0}),
-      sampleRate_(44100),
+      sampleRate_(SAMPLE_RATE),
       mixer_(32),
       numSounds_(16),
       numSteps_(16),
+      soundLoader_(SAMPLE_LOADER_THREADS),
       drumPlayer_(numSounds_, numSteps_),
       msgText_(""), // Initialisation optionnelle
       previousMsgText_("")
@@ -92,6 +96,8 @@ AdikDrum::AdikDrum(UIApp* uiApp)
                 "  Delete: Effacer le dernier son joué au pas de lecture actuel\n"
                 "  Ctrl+D: Effacer toutes les occurrences du son au curseur (dans tout le pattern)\n" // Nouveau raccourci
                 "  Ctrl+K: Effacer toutes les occurrences du dernier son joué (dans tout le pattern)\n" // Nouveau raccourci
+                "  Ctrl+Z: Annuler la dernière modification du pattern (aussi u, si u ne joue pas de son)\n"
+                "  U / Ctrl+Y: Rétablir la modification annulée\n"
                 "  Touches [q-k, a-i]: Jouer le son correspondant\n"
                 "  Touches [1-8]: Jouer le son correspondant\n"; // Ajout de cette ligne
 
@@ -104,11 +110,32 @@ AdikDrum::~AdikDrum() {
 }
 //----------------------------------------
 
+bool AdikDrum::setSampleRate(int sampleRate) {
+    if (std::find(SUPPORTED_SAMPLE_RATES.begin(), SUPPORTED_SAMPLE_RATES.end(), sampleRate) == SUPPORTED_SAMPLE_RATES.end()) {
+        std::cerr << "Erreur: Fréquence d'échantillonnage non supportée: " << sampleRate << " Hz." << std::endl;
+        return false;
+    }
+    sampleRate_ = sampleRate;
+    return true;
+}
+//----------------------------------------
+
 bool AdikDrum::initApp() {
-    const int numChannelsMixer = 32; // Clarifier le nom pour le mixer
-    const int sampleRate = 44100;
+    const int sampleRate = sampleRate_;
     const int framesPerBuffer = 256; // Nouvelle variable pour la taille du buffer
-    mixer_ = AudioMixer(numChannelsMixer);
+    const int numOutputChannels = 2; // Définir explicitement le nombre de canaux de sortie
+    // Note: mixer_ est construit une seule fois (32 canaux), dans le constructeur:
+    // il n'est pas copiable, ses voix pointent sur les données des sons.
+    // Préallouer les buffers de mixage, avant le démarrage du flux audio
+    if (!mixer_.init(sampleRate, numOutputChannels, 16, framesPerBuffer)) {
+        std::cerr << "Erreur lors de l'initialisation du mixer." << std::endl;
+        return false;
+    }
+    // Libère hors du thread audio les sons et buffers remplacés pendant la lecture
+    mixer_.getReclaimer().start();
+    // Lit la suite des sons longs pendant leur lecture
+    mixer_.getDiskStreamer().start();
+    mixer_.getMemoryManager().setBudget(SAMPLE_MEMORY_BUDGET_MB * 1024 * 1024);
 
     // Générer les sons du métronome
     SoundPtr soundClick1 = mixer_.genTone("buzzer", 880.0, 50); // Son aigu
@@ -122,16 +149,26 @@ bool AdikDrum::initApp() {
     drumData_.player = &drumPlayer_;
     drumData_.mixer = &mixer_;
     drumData_.sampleRate = sampleRate;
+    drumData_.stats = &dspStats_;
     drumPlayer_.setMixer(mixer_); // Assigner le mixer à player
+    drumPlayer_.setSampleRate(sampleRate);
+    SampleStorage storage = SampleStorage::Float32;
+    parseSampleStorage(SAMPLE_STORAGE, storage);
+    mixer_.setSampleStorage(storage);
+    // Banque précompilée (adikbank): ses sons sont lus dans la projection, sans décodage
+    if (std::filesystem::exists(SAMPLE_BANK_PATH) && mixer_.getSampleBank().open(SAMPLE_BANK_PATH)) {
+        std::cout << "Banque de sons: " << SAMPLE_BANK_PATH << " (" << mixer_.getSampleBank().getNumEntries() << " sons)" << std::endl;
+    }
     loadSounds(); // charger les sons
     // genTones();
-    drumPlayer_.drumSounds_ = this->getDrumSounds();
+    drumPlayer_.setSounds(this->getDrumSounds());
+    // Après setSounds: les buffers évincés passent par le Reclaimer des sons
+    mixer_.getMemoryManager().start();
 
     // Assigner les sons du métronome à DrumPlayer
     drumPlayer_.soundClick1_ = soundClick1;
     drumPlayer_.soundClick2_ = soundClick2;
 
-    const int numOutputChannels = 2; // Définir explicitement le nombre de canaux de sortie
     if (!audioDriver_.init(numOutputChannels, sampleRate, framesPerBuffer, &drumData_)) {
     // if (!audioDriver_.init(numOutputChannels, sampleRate, framesPerBuffer, drumMachineCallback, &drumData_)) {
         std::cerr << "Erreur lors de l'initialisation de l'AudioDriver." << std::endl;
@@ -144,6 +181,8 @@ bool AdikDrum::initApp() {
         return 1;
     }
 
+    // Sons arrivés pendant le démarrage du flux audio
+    pollLoadedSounds();
     // Tester les sons
     demo();
 
@@ -155,7 +194,11 @@ bool AdikDrum::initApp() {
 //----------------------------------------
 
 void AdikDrum::closeApp() {
+    soundLoader_.cancel();
     audioDriver_.stop();
+    mixer_.getMemoryManager().stop();
+    mixer_.getDiskStreamer().stop();
+    mixer_.getReclaimer().stop();
     // audioDriver_.close(); // not nessary cause it managing by the AudioDriver's destructor
     std::cout << "AdikDrum fermé." << std::endl;
 
@@ -166,18 +209,19 @@ void AdikDrum::loadSounds() {
     auto soundCount = SOUND_LIST.size();
     drumSounds_.clear();
     drumSounds_.resize(soundCount); // Redimensionner drumSounds_ en fonction du nombre de fichiers à charger
-
-    for (size_t i = 0; i < soundCount; ++i) {
-        std::string filePath = MEDIA_DIR + "/" + SOUND_LIST[i]; // Construire le chemin complet du fichier
-        SoundPtr sound = mixer_.loadSound(filePath); // Charger le fichier
-
-        if (sound->getLength() > 0) {
-            drumSounds_[i] = sound;
-            std::cout << "Loaded " << SOUND_LIST[i] << " at index " << i << std::endl;
-        } else {
-            std::cerr << "Error loading " << filePath << ". Loading default sound instead." << std::endl;
-        }
-    }
+    mixer_.getMemoryManager().clear();
+    loadedSounds_.clear();
+
+    kitName_ = DEFAULT_KIT;
+    getKitFiles(kitName_, kitFiles_);
+    // Les fichiers sont décodés en parallèle, dans l'ordre des pads
+    soundLoader_.start(kitFiles_, [this](const std::string& filePath) { return mixer_.loadSound(filePath); });
+    // Seuls les premiers pads sont attendus: pollLoadedSounds transmet les suivants pendant la lecture
+    soundLoader_.waitFor(NUM_READY_PADS);
+    soundLoader_.takeLoaded(loadedSounds_);
+    storeLoadedSounds(false);
+    std::cout << soundLoader_.getNumDone() << "/" << soundCount << " sons chargés avant le démarrage ("
+              << soundLoader_.getNumThreads() << " threads)" << std::endl;
 
     /*
     float fadeOutStartPercentage = 0.3f;
@@ -192,6 +236,200 @@ void AdikDrum::loadSounds() {
 }
 //----------------------------------------
 
+void AdikDrum::pollPattern() {
+    drumPlayer_.pollPattern();
+    // Après pollPattern: les pas enregistrés pendant la lecture font aussi partie de l'historique
+    if (drumPlayer_.curPattern_) history_.commit(*drumPlayer_.curPattern_);
+}
+//----------------------------------------
+
+void AdikDrum::undo() {
+    if (!drumPlayer_.curPattern_) return;
+    if (!history_.undo(*drumPlayer_.curPattern_)) {
+        msgText_ = "Rien à annuler";
+        displayMessage(msgText_);
+        return;
+    }
+    drumPlayer_.publishPattern();
+    msgText_ = "Annulé (" + history_.getReport() + ")";
+    displayMessage(msgText_);
+    displayGrid(drumPlayer_.curPattern_->getPatternBar(drumPlayer_.curPattern_->getCurrentBar()), cursorPos);
+}
+//----------------------------------------
+
+void AdikDrum::redo() {
+    if (!drumPlayer_.curPattern_) return;
+    if (!history_.redo(*drumPlayer_.curPattern_)) {
+        msgText_ = "Rien à rétablir";
+        displayMessage(msgText_);
+        return;
+    }
+    drumPlayer_.publishPattern();
+    msgText_ = "Rétabli (" + history_.getReport() + ")";
+    displayMessage(msgText_);
+    displayGrid(drumPlayer_.curPattern_->getPatternBar(drumPlayer_.curPattern_->getCurrentBar()), cursorPos);
+}
+//----------------------------------------
+
+void AdikDrum::pollLoadedSounds() {
+    pollPattern();
+    // Anciens sons retirés dès que le thread audio a pris le nouveau kit
+    if (drumPlayer_.isKitPending() && drumPlayer_.pollKit()) {
+        msgText_ = "Kit " + kitName_ + " actif";
+        displayMessage(msgText_);
+    }
+    if (!nextKitName_.empty()) {
+        pollKitSounds();
+        return;
+    }
+    if (soundLoader_.takeLoaded(loadedSounds_) == 0 && loadedSounds_.empty()) return;
+    storeLoadedSounds(true);
+
+    const size_t numDone = soundLoader_.getNumDone();
+    if (soundLoader_.isLoading()) {
+        msgText_ = "Chargement des sons: " + std::to_string(numDone) + "/" + std::to_string(soundLoader_.getNumTotal());
+    } else {
+        msgText_ = std::to_string(numDone - soundLoader_.getNumFailed()) + " sons chargés en "
+            + std::to_string(static_cast<long>(soundLoader_.getElapsedMs())) + " ms ("
+            + std::to_string(soundLoader_.getNumThreads()) + " threads), " + soundLoader_.getMemoryReport();
+    }
+    displayMessage(msgText_);
+}
+//----------------------------------------
+
+void AdikDrum::storeLoadedSounds(bool toPlayer) {
+    auto it = loadedSounds_.begin();
+    for (; it != loadedSounds_.end(); ++it) {
+        const size_t index = it->first;
+        const SoundPtr& sound = it->second;
+        if (!sound) {
+            std::cerr << "Error loading " << kitFiles_[index] << ". Loading default sound instead." << std::endl;
+            continue;
+        }
+        // Chargé avant un changement de stockage (changeSampleStorage): pas encore joué, converti ici
+        sound->setSampleStorage(mixer_.getSampleStorage());
+        // File de commandes pleine: le son sera transmis au prochain appel
+        if (toPlayer && !drumPlayer_.setSound(index, sound)) break;
+        drumSounds_[index] = sound;
+        // Compté dans le budget mémoire: évincé s'il n'est pas joué, rechargé ensuite depuis son fichier
+        mixer_.getMemoryManager().addSound(sound, kitFiles_[index]);
+        std::cout << "Loaded " << kitFiles_[index] << " at index " << index << std::endl;
+    }
+    loadedSounds_.erase(loadedSounds_.begin(), it);
+}
+//----------------------------------------
+
+bool AdikDrum::getKitFiles(const std::string& name, std::vector<std::string>& filePaths) const {
+    filePaths.clear();
+    if (name == DEFAULT_KIT) {
+        for (const auto& fileName : SOUND_LIST) {
+            filePaths.push_back(MEDIA_DIR + "/" + fileName); // Construire le chemin complet du fichier
+        }
+        return true;
+    }
+    // Sous-répertoire des sons: ses fichiers audio par ordre alphabétique, un par pad
+    const std::filesystem::path kitDir = std::filesystem::path(MEDIA_DIR) / name;
+    std::error_code ec;
+    if (name.empty() || name.find("..") != std::string::npos || !std::filesystem::is_directory(kitDir, ec)) return false;
+    for (const auto& entry : std::filesystem::directory_iterator(kitDir, ec)) {
+        std::string ext = entry.path().extension().string();
+        std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) { return std::tolower(c); });
+        if (entry.is_regular_file(ec) && (ext == ".wav" || ext == ".aif" || ext == ".aiff" || ext == ".flac" || ext == ".ogg")) {
+            filePaths.push_back(entry.path().string());
+        }
+    }
+    std::sort(filePaths.begin(), filePaths.end());
+    if (filePaths.size() > drumSounds_.size()) filePaths.resize(drumSounds_.size());
+    return !filePaths.empty();
+}
+//----------------------------------------
+
+void AdikDrum::changeKit(const std::string& name) {
+    std::vector<std::string> filePaths;
+    if (!getKitFiles(name, filePaths)) {
+        msgText_ = "Kit introuvable: " + name + " (" + DEFAULT_KIT + ", ou sous-répertoire de " + MEDIA_DIR + ")";
+        displayMessage(msgText_);
+        return;
+    }
+    loadKitFiles(name, std::move(filePaths));
+}
+//----------------------------------------
+
+bool AdikDrum::loadKitFiles(const std::string& name, std::vector<std::string> filePaths) {
+    // Un seul chargement à la fois: le kit courant doit être complet et le précédent changement fait
+    if (soundLoader_.isLoading() || !loadedSounds_.empty() || !nextKitName_.empty() || !drumPlayer_.pollKit()) {
+        msgText_ = "Chargement de sons en cours, changement de kit impossible pour l'instant";
+        displayMessage(msgText_);
+        return false;
+    }
+    if (filePaths.size() > drumSounds_.size()) filePaths.resize(drumSounds_.size());
+    nextKitName_ = name;
+    nextKitFiles_ = std::move(filePaths);
+    // Décodés en arrière-plan pendant la lecture; l'ancien kit joue jusqu'au changement
+    soundLoader_.start(nextKitFiles_, [this](const std::string& filePath) { return mixer_.loadSound(filePath); });
+    msgText_ = "Chargement du kit " + name + ": " + std::to_string(nextKitFiles_.size()) + " sons";
+    displayMessage(msgText_);
+    return true;
+}
+//----------------------------------------
+
+void AdikDrum::pollKitSounds() {
+    // Lu avant takeLoaded: un chargement terminé a rangé tous ses sons
+    const bool loading = soundLoader_.isLoading();
+    soundLoader_.takeLoaded(loadedSounds_);
+    if (loading) {
+        msgText_ = "Chargement du kit " + nextKitName_ + ": " + std::to_string(soundLoader_.getNumDone())
+            + "/" + std::to_string(soundLoader_.getNumTotal());
+        displayMessage(msgText_);
+        return;
+    }
+
+    std::vector<SoundPtr> sounds(drumSounds_.size());
+    for (const auto& [index, sound] : loadedSounds_) {
+        if (!sound) {
+            std::cerr << "Error loading " << nextKitFiles_[index] << "." << std::endl;
+            continue;
+        }
+        // Chargé avant un changement de stockage (changeSampleStorage): pas encore joué, converti ici
+        sound->setSampleStorage(mixer_.getSampleStorage());
+        sounds[index] = sound;
+    }
+    if (!drumPlayer_.setKit(sounds)) return; // Changement précédent pas encore pris: au prochain appel
+    loadedSounds_.clear();
+
+    // Le budget mémoire porte maintenant sur le nouveau kit
+    SampleMemoryManager& manager = mixer_.getMemoryManager();
+    manager.clear();
+    for (size_t i = 0; i < sounds.size() && i < nextKitFiles_.size(); ++i) {
+        if (sounds[i]) manager.addSound(sounds[i], nextKitFiles_[i]);
+    }
+    drumSounds_ = std::move(sounds);
+    kitName_ = std::move(nextKitName_);
+    kitFiles_ = std::move(nextKitFiles_);
+    nextKitName_.clear();
+    nextKitFiles_.clear();
+    msgText_ = "Kit " + kitName_ + ": " + std::to_string(soundLoader_.getNumDone() - soundLoader_.getNumFailed())
+        + " sons chargés en " + std::to_string(static_cast<long>(soundLoader_.getElapsedMs()))
+        + " ms, actif à la prochaine mesure";
+    displayMessage(msgText_);
+}
+//----------------------------------------
+
+void AdikDrum::showKits() {
+    msgText_ = "Kit: " + kitName_ + ", disponibles: " + DEFAULT_KIT;
+    std::vector<std::string> names;
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator(MEDIA_DIR, ec)) {
+        if (entry.is_directory(ec)) names.push_back(entry.path().filename().string());
+    }
+    std::sort(names.begin(), names.end());
+    for (const auto& name : names) {
+        msgText_ += ", " + name;
+    }
+    displayMessage(msgText_);
+}
+//----------------------------------------
+
 
 void AdikDrum::genTones() {
     const float defaultFrequency = 440.0;
@@ -243,15 +481,17 @@ void AdikDrum::demo(int numSound) {
     // Tester les sons
     msgText_ = "Demo en train de jouer";
     displayMessage(msgText_);
+    // Note: un son encore en cours de chargement est sauté
     if (numSound == -1) {
         for (size_t i = 0; i < NUM_SOUNDS; ++i) {
+            if (!drumSounds_[i]) continue;
             drumPlayer_.playSound(i);
-            long long sleepDurationMs = static_cast<long long>(drumPlayer_.drumSounds_[i]->getSize() * 1000.0 / sampleRate_ * 1.0);
+            long long sleepDurationMs = static_cast<long long>(drumSounds_[i]->getSize() * 1000.0 / sampleRate_ * 1.0);
             std::this_thread::sleep_for(std::chrono::milliseconds(sleepDurationMs));
         }
-    } else {
+    } else if (static_cast<size_t>(numSound) < drumSounds_.size() && drumSounds_[numSound]) {
         drumPlayer_.playSound(numSound);
-        long long sleepDurationMs = static_cast<long long>(drumPlayer_.drumSounds_[numSound]->getSize() * 1000.0 / sampleRate_ * 1.0);
+        long long sleepDurationMs = static_cast<long long>(drumSounds_[numSound]->getSize() * 1000.0 / sampleRate_ * 1.0);
         std::this_thread::sleep_for(std::chrono::milliseconds(sleepDurationMs));
     }
     
@@ -313,7 +553,7 @@ void AdikDrum::selectStep() {
     // Utiliser la barre courante du pattern
     size_t currentBar = drumPlayer_.curPattern_->getCurrentBar();
     // Accéder et modifier directement le pas dans la barre courante du pattern
-    drumPlayer_.curPattern_->getPatternBar(currentBar)[cursorPos.second][cursorPos.first] = true;
+    drumPlayer_.curPattern_->setNote(currentBar, cursorPos.second, cursorPos.first, true);
     msgText_ = "Step " + std::to_string(cursorPos.first + 1) + " on sound " + std::to_string(cursorPos.second + 1) + " activated and playing.";
     displayMessage(msgText_);
     drumPlayer_.playSound(cursorPos.second);
@@ -326,7 +566,7 @@ void AdikDrum::unselectStep() {
     // Utiliser la barre courante du pattern
     size_t currentBar = drumPlayer_.curPattern_->getCurrentBar();
     // Accéder et modifier directement le pas dans la barre courante du pattern
-    drumPlayer_.curPattern_->getPatternBar(currentBar)[cursorPos.second][cursorPos.first] = false;
+    drumPlayer_.curPattern_->clearNote(currentBar, cursorPos.second, cursorPos.first);
     msgText_ = "Step " + std::to_string(cursorPos.first + 1) + " on sound " + std::to_string(cursorPos.second + 1) + " deactivated.";
     displayMessage(msgText_);
     // Afficher la grille mise à jour pour la barre courante
@@ -443,9 +683,9 @@ void AdikDrum::resetMute() {
 //----------------------------------------
 
 void AdikDrum::changeVolume(float deltaVolume) {
-    float currentVolume = mixer_.getGlobalVolume();
-    mixer_.setGlobalVolume(std::clamp(currentVolume + deltaVolume, 0.0f, 1.0f));
-    msgText_ = "Volume global: " + std::to_string(static_cast<int>(mixer_.getGlobalVolume() * 10)) + "/10";
+    float currentVolume = drumPlayer_.getGlobalVolume();
+    drumPlayer_.setGlobalVolume(std::clamp(currentVolume + deltaVolume, 0.0f, 1.0f));
+    msgText_ = "Volume global: " + std::to_string(static_cast<int>(drumPlayer_.getGlobalVolume() * 10)) + "/10";
     displayMessage(msgText_);
 }
 //----------------------------------------
@@ -453,6 +693,8 @@ void AdikDrum::changeVolume(float deltaVolume) {
 void AdikDrum::changeBpm(float deltaBpm) {
     auto bpm = drumPlayer_.getBpm();
     drumPlayer_.setBpm(bpm + deltaBpm);
+    // Les sections sans tempo suivent celui du lecteur
+    if (!song_.isEmpty()) updateSong();
     msgText_ = "BPM réglé à " + std::to_string(drumPlayer_.getBpm());
     displayMessage(msgText_);
 }
@@ -460,10 +702,74 @@ void AdikDrum::changeBpm(float deltaBpm) {
 
 void AdikDrum::changePan(float deltaPan) {
     int currentChannelIndex = cursorPos.second + 1;
-    float currentPan = mixer_.getChannelPan(currentChannelIndex);
-    mixer_.setChannelPan(currentChannelIndex, std::clamp(currentPan + deltaPan, -1.0f, 1.0f));
+    float currentPan = drumPlayer_.getChannelPan(currentChannelIndex);
+    drumPlayer_.setChannelPan(currentChannelIndex, std::clamp(currentPan + deltaPan, -1.0f, 1.0f));
     msgText_ = "Pan du canal " + std::to_string(currentChannelIndex) +
-               " réglé à " + std::to_string(mixer_.getChannelPan(currentChannelIndex));
+               " réglé à " + std::to_string(drumPlayer_.getChannelPan(currentChannelIndex));
+    displayMessage(msgText_);
+}
+//----------------------------------------
+
+void AdikDrum::changeInterpolation(const std::string& name) {
+    resampler::Interpolation interp;
+    if (!resampler::parseInterpolation(name, interp)) {
+        msgText_ = "Interpolation inconnue: " + name + " (linear, hermite, sinc)";
+        displayMessage(msgText_);
+        return;
+    }
+    drumPlayer_.setInterpolation(interp);
+    msgText_ = std::string("Interpolation des sons: ") + resampler::getInterpolationName(interp);
+    displayMessage(msgText_);
+}
+//----------------------------------------
+
+void AdikDrum::changeSampleStorage(const std::string& name) {
+    SampleStorage storage;
+    if (!parseSampleStorage(name, storage)) {
+        msgText_ = "Stockage inconnu: " + name + " (float32, compact)";
+        displayMessage(msgText_);
+        return;
+    }
+    // Sons encore en chargement: convertis par loadSound, ou à leur arrivée (storeLoadedSounds)
+    mixer_.setSampleStorage(storage);
+    // Sons du kit: nouveaux buffers publiés comme une modification des données,
+    // les voix en cours finissent sur les anciens, libérés par le Reclaimer.
+    // Par le gestionnaire de mémoire, qui peut évincer ou recharger les mêmes sons.
+    const size_t numConverted = mixer_.getMemoryManager().convertSounds(drumSounds_, storage);
+    msgText_ = std::string("Stockage des sons: ") + getSampleStorageName(storage) + ", "
+        + std::to_string(numConverted) + " sons convertis";
+    displayMessage(msgText_);
+}
+//----------------------------------------
+
+void AdikDrum::changePrefetch(float prefetchMs) {
+    // Lu par le thread d'E/S à chaque passage: pas besoin de passer par le thread audio
+    DiskStreamer& streamer = mixer_.getDiskStreamer();
+    if (!streamer.setPrefetchMs(prefetchMs)) {
+        msgText_ = "Préchargement invalide: " + std::to_string(prefetchMs) + " ms (maximum "
+            + std::to_string(static_cast<int>(DiskStreamer::maxPrefetchMs)) + " ms)";
+    } else {
+        msgText_ = "Préchargement des sons longs: " + std::to_string(static_cast<int>(prefetchMs)) + " ms";
+    }
+    displayMessage(msgText_);
+}
+//----------------------------------------
+
+void AdikDrum::changeMemoryBudget(size_t budgetMb) {
+    // Lu par le thread du gestionnaire à chaque passage
+    SampleMemoryManager& manager = mixer_.getMemoryManager();
+    manager.setBudget(budgetMb * 1024 * 1024);
+    msgText_ = "Budget mémoire des sons: " + (budgetMb == 0 ? std::string("illimité") : std::to_string(budgetMb) + " Mo")
+        + ", résident: " + std::to_string(manager.getResidentBytes() / 1024) + " Ko";
+    displayMessage(msgText_);
+}
+//----------------------------------------
+
+void AdikDrum::changePolyphony(size_t maxPolyphony) {
+    int currentChannelIndex = cursorPos.second + 1;
+    drumPlayer_.setChannelPolyphony(currentChannelIndex, maxPolyphony);
+    msgText_ = "Polyphonie du canal " + std::to_string(currentChannelIndex) +
+               " réglée à " + (maxPolyphony > 0 ? std::to_string(maxPolyphony) + " voix" : "illimitée");
     displayMessage(msgText_);
 }
 //----------------------------------------
@@ -504,16 +810,16 @@ void AdikDrum::playCurrentSound() {
 
 void AdikDrum::changeSpeed(float speed) {
     int currentChannelIndex =  drumPlayer_.getLastSoundIndex() + 1;
-    mixer_.setSpeed(currentChannelIndex, std::clamp(mixer_.getChannelList()[currentChannelIndex].speed + speed, 0.25f, 4.0f));
-    std::string msgText = "Vitesse du canal " + std::to_string(currentChannelIndex) + " réglée à " + std::to_string(mixer_.getChannelList()[currentChannelIndex].speed);
+    drumPlayer_.setChannelSpeed(currentChannelIndex, std::clamp(drumPlayer_.getChannelSpeed(currentChannelIndex) + speed, 0.25f, 4.0f));
+    std::string msgText = "Vitesse du canal " + std::to_string(currentChannelIndex) + " réglée à " + std::to_string(drumPlayer_.getChannelSpeed(currentChannelIndex));
     displayMessage(msgText);
 }
 //----------------------------------------
 
 void AdikDrum::toggleDelay() {
     int currentChannelIndex =  drumPlayer_.getLastSoundIndex() + 1;
-    bool active = mixer_.isDelayActive(currentChannelIndex);
-    mixer_.setDelayActive(currentChannelIndex, !active);
+    bool active = drumPlayer_.isChannelDelayActive(currentChannelIndex);
+    drumPlayer_.setChannelDelay(currentChannelIndex, !active);
     msgText_ = "Délai du Canal (" + std::to_string(currentChannelIndex + 1) +
                ") est maintenant " + (active ? "désactivé" : "activé") + ".";
 
@@ -547,7 +853,7 @@ void AdikDrum::changeBar(int delta) {
     size_t barIndex = std::clamp(barInt, 0, static_cast<int>(numBars -1));
 
     // Set the new position, keeping the current step
-    drumPlayer_.curPattern_->setPosition(barIndex, 0);
+    drumPlayer_.setPosition(barIndex, 0);
 
     msgText_ = "Mesure changée à : " + std::to_string(barIndex + 1) + "/" + std::to_string(numBars);
     displayMessage(msgText_);
@@ -564,7 +870,7 @@ void AdikDrum::gotoStart() {
         displayMessage(msgText_);
         return;
     }
-    curPattern->setPosition(0, 0);
+    drumPlayer_.setPosition(0, 0);
     auto curBar = curPattern->getCurrentBar();
     auto numBars = curPattern->getNumBars();
 
@@ -582,7 +888,7 @@ void AdikDrum::gotoEnd() {
     }
     size_t numBars = drumPlayer_.curPattern_->getNumBars();
     if (numBars > 0) {
-        drumPlayer_.curPattern_->setPosition(numBars - 1, drumPlayer_.curPattern_->getCurrentStep());
+        drumPlayer_.setPosition(numBars - 1, drumPlayer_.curPattern_->getCurrentStep());
         msgText_ = "Dernière mesure: " + std::to_string(numBars) + "/" + std::to_string(numBars);
         displayMessage(msgText_);
         displayGrid(drumPlayer_.curPattern_->getPatternBar(numBars - 1), cursorPos);
@@ -602,6 +908,9 @@ void AdikDrum::toggleRecord() {
     if (drumPlayer_.isRecording()) { // Si c'était en enregistrement, on l'arrête
         drumPlayer_.stopRecord();
         msgText_ = "Enregistrement: INACTIF. Lecture continue.";
+    } else if (drumPlayer_.isSongMode()) {
+        // Les sections jouent des copies des patterns: rien où fusionner les pas enregistrés
+        msgText_ = "Enregistrement impossible en mode morceau: song stop pour enregistrer dans le pattern.";
     } else { // Si ce n'était pas en enregistrement, on le démarre
         drumPlayer_.startRecord();
         msgText_ = "Enregistrement: ACTIF. Métronome et lecture démarrés.";
@@ -811,6 +1120,77 @@ void AdikDrum::showStatus() {
 }
 //----------------------------------------
 
+void AdikDrum::showDspStats() {
+    const Reclaimer& reclaimer = mixer_.getReclaimer();
+    msgText_ = dspStats_.getReport()
+        + ", À libérer: " + std::to_string(reclaimer.getBytesPending()) + " octets ("
+        + std::to_string(reclaimer.getNumPending()) + " objets), Libérés: "
+        + std::to_string(reclaimer.getBytesFreed()) + " octets, "
+        + std::to_string(mixer_.getSampleRate()) + " Hz (cache des sons convertis: "
+        + std::to_string(mixer_.getSampleCache().getNumHits()) + " lus, "
+        + std::to_string(mixer_.getSampleCache().getNumMisses()) + " convertis, banque: "
+        + std::to_string(mixer_.getSampleBank().getNumHits()) + " lus), " + soundLoader_.getMemoryReport();
+    const DiskStreamer& streamer = mixer_.getDiskStreamer();
+    msgText_ += ", Flux: " + std::to_string(streamer.getNumActiveStreams()) + "/" + std::to_string(streamer.getMaxStreams())
+        + ", manques: " + std::to_string(streamer.getNumUnderruns()) + " (" + std::to_string(streamer.getNumUnderrunFrames())
+        + " frames), refusés: " + std::to_string(streamer.getNumRefused())
+        + ", lus: " + std::to_string(streamer.getBytesRead()) + " octets";
+    msgText_ += ", " + mixer_.getMemoryManager().getReport() + ", " + mixer_.getSamplePool().getReport();
+    msgText_ += ", " + drumPlayer_.getPatternReport() + ", " + history_.getReport();
+    displayMessage(msgText_);
+}
+//----------------------------------------
+
+std::string AdikDrum::getDspStatusLine() const {
+    std::string line = dspStats_.getStatusLine();
+    if (soundLoader_.isLoading()) {
+        line += ", Sons: " + std::to_string(soundLoader_.getNumDone()) + "/" + std::to_string(soundLoader_.getNumTotal());
+    }
+    return line;
+}
+//----------------------------------------
+
+void AdikDrum::showMemoryReport(size_t numSound) {
+    // Le gestionnaire de mémoire peut remplacer les buffers pendant la lecture
+    auto lock = mixer_.getMemoryManager().lockSounds();
+    size_t numBytes = 0;
+    size_t floatBytes = 0;
+    size_t numByFormat[3] = {};
+    for (const auto& sound : drumSounds_) {
+        if (!sound || !sound->getSampleBuffer()) continue;
+        numBytes += sound->getNumBytes();
+        floatBytes += sound->getSize() * sizeof(float);
+        ++numByFormat[static_cast<size_t>(sound->getSampleBuffer()->getFormat())];
+    }
+    msgText_ = std::string("Mémoire des sons (") + getSampleStorageName(mixer_.getSampleStorage()) + "): "
+        + memusage::formatSavings(numBytes, floatBytes) + ", float32: " + std::to_string(numByFormat[0])
+        + ", int16: " + std::to_string(numByFormat[1]) + ", int24: " + std::to_string(numByFormat[2]);
+    const size_t index = numSound > 0 ? numSound - 1 : cursorPos.second;
+    if (index < drumSounds_.size() && drumSounds_[index] && drumSounds_[index]->getSampleBuffer()) {
+        const SoundPtr& sound = drumSounds_[index];
+        msgText_ += ", son " + std::to_string(index + 1)
+            + (index < kitFiles_.size() ? " (" + kitFiles_[index] + ")" : std::string()) + ": "
+            + resampler::getSampleFormatName(sound->getSampleBuffer()->getFormat()) + ", "
+            + memusage::formatSavings(sound->getNumBytes(), sound->getSize() * sizeof(float));
+    }
+    lock.unlock();
+    msgText_ += ", " + mixer_.getMemoryManager().getReport();
+    msgText_ += ", RSS: " + std::to_string(memusage::getCurrentRssKb()) + " Ko (pic "
+        + std::to_string(memusage::getPeakRssKb()) + " Ko)";
+    displayMessage(msgText_);
+}
+//----------------------------------------
+
+void AdikDrum::resetDspStats() {
+    dspStats_.reset();
+    mixer_.getDiskStreamer().resetStats();
+    mixer_.getMemoryManager().resetStats();
+    drumPlayer_.resetPatternStats();
+    msgText_ = "Statistiques DSP remises à zéro.";
+    displayMessage(msgText_);
+}
+//----------------------------------------
+
 void AdikDrum::setPlayQuantizeResolution(size_t reso) {
     drumPlayer_.setPlayQuantizeResolution(reso);
     msgText_ = "Résolution de la quantisation en lecture: " + std::to_string(reso);
@@ -920,6 +1300,222 @@ void AdikDrum::loadData() {
 }
 //----------------------------------------
 
+ProjectData AdikDrum::getProjectData() const {
+    ProjectData project;
+    project.kitName = kitName_;
+    project.kitFiles = kitFiles_;
+    project.bpm = drumPlayer_.getBpm();
+    project.globalVolume = drumPlayer_.getGlobalVolume();
+    for (size_t i = 0; i < drumPlayer_.getNumSounds(); ++i) {
+        ProjectData::Channel channel;
+        channel.volume = drumPlayer_.getChannelVolume(i + 1);
+        channel.pan = drumPlayer_.getChannelPan(i + 1);
+        channel.speed = drumPlayer_.getChannelSpeed(i + 1);
+        channel.delay = drumPlayer_.isChannelDelayActive(i + 1);
+        channel.muted = drumPlayer_.isSoundMuted(i);
+        project.channels.push_back(channel);
+    }
+    if (drumPlayer_.curPattern_) project.patterns.push_back(drumPlayer_.curPattern_->getBars());
+    // Patterns du morceau après le pattern courant
+    const size_t firstSongPattern = project.patterns.size();
+    project.patterns.insert(project.patterns.end(), song_.getPatterns().begin(), song_.getPatterns().end());
+    project.songSections = song_.getSections();
+    for (auto& section : project.songSections) section.pattern += firstSongPattern;
+    return project;
+}
+//----------------------------------------
+
+std::string AdikDrum::getProjectPath(const std::string& filePath, const std::string& ext) const {
+    if (filePath.empty()) return projectPath_;
+    std::filesystem::path path(filePath);
+    if (!path.has_extension()) path += ext;
+    return path.string();
+}
+//----------------------------------------
+
+void AdikDrum::saveProject(const std::string& filePath) {
+    const std::string path = getProjectPath(filePath, PROJECT_EXT);
+    if (path.empty()) {
+        msgText_ = "Aucun projet en cours: save <fichier>";
+        displayMessage(msgText_);
+        return;
+    }
+    // Les barres du pattern sont partagées, pas copiées
+    if (!projectfile::write(path, getProjectData())) {
+        msgText_ = "Erreur: Impossible de sauvegarder le projet " + path;
+        displayMessage(msgText_);
+        return;
+    }
+    projectPath_ = path;
+    msgText_ = "Projet sauvegardé: " + path;
+    displayMessage(msgText_);
+}
+//----------------------------------------
+
+void AdikDrum::loadProject(const std::string& filePath) {
+    const std::string path = getProjectPath(filePath, PROJECT_EXT);
+    if (path.empty()) {
+        msgText_ = "Aucun projet en cours: load <fichier>";
+        displayMessage(msgText_);
+        return;
+    }
+    const auto startTime = std::chrono::steady_clock::now();
+    ProjectData project;
+    if (!projectfile::read(path, project) || project.patterns.empty() || !drumPlayer_.curPattern_) {
+        msgText_ = "Erreur: Impossible de charger le projet " + path;
+        displayMessage(msgText_);
+        return;
+    }
+
+    drumPlayer_.setBpm(project.bpm);
+    drumPlayer_.setGlobalVolume(project.globalVolume);
+    const size_t numChannels = std::min(project.channels.size(), drumPlayer_.getNumSounds());
+    for (size_t i = 0; i < numChannels; ++i) {
+        const ProjectData::Channel& channel = project.channels[i];
+        drumPlayer_.setChannelVolume(i + 1, channel.volume);
+        drumPlayer_.setChannelPan(i + 1, channel.pan);
+        drumPlayer_.setChannelSpeed(i + 1, channel.speed);
+        drumPlayer_.setChannelDelay(i + 1, channel.delay);
+        if (drumPlayer_.isSoundMuted(i) != channel.muted) drumPlayer_.setSoundMuted(i, channel.muted);
+    }
+    // Le morceau ne garde que les patterns que ses sections jouent
+    if (!song_.setContent(project.patterns, std::move(project.songSections))) song_.clear();
+    updateSong();
+    // Remplace les barres de la copie de travail: le chargement peut être annulé (undo)
+    const size_t numBars = project.patterns.front().size();
+    drumPlayer_.curPattern_->setBars(std::move(project.patterns.front()));
+    drumPlayer_.setPosition(0, 0);
+    const double elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+    projectPath_ = path;
+
+    // Sons du projet: ses fichiers s'ils sont tous là, sinon ceux du kit du même nom
+    std::string kitStatus;
+    size_t numMissing = 0;
+    std::error_code ec;
+    for (const auto& file : project.kitFiles) {
+        if (!std::filesystem::is_regular_file(file, ec)) ++numMissing;
+    }
+    if (!project.kitFiles.empty() && numMissing == 0) {
+        if (project.kitFiles != kitFiles_ || project.kitName != kitName_) {
+            // À la mesure suivante, une fois ses sons chargés
+            // Nom non vide: il marque le changement de kit en cours (pollLoadedSounds)
+            const std::string kitName = project.kitName.empty() ? std::filesystem::path(path).stem().string() : project.kitName;
+            kitStatus = loadKitFiles(kitName, std::move(project.kitFiles)) ? ", en chargement" : ", non chargé (chargement en cours)";
+        }
+    } else if (!project.kitName.empty()) {
+        if (numMissing > 0) kitStatus = ", " + std::to_string(numMissing) + " fichiers de sons absents: sons du kit";
+        if (project.kitName != kitName_) {
+            changeKit(project.kitName);
+            if (nextKitName_.empty()) kitStatus += ", non chargé";
+        }
+    }
+    std::ostringstream oss;
+    oss << "Projet chargé: " << path << " (" << numBars << " mesures, kit " << project.kitName << kitStatus
+        << ", " << std::fixed << std::setprecision(3) << elapsedMs << " ms)";
+    msgText_ = oss.str();
+    displayMessage(msgText_);
+    displayGrid(drumPlayer_.curPattern_->getPatternBar(0), cursorPos);
+}
+//----------------------------------------
+
+void AdikDrum::updateSong() {
+    const auto startTime = std::chrono::steady_clock::now();
+    songTimeline_ = song_.compile(sampleRate_, drumPlayer_.getBpm());
+    songCompileMs_ = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+    drumPlayer_.setSong(songTimeline_);
+}
+//----------------------------------------
+
+void AdikDrum::addSongSection(size_t repeats, double bpm, int velocity) {
+    if (!drumPlayer_.curPattern_) return;
+    if (repeats == 0 || !isValidSongBpm(bpm) || velocity < 1 || velocity > 127) {
+        msgText_ = "Section invalide: répétitions > 0, bpm 0 ou de 5 à 800, vélocité de 1 à 127";
+        displayMessage(msgText_);
+        return;
+    }
+    SongSection section;
+    section.repeats = repeats;
+    section.bpm = bpm;
+    section.velocity = static_cast<uint8_t>(velocity);
+    for (size_t i = 0; i < drumPlayer_.getNumSounds() && i < AdikPattern::maxTracks; ++i) {
+        if (drumPlayer_.isSoundMuted(i)) section.muted.set(i, true);
+    }
+    // Barres partagées avec le pattern courant: le modifier ensuite ne change pas la section
+    const size_t index = song_.addSection(drumPlayer_.curPattern_->getBars(), section);
+    updateSong();
+    msgText_ = "Section " + std::to_string(index + 1) + " ajoutée. " + song_.getReport();
+    displayMessage(msgText_);
+}
+//----------------------------------------
+
+void AdikDrum::removeSongSection(size_t numSection) {
+    if (numSection == 0 || !song_.removeSection(numSection - 1)) {
+        msgText_ = "Section inexistante: " + std::to_string(numSection);
+        displayMessage(msgText_);
+        return;
+    }
+    updateSong();
+    if (song_.isEmpty()) drumPlayer_.setSongMode(false);
+    msgText_ = "Section " + std::to_string(numSection) + " supprimée. " + song_.getReport();
+    displayMessage(msgText_);
+}
+//----------------------------------------
+
+void AdikDrum::clearSong() {
+    song_.clear();
+    updateSong();
+    drumPlayer_.setSongMode(false);
+    msgText_ = "Morceau effacé";
+    displayMessage(msgText_);
+}
+//----------------------------------------
+
+void AdikDrum::setSongMode(bool active) {
+    if (active && song_.isEmpty()) {
+        msgText_ = "Morceau vide: song add [répétitions] [bpm] [vélocité]";
+        displayMessage(msgText_);
+        return;
+    }
+    drumPlayer_.setSongMode(active);
+    msgText_ = active ? "Mode morceau: lecture des sections depuis le début" : "Mode pattern";
+    if (active && drumPlayer_.isRecording()) {
+        drumPlayer_.stopRecord();
+        msgText_ += ", enregistrement arrêté (impossible en mode morceau)";
+    }
+    displayMessage(msgText_);
+}
+//----------------------------------------
+
+void AdikDrum::showSong() {
+    std::ostringstream oss;
+    oss << song_.getReport();
+    if (songTimeline_ && songTimeline_->numFrames > 0) {
+        oss << std::fixed << std::setprecision(1) << ", durée " << songTimeline_->numFrames / songTimeline_->sampleRate
+            << " s, " << songTimeline_->events.size() << " coups, compilé en " << std::setprecision(3)
+            << songCompileMs_ << " ms";
+    }
+    if (drumPlayer_.isSongMode()) oss << ", section jouée: " << drumPlayer_.getSongSection() + 1;
+    msgText_ = oss.str();
+    displayMessage(msgText_);
+}
+//----------------------------------------
+
+void AdikDrum::exportProject(const std::string& filePath) {
+    // Sans fichier: à côté du projet courant, avec l'extension texte
+    std::string path = getProjectPath(filePath, PROJECT_TEXT_EXT);
+    if (filePath.empty() && !path.empty()) {
+        path = std::filesystem::path(path).replace_extension(PROJECT_TEXT_EXT).string();
+    }
+    if (path.empty() || !projectfile::writeText(path, getProjectData())) {
+        msgText_ = "Erreur: Impossible d'exporter le projet " + path;
+        displayMessage(msgText_);
+        return;
+    }
+    msgText_ = "Projet exporté en texte: " + path;
+    displayMessage(msgText_);
+}
+//----------------------------------------
+
 
 void AdikDrum::test() {
     drumPlayer_.setPlayQuantizeResolution(8);
@@ -5,7 +5,13 @@
 #include "drumplayer.h"
 #include "audiomixer.h"
 #include "audiosound.h"
+#include "dspstats.h"
+#include "patternhistory.h"
+#include "projectfile.h"
+#include "song.h"
+#include "sampleloader.h"
 #include "uiapp.h" // Inclure l'interface UIApp
+#include "constants.h"
 #include <vector>
 #include <string>
 #include <sstream>
@@ -19,6 +25,7 @@ public:
         DrumPlayer* player;
         AudioMixer* mixer;
         double sampleRate;
+        DspStats* stats; // Charge DSP et xruns, mis à jour par le callback
     };
 
     UIApp* uiApp_; // Pointeur vers l'objet UIApp
@@ -31,9 +38,26 @@ public:
     AdikDrum(UIApp* uiApp); // Constructeur prend un pointeur UIApp
     ~AdikDrum();
 
+    // Fréquence du moteur audio, parmi SUPPORTED_SAMPLE_RATES; à choisir avant initApp
+    bool setSampleRate(int sampleRate);
+    int getSampleRate() const { return sampleRate_; }
     bool initApp();
     void closeApp();
+    // Charge les sons en parallèle; ne rend la main qu'une fois les NUM_READY_PADS premiers prêts
     void loadSounds();
+    // Thread UI: transmet au DrumPlayer les sons chargés depuis le dernier appel, et affiche la progression
+    void pollLoadedSounds();
+    // Thread UI: publie les modifications du pattern pour le thread audio (à appeler après chaque édition)
+    void pollPattern();
+    // Annule ou rétablit la dernière modification du pattern (pas, effacements, pattern chargé)
+    void undo();
+    void redo();
+    // Charge le kit name en arrière-plan (DEFAULT_KIT, ou sous-répertoire de MEDIA_DIR),
+    // puis le fait prendre par le thread audio à la mesure suivante, sans arrêter la lecture
+    void changeKit(const std::string& name);
+    void showKits();
+    const std::string& getKitName() const { return kitName_; }
+    bool isLoadingSounds() const { return soundLoader_.isLoading(); }
     const std::vector<SoundPtr>& getDrumSounds() const;
     void demo(int numSound=16);
     void loadPattern();
@@ -67,6 +91,11 @@ public:
     void changeSpeed(float speed);
     void genTones();
     void toggleDelay();
+    void changePolyphony(size_t maxPolyphony);
+    void changeInterpolation(const std::string& name);
+    void changePrefetch(float prefetchMs);
+    void changeSampleStorage(const std::string& name);
+    void changeMemoryBudget(size_t budgetMb);
     void changeShiftPad(size_t deltaShiftPad);
     void changeBar(int delta);
     void gotoStart();
@@ -84,6 +113,11 @@ public:
     void toggleHelp(); // Pour basculer l'affichage de l'aide
     bool isHelpDisplayed() const { return helpDisplayed_; }
     void showStatus();
+    void showDspStats();
+    void resetDspStats();
+    // Mémoire des sons du kit, et du son numSound (1: premier son; 0: son courant)
+    void showMemoryReport(size_t numSound = 0);
+    std::string getDspStatusLine() const;
     const std::string& getMsgText() const { return msgText_; }
     void setPlayQuantizeResolution(size_t reso);
     void setRecQuantizeResolution(size_t reso);
@@ -92,6 +126,20 @@ public:
     void quantizeStepsFromSound();
     void saveData();
     void loadData();
+    // Fichier de projet (voir projectfile.h): pattern, tempo, paramètres des sons et kit.
+    // Sans extension, PROJECT_EXT est ajoutée; filePath vide: dernier projet chargé ou sauvegardé
+    void saveProject(const std::string& filePath = "");
+    void loadProject(const std::string& filePath = "");
+    // Export texte du projet courant, pour comparer deux versions (diff)
+    void exportProject(const std::string& filePath);
+    // Morceau (song.h): chaque section ajoutée joue le pattern courant tel qu'il est, sans les sons mutés.
+    // bpm 0: tempo du lecteur; vélocité de 1 à 127. Recompilé et publié à chaque modification.
+    void addSongSection(size_t repeats, double bpm = 0.0, int velocity = 127);
+    void removeSongSection(size_t numSection); // 1: première section
+    void clearSong();
+    // En mode morceau, la lecture suit les sections au lieu du pattern courant
+    void setSongMode(bool active);
+    void showSong();
 
 
     void test();
@@ -104,17 +152,43 @@ private:
     size_t numSounds_;
     size_t numSteps_;
     std::vector<SoundPtr> drumSounds_; // Membre public pour stocker les sons
+    SampleLoader soundLoader_; // Après mixer_: ses threads chargent avec mixer_.loadSound
+    std::vector<std::pair<size_t, SoundPtr>> loadedSounds_; // Chargés, pas encore transmis au DrumPlayer
+    std::string kitName_ = DEFAULT_KIT;
+    std::vector<std::string> kitFiles_;     // Fichiers des sons du kit, par pad
+    std::string nextKitName_;               // Kit en cours de chargement (changeKit), vide sinon
+    std::vector<std::string> nextKitFiles_;
     SoundPtr soundClick1_;
     SoundPtr soundClick2_;
     int initialBpm_;
     DrumPlayer drumPlayer_; // Note: il faut Déclarer drumPlayer_ APRÈS numSounds_ et numSteps_, pour l'ordre d'initialisation des membres
     DrumMachineData drumData_;
+    DspStats dspStats_;
+    PatternHistory history_; // Modifications de drumPlayer_.curPattern_, retenues à chaque pollPattern
     std::string msgText_;
     std::string previousMsgText_; 
+    std::string projectPath_; // Dernier projet chargé ou sauvegardé
+    Song song_;
+    std::shared_ptr<const SongTimeline> songTimeline_; // Dernière compilation de song_, publiée au DrumPlayer
+    double songCompileMs_ = 0.0;
 
 
     size_t shiftPadIndex_ =0;
 
+    // Range les sons de loadedSounds_ dans drumSounds_; toPlayer: les transmet aussi au DrumPlayer (lecture en cours)
+    void storeLoadedSounds(bool toPlayer);
+    // Transmet le kit de changeKit au DrumPlayer une fois tous ses sons chargés
+    void pollKitSounds();
+    bool getKitFiles(const std::string& name, std::vector<std::string>& filePaths) const;
+    // Charge filePaths (un fichier par pad) en arrière-plan comme kit name (changeKit, projet).
+    // Renvoie false si un chargement est déjà en cours.
+    bool loadKitFiles(const std::string& name, std::vector<std::string> filePaths);
+    ProjectData getProjectData() const;
+    // Compile song_ et le publie au DrumPlayer
+    void updateSong();
+    // filePath avec l'extension ext s'il n'en a pas; projectPath_ si filePath est vide
+    std::string getProjectPath(const std::string& filePath, const std::string& ext) const;
+
 };
 
 //==== End of class AdikDrum ====
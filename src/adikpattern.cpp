@@ -1,60 +1,46 @@
 #include "adikpattern.h"
-#include <algorithm> // Pour std::clamp
+#include <algorithm> // Pour std::clamp, std::none_of
 #include <random>    // Pour la génération aléatoire
 namespace adikdrum {
 
 // Constructeur par défaut
-AdikPattern::AdikPattern()
+template <size_t MaxTracks>
+BasicPattern<MaxTracks>::BasicPattern()
     : numBars_(1), numSoundsPerBar_(16) { // Initialisation par défaut : 1 barre, 16 sons
     currentBar_ =0;
-    patternData_.resize(numBars_);
-    for (size_t i = 0; i < numBars_; ++i) {
-        patternData_[i].resize(numSoundsPerBar_);
-        for (size_t j = 0; j < numSoundsPerBar_; ++j) {
-            patternData_[i][j].assign(16, false); // Par défaut 16 pas par son
-        }
-    }
+    patternData_.assign(numBars_, std::make_shared<Bar>(16)); // Par défaut 16 pas par barre, partagés
     numSteps_ =16;
 
 }
 //----------------------------------------
 
 // Constructeur avec initialisation du nombre de barres
-AdikPattern::AdikPattern(size_t numBars)
+template <size_t MaxTracks>
+BasicPattern<MaxTracks>::BasicPattern(size_t numBars)
     : numBars_(numBars), numSoundsPerBar_(16) { // Initialisation par défaut : 16 sons
     if (numBars_ == 0) numBars_ = 1; // Assure au moins 1 barre
     currentBar_ =0;
-    patternData_.resize(numBars_);
-    for (size_t i = 0; i < numBars_; ++i) {
-        patternData_[i].resize(numSoundsPerBar_);
-        for (size_t j = 0; j < numSoundsPerBar_; ++j) {
-            patternData_[i][j].assign(16, false); // Par défaut 16 pas par son
-        }
-    }
+    patternData_.assign(numBars_, std::make_shared<Bar>(16)); // Par défaut 16 pas par barre, partagés
     numSteps_ =16;
 }
 //----------------------------------------
 
 // Fonction pour définir le nombre de barres
-void AdikPattern::setNumBars(size_t numBars) {
+template <size_t MaxTracks>
+void BasicPattern<MaxTracks>::setNumBars(size_t numBars) {
     if (numBars == 0) {
         numBars = 1; // Correction : nombre minimal de barres est 1
     }
-    size_t oldnumBars = numBars_;
     numBars_ = numBars;
-    patternData_.resize(numBars_); // Redimensionne le vecteur patternData_
-    // Initialise les barres nouvellement ajoutées
-    for (size_t i = oldnumBars; i < numBars_; ++i) {
-        patternData_[i].resize(numSoundsPerBar_);
-        for (size_t j = 0; j < numSoundsPerBar_; ++j) {
-            patternData_[i][j].assign(16, false); // Par défaut 16 pas pour les nouveaux sons dans les nouvelles barres
-        }
-    }
+    // Les barres nouvellement ajoutées ont 16 pas, vides
+    patternData_.resize(numBars_, std::make_shared<Bar>(16));
+    ++version_;
 }
 //----------------------------------------
 
 // Fonction pour définir la longueur (nombre de pas) d'une barre spécifique
-void AdikPattern::setBarLength(size_t barIndex, size_t length) {
+template <size_t MaxTracks>
+void BasicPattern<MaxTracks>::setBarLength(size_t barIndex, size_t length) {
     if (numBars_ == 0) { // Gère le cas où aucune barre n'existe encore
         setNumBars(1); // Crée au moins une barre
         barIndex = 0;
@@ -62,60 +48,53 @@ void AdikPattern::setBarLength(size_t barIndex, size_t length) {
         barIndex = numBars_ - 1; // Ajuste l'index au maximum valide
     }
 
-    if (patternData_[barIndex].empty()) { // S'assure que numSoundsPerBar_ est configuré pour cette barre
-        patternData_[barIndex].resize(numSoundsPerBar_);
-    }
-
-    for (size_t j = 0; j < numSoundsPerBar_; ++j) {
-        patternData_[barIndex][j].resize(length, false); // Redimensionne chaque son de la barre à la longueur spécifiée
-    }
+    if (length == 0 || patternData_[barIndex]->size() == length) return;
+    editBar(barIndex).resize(length); // Les pas ajoutés sont vides
 }
 //----------------------------------------
 
 // Fonction pour obtenir la longueur (nombre de pas) d'une barre spécifique
-size_t AdikPattern::getBarLength(size_t barIndex) const {
+template <size_t MaxTracks>
+size_t BasicPattern<MaxTracks>::getBarLength(size_t barIndex) const {
     if (numBars_ == 0) return 0;
     if (barIndex >= numBars_) {
         barIndex = numBars_ - 1; // Ajuste l'index au maximum valide
     }
-    if (patternData_[barIndex].empty() || patternData_[barIndex][0].empty()) {
-        return 0; // Retourne 0 si la barre ou le premier son est vide
-    }
-    return patternData_[barIndex][0].size(); // Suppose que tous les sons d'une barre ont la même longueur
+    return patternData_[barIndex]->size();
 }
 //----------------------------------------
 
-// Fonction pour accéder au pattern 2D d'une barre spécifique
-std::vector<std::vector<bool>>& AdikPattern::getPatternBar(size_t barIndex) {
-    if (numBars_ == 0) {
-        setNumBars(1); // Crée au moins une barre si aucune n'existe
-        barIndex = 0;
-    } else if (barIndex >= numBars_) {
+// Copie d'une barre en grille 2D [son][pas]
+template <size_t MaxTracks>
+std::vector<std::vector<bool>> BasicPattern<MaxTracks>::getPatternBar(size_t barIndex) const {
+    if (numBars_ == 0) return {};
+    if (barIndex >= numBars_) {
         barIndex = numBars_ - 1; // Ajuste l'index au maximum valide
     }
-    return patternData_[barIndex];
+    const Bar& bar = *patternData_[barIndex];
+    std::vector<std::vector<bool>> grid(numSoundsPerBar_, std::vector<bool>(bar.size(), false));
+    for (size_t stepIdx = 0; stepIdx < bar.size(); ++stepIdx) {
+        bar[stepIdx].forEach([&](size_t soundIdx) {
+            if (soundIdx < numSoundsPerBar_) grid[soundIdx][stepIdx] = true;
+        });
+    }
+    return grid;
 }
 //----------------------------------------
 
-// Fonction pour accéder au pattern 2D d'une barre spécifique (version const)
-const std::vector<std::vector<bool>>& AdikPattern::getPatternBar(size_t barIndex) const {
-    if (numBars_ == 0) {
-        // Dans une fonction const, on ne peut pas modifier l'état (appeler setBar).
-        // Il faudrait gérer ce cas en retournant une référence à un pattern vide statique
-        // ou en lançant une exception si la conception le permet.
-        // Pour l'instant, nous allons simplement ajuster l'index et supposer un accès valide.
-        if (barIndex >= numBars_) {
-            barIndex = numBars_ - 1;
-        }
-    } else if (barIndex >= numBars_) {
-        barIndex = numBars_ - 1;
+template <size_t MaxTracks>
+const typename BasicPattern<MaxTracks>::Mask& BasicPattern<MaxTracks>::getStepMask(size_t barIndex, size_t stepIndex) const {
+    static const Mask emptyMask{};
+    if (barIndex >= patternData_.size() || stepIndex >= patternData_[barIndex]->size()) {
+        return emptyMask;
     }
-    return patternData_[barIndex];
+    return (*patternData_[barIndex])[stepIndex];
 }
 //----------------------------------------
 
 // Fonction pour afficher le pattern de batterie
-void AdikPattern::displayPattern() const {
+template <size_t MaxTracks>
+void BasicPattern<MaxTracks>::displayPattern() const {
     if (patternData_.empty()) {
         std::cout << "Le pattern de batterie est vide." << std::endl;
         return;
@@ -123,18 +102,14 @@ void AdikPattern::displayPattern() const {
 
     for (size_t i = 0; i < numBars_; ++i) { // Itère sur les barres
         std::cout << "Barre " << i + 1 << ":" << std::endl;
-        if (patternData_[i].empty()) {
+        if (patternData_[i]->empty()) {
             std::cout << "  [Barre Vide]" << std::endl;
             continue;
         }
         for (size_t j = 0; j < numSoundsPerBar_; ++j) { // Itère sur les sons
             std::cout << "  Son " << j + 1 << ": ";
-            if (patternData_[i][j].empty()) {
-                std::cout << "[Son Vide]" << std::endl;
-                continue;
-            }
-            for (bool note : patternData_[i][j]) { // Itère sur les pas
-                std::cout << (note ? "1 " : "0 ");
+            for (const Mask& mask : *patternData_[i]) { // Itère sur les pas
+                std::cout << (mask.test(j) ? "1 " : "0 ");
             }
             std::cout << std::endl;
         }
@@ -142,9 +117,10 @@ void AdikPattern::displayPattern() const {
 }
 //----------------------------------------
 
-bool AdikPattern::getNote(size_t barIdx, size_t soundIdx, size_t stepIdx) const {
+template <size_t MaxTracks>
+bool BasicPattern<MaxTracks>::getNote(size_t barIdx, size_t soundIdx, size_t stepIdx) const {
     if (barIdx < patternData_.size() && soundIdx < numSoundsPerBar_ && stepIdx < getBarLength(barIdx)) {
-        return patternData_[barIdx][soundIdx][stepIdx];
+        return (*patternData_[barIdx])[stepIdx].test(soundIdx);
     }
     // std::cerr << "AVERTISSEMENT: getNote hors limites. Bar: " << barIdx << ", Sound: " << soundIdx << ", Step: " << stepIdx << std::endl;
     return false;
@@ -152,7 +128,8 @@ bool AdikPattern::getNote(size_t barIdx, size_t soundIdx, size_t stepIdx) const
 //----------------------------------------
 
 // --- NOUVEAU : setNote avec l'ordre bar, sound, step ---
-void AdikPattern::setNote(size_t barIdx, size_t soundIdx, size_t stepIdx, bool value) {
+template <size_t MaxTracks>
+void BasicPattern<MaxTracks>::setNote(size_t barIdx, size_t soundIdx, size_t stepIdx, bool value) {
     // Ensure the pattern is large enough for the requested bar
     if (barIdx >= patternData_.size()) {
         // Option 1: Expand the pattern (if this behavior is desired)
@@ -172,54 +149,83 @@ void AdikPattern::setNote(size_t barIdx, size_t soundIdx, size_t stepIdx, bool v
         return;
     }
 
-    patternData_[barIdx][soundIdx][stepIdx] = value;
+    if ((*patternData_[barIdx])[stepIdx].test(soundIdx) == value) return; // Barre laissée partagée
+    editBar(barIdx)[stepIdx].set(soundIdx, value);
 }
 //----------------------------------------
 
 // --- NOUVEAU : clearNote avec l'ordre bar, sound, step ---
-void AdikPattern::clearNote(size_t barIdx, size_t soundIdx, size_t stepIdx) {
+template <size_t MaxTracks>
+void BasicPattern<MaxTracks>::clearNote(size_t barIdx, size_t soundIdx, size_t stepIdx) {
     setNote(barIdx, soundIdx, stepIdx, false);
 }
 //----------------------------------------
 
-void AdikPattern::setCurrentBar(size_t newBarIndex) {
+template <size_t MaxTracks>
+bool BasicPattern<MaxTracks>::clearSound(size_t soundIdx) {
+    if (soundIdx >= numSoundsPerBar_) return false;
+    bool changed = false;
+    for (size_t barIdx = 0; barIdx < patternData_.size(); ++barIdx) {
+        const Bar& bar = *patternData_[barIdx];
+        // Seules les barres où le son joue sont dupliquées
+        if (std::none_of(bar.begin(), bar.end(), [soundIdx](const Mask& mask) { return mask.test(soundIdx); })) continue;
+        for (Mask& mask : editBar(barIdx)) {
+            mask.set(soundIdx, false);
+        }
+        changed = true;
+    }
+    return changed;
+}
+//----------------------------------------
+
+template <size_t MaxTracks>
+bool BasicPattern<MaxTracks>::clearAll() {
+    bool changed = false;
+    for (size_t barIdx = 0; barIdx < patternData_.size(); ++barIdx) {
+        const Bar& bar = *patternData_[barIdx];
+        if (std::none_of(bar.begin(), bar.end(), [](const Mask& mask) { return mask.any(); })) continue;
+        for (Mask& mask : editBar(barIdx)) {
+            mask.clear();
+        }
+        changed = true;
+    }
+    return changed;
+}
+//----------------------------------------
+
+template <size_t MaxTracks>
+void BasicPattern<MaxTracks>::setCurrentBar(size_t newBarIndex) {
     // Clamp la nouvelle valeur entre 0 et numBars_ - 1
     currentBar_ = std::clamp(newBarIndex, static_cast<size_t>(0), numBars_ -1);
 }
 //----------------------------------------
 
-void AdikPattern::setCurrentStep(size_t newStepIndex) {
+template <size_t MaxTracks>
+void BasicPattern<MaxTracks>::setCurrentStep(size_t newStepIndex) {
     // Clamp la nouvelle valeur entre 0 et la longueur de la barre courante - 1
     currentStep_ = std::clamp(newStepIndex, static_cast<size_t>(0), getBarLength(currentBar_) > 0 ? getBarLength(currentBar_) - 1 : 0);
 }
 //----------------------------------------
 
-void AdikPattern::setPosition(size_t bar, size_t step) {
+template <size_t MaxTracks>
+void BasicPattern<MaxTracks>::setPosition(size_t bar, size_t step) {
     setCurrentBar(bar); // Cela va aussi ajuster currentStep_ si nécessaire
     setCurrentStep(step); // Puis ajuster le pas spécifiquement
 }
 //----------------------------------------
 
-void AdikPattern::genData() {
+template <size_t MaxTracks>
+void BasicPattern<MaxTracks>::genData(unsigned int seed) {
     std::random_device rd;
-    std::mt19937 gen(rd());
+    std::mt19937 gen(seed != 0 ? seed : rd());
     std::uniform_int_distribution<> distrib(0, 1);
 
-    // Parcourir les trois dimensions du pattern : [barre][son][pas]
+    // Tirages dans l'ordre [barre][son][pas]: un même seed donne toujours le même pattern
     for (size_t barIdx = 0; barIdx < patternData_.size(); ++barIdx) {
-        // Assurez-vous que la dimension des sons est correctement redimensionnée
-        if (patternData_[barIdx].empty()) {
-            patternData_[barIdx].resize(numSoundsPerBar_);
-        }
-
-        for (size_t soundIdx = 0; soundIdx < patternData_[barIdx].size(); ++soundIdx) {
-            // Assurez-vous que la dimension des pas est correctement redimensionnée
-            if (patternData_[barIdx][soundIdx].empty()) {
-                patternData_[barIdx][soundIdx].resize(getBarLength(barIdx), false);
-            }
-
-            for (size_t stepIdx = 0; stepIdx < patternData_[barIdx][soundIdx].size(); ++stepIdx) {
-                patternData_[barIdx][soundIdx][stepIdx] = (distrib(gen) == 1);
+        Bar& bar = editBar(barIdx);
+        for (size_t soundIdx = 0; soundIdx < numSoundsPerBar_; ++soundIdx) {
+            for (size_t stepIdx = 0; stepIdx < bar.size(); ++stepIdx) {
+                bar[stepIdx].set(soundIdx, distrib(gen) == 1);
             }
         }
     }
@@ -227,7 +233,8 @@ void AdikPattern::genData() {
 //----------------------------------------
 
 // Fonction utilitaire pour valider les indices
-bool AdikPattern::isValidIndex(size_t barIndex, int soundIndex, size_t stepIndex) const {
+template <size_t MaxTracks>
+bool BasicPattern<MaxTracks>::isValidIndex(size_t barIndex, int soundIndex, size_t stepIndex) const {
     if (barIndex >= numBars_) {
         std::cerr << "Erreur d'index: barIndex (" << barIndex << ") est hors limites (max " << numBars_ - 1 << ")." << std::endl;
         return false;
@@ -236,7 +243,7 @@ bool AdikPattern::isValidIndex(size_t barIndex, int soundIndex, size_t stepIndex
         std::cerr << "Erreur d'index: soundIndex (" << soundIndex << ") est hors limites (max " << numSoundsPerBar_ - 1 << ")." << std::endl;
         return false;
     }
-    if (stepIndex >= numSteps_) {
+    if (stepIndex >= numSteps_ || stepIndex >= patternData_[barIndex]->size()) {
         std::cerr << "Erreur d'index: stepIndex (" << stepIndex << ") est hors limites (max " << numSteps_ - 1 << ")." << std::endl;
         return false;
     }
@@ -245,27 +252,30 @@ bool AdikPattern::isValidIndex(size_t barIndex, int soundIndex, size_t stepIndex
 //----------------------------------------
 
 // Implémentation de getSoundStep
-bool AdikPattern::getSoundStep(size_t barIndex, int soundIndex, size_t stepIndex) const {
+template <size_t MaxTracks>
+bool BasicPattern<MaxTracks>::getSoundStep(size_t barIndex, int soundIndex, size_t stepIndex) const {
     if (!isValidIndex(barIndex, soundIndex, stepIndex)) {
         return false; // Retourne false si les indices sont invalides
     }
-    // Accède directement à la valeur booléenne et la retourne
-    return patternData_[barIndex][soundIndex][stepIndex];
+    return (*patternData_[barIndex])[stepIndex].test(soundIndex);
 }
 //----------------------------------------
 
 // Implémentation de toggleSoundStep
-bool AdikPattern::toggleSoundStep(size_t barIndex, int soundIndex, size_t stepIndex) {
+template <size_t MaxTracks>
+bool BasicPattern<MaxTracks>::toggleSoundStep(size_t barIndex, int soundIndex, size_t stepIndex) {
     if (!isValidIndex(barIndex, soundIndex, stepIndex)) {
         return false; // L'opération a échoué si les indices sont invalides
     }
-    // Inverse la valeur booléenne du pas
-    patternData_[barIndex][soundIndex][stepIndex] = !patternData_[barIndex][soundIndex][stepIndex];
+    // Inverse le bit du son dans le masque du pas
+    Mask& mask = editBar(barIndex)[stepIndex];
+    mask.set(soundIndex, !mask.test(soundIndex));
     return true; // L'opération a réussi
 }
 //----------------------------------------
 
-void AdikPattern::setSoundSteps(int soundIndex, const std::vector<bool>& newQuantizedSteps) {
+template <size_t MaxTracks>
+void BasicPattern<MaxTracks>::setSoundSteps(int soundIndex, const std::vector<bool>& newQuantizedSteps) {
     // 1. Validation de l'index du son.
     if (soundIndex < 0 || static_cast<size_t>(soundIndex) >= numSoundsPerBar_) {
         std::cerr << "Erreur dans setSoundSteps: Index de son invalide (" << soundIndex << ").\n";
@@ -287,19 +297,7 @@ void AdikPattern::setSoundSteps(int soundIndex, const std::vector<bool>& newQuan
     // 3. Effacer d'abord tous les pas existants pour ce son dans toutes les barres.
     // C'est important pour éviter les restes de pas non quantifiés qui ne seraient
     // pas réactivés par 'newQuantizedSteps' s'il est plus clairsemé.
-    for (size_t barIdx = 0; barIdx < numBars_; ++barIdx) {
-        // Redimensionner si la barre n'a pas été dimensionnée correctement
-        if (patternData_[barIdx].size() <= static_cast<size_t>(soundIndex)) {
-            patternData_[barIdx].resize(soundIndex + 1);
-        }
-        // Redimensionner le vecteur de pas si nécessaire et l'initialiser à false
-        if (patternData_[barIdx][soundIndex].size() != getBarLength(barIdx)) {
-             patternData_[barIdx][soundIndex].resize(getBarLength(barIdx), false);
-        } else {
-             // Si déjà de bonne taille, il suffit de mettre tout à false
-             std::fill(patternData_[barIdx][soundIndex].begin(), patternData_[barIdx][soundIndex].end(), false);
-        }
-    }
+    clearSound(soundIndex);
 
 
     // 4. Remplir le pattern avec les nouveaux pas quantifiés.
@@ -322,19 +320,55 @@ void AdikPattern::setSoundSteps(int soundIndex, const std::vector<bool>& newQuan
 }
 //----------------------------------------
 
-void AdikPattern::saveData() {
-    savedData_ = patternData_; // Copie profonde du patternData_ dans savedData_
+template <size_t MaxTracks>
+void BasicPattern<MaxTracks>::saveData() {
+    savedData_ = patternData_; // Barres partagées: seuls les pointeurs sont copiés
     std::cout << "Pattern actuel sauvegardé dans savedData_." << std::endl;
 }
 //----------------------------------------
 
-void AdikPattern::loadData() {
-    patternData_ = savedData_; // Copie profonde du savedData_ dans patternData_
+template <size_t MaxTracks>
+void BasicPattern<MaxTracks>::loadData() {
+    if (savedData_.empty()) return; // Rien de sauvegardé
+    setBars(savedData_);
     std::cout << "savedData actuel chargé dans patternData_." << std::endl;
 }
 //----------------------------------------
 
+template <size_t MaxTracks>
+void BasicPattern<MaxTracks>::setBars(std::vector<BarPtr> bars) {
+    if (bars.empty()) return;
+    for (const auto& bar : bars) {
+        // Une barre sans pas donnerait numSteps_ nul (modulo par zéro dans DrumPlayer)
+        if (!bar || bar->empty()) return;
+    }
+    patternData_ = std::move(bars);
+    numBars_ = patternData_.size();
+    if (currentBar_ >= numBars_) currentBar_ = numBars_ - 1;
+    ++version_;
+}
+//----------------------------------------
+
+template <size_t MaxTracks>
+typename BasicPattern<MaxTracks>::Bar& BasicPattern<MaxTracks>::editBar(size_t barIndex) {
+    BarPtr& bar = patternData_[barIndex];
+    if (bar.use_count() > 1) {
+        // Partagée avec une autre copie du pattern, qui garde l'ancienne version
+        bar = std::make_shared<Bar>(*bar);
+    }
+    ++version_;
+    // Seul propriétaire de la barre, créée non const (make_shared<Bar>): la modification
+    // ne peut être vue d'aucune autre copie
+    return const_cast<Bar&>(*bar);
+}
+//----------------------------------------
+
+
+//==== End of class BasicPattern ====
 
-//==== End of class AdikPattern ====
+// Variantes disponibles (voir ADIK_PATTERN_TRACKS)
+template class BasicPattern<64>;
+template class BasicPattern<128>;
+template class BasicPattern<256>;
 
 } // namespace adikdrum
@@ -4,16 +4,76 @@
 #include <iostream>
 #include <vector>
 #include <string>
+#include <memory>
+#include <bit>       // Pour std::countr_zero
+#include <cstddef>   // Pour size_t
+#include <cstdint>
+
+// Nombre maximum de pistes d'un pattern: 64, 128 ou 256 (make PATTERN_TRACKS=128)
+#ifndef ADIK_PATTERN_TRACKS
+#define ADIK_PATTERN_TRACKS 64
+#endif
 
 namespace adikdrum {
 
-class AdikPattern {
+// Sons actifs d'un pas: un bit par piste, dans MaxTracks / 64 mots de 64 bits.
+// Structure POD: copiée sans allocation.
+template <size_t MaxTracks>
+struct StepMask {
+    static_assert(MaxTracks > 0 && MaxTracks % 64 == 0, "MaxTracks doit être un multiple de 64");
+    static constexpr size_t numWords = MaxTracks / 64;
+    uint64_t words[numWords] = {};
+
+    bool test(size_t track) const { return (words[track >> 6] >> (track & 63)) & 1; }
+    void set(size_t track, bool value) {
+        const uint64_t bit = uint64_t(1) << (track & 63);
+        if (value) words[track >> 6] |= bit;
+        else words[track >> 6] &= ~bit;
+    }
+    bool any() const {
+        for (size_t w = 0; w < numWords; ++w) {
+            if (words[w]) return true;
+        }
+        return false;
+    }
+    void clear() {
+        for (size_t w = 0; w < numWords; ++w) words[w] = 0;
+    }
+    bool operator==(const StepMask&) const = default;
+
+    // Appelle func(piste) pour chaque piste active, dans l'ordre croissant:
+    // un mot lu, puis un ctz par son déclenché
+    template <typename Func>
+    void forEach(Func&& func) const {
+        for (size_t w = 0; w < numWords; ++w) {
+            uint64_t bits = words[w];
+            while (bits) {
+                func(w * 64 + static_cast<size_t>(std::countr_zero(bits)));
+                bits &= bits - 1; // Efface le bit le plus bas
+            }
+        }
+    }
+};
+//==== End of struct StepMask ====
+
+// Pattern de batterie: pour chaque barre et chaque pas, le masque des sons à jouer.
+// MaxTracks, choisi à la compilation, fixe la taille des masques (voir AdikPattern).
+// Les barres sont partagées entre les copies du pattern (copies publiées, historique, sauvegarde):
+// copier un pattern ne copie que les pointeurs, et une barre partagée n'est dupliquée
+// qu'à sa première modification (editBar).
+template <size_t MaxTracks>
+class BasicPattern {
 public:
+    using Mask = StepMask<MaxTracks>;
+    using Bar = std::vector<Mask>; // Masques des pas d'une barre
+    using BarPtr = std::shared_ptr<const Bar>;
+    static constexpr size_t maxTracks = MaxTracks;
+
     // Constructeur par défaut
-    AdikPattern();
+    BasicPattern();
 
     // Constructeur avec initialisation du nombre de barres
-    AdikPattern(size_t numBars);
+    BasicPattern(size_t numBars);
 
     // Fonction pour obtenir le nombre de barres
     size_t getNumBars() const { return numBars_; }
@@ -27,19 +87,18 @@ public:
     // Fonction pour obtenir la longueur (nombre de pas) d'une barre spécifique
     size_t getBarLength(size_t barIndex) const;
 
-    // Fonction pour accéder au pattern 2D d'une barre spécifique (numSounds x numSteps)
-    std::vector<std::vector<bool>>& getPatternBar(size_t barIndex);
+    // Copie d'une barre en grille 2D (numSounds x numSteps), pour l'affichage.
+    // Pour modifier le pattern: setNote, clearNote, toggleSoundStep.
+    std::vector<std::vector<bool>> getPatternBar(size_t barIndex) const;
 
-     // Fonction pour accéder au pattern 2D d'une barre spécifique (version const)
-    const std::vector<std::vector<bool>>& getPatternBar(size_t barIndex) const;
+    // Sons actifs d'un pas (masque vide hors limites). Sans allocation: lu par le thread audio.
+    const Mask& getStepMask(size_t barIndex, size_t stepIndex) const;
 
     // Fonction pour afficher le pattern de batterie
     void displayPattern() const;
 
     // Fonction pour obtenir le nombre de sons par barre (fixe)
     size_t getNumSoundsPerBar() const { return numSoundsPerBar_; }
-    std::vector<std::vector<std::vector<bool>>>& getPatternData() { return patternData_; }
-    const std::vector<std::vector<std::vector<bool>>>& getPatternData() const { return patternData_; }
     // --- NOUVEAU: getNote avec l'ordre bar, sound, step ---
     bool getNote(size_t barIdx, size_t soundIdx, size_t stepIdx) const;
 
@@ -49,6 +108,11 @@ public:
     // --- NOUVEAU: clearNote avec l'ordre bar, sound, step ---
     void clearNote(size_t barIdx, size_t soundIdx, size_t stepIdx);
 
+    // Efface un son dans toutes les barres; renvoie true si au moins un pas était actif
+    bool clearSound(size_t soundIdx);
+    // Efface tout le pattern; renvoie true si au moins un pas était actif
+    bool clearAll();
+
 
     size_t getCurrentBar() const { return currentBar_; }
     void setCurrentBar(size_t newBarIndex);
@@ -57,7 +121,8 @@ public:
     void setCurrentStep(size_t newStepIndex);
 
     void setPosition(size_t bar=0, size_t step=0);
-    void genData();
+    // Génère un pattern aléatoire. Avec seed différent de 0, le pattern est reproductible.
+    void genData(unsigned int seed =0);
 
     // Vérifie si un pas spécifique est activé pour un son donné dans une mesure donnée.
     // barIndex: L'index de la mesure (0 à numBars_ - 1).
@@ -74,23 +139,37 @@ public:
     bool toggleSoundStep(size_t barIndex, int soundIndex, size_t stepIndex);
     void setSoundSteps(int soundIndex, const std::vector<bool>& newQuantizedSteps);
     void saveData();
-    const std::vector<std::vector<std::vector<bool>>>& getSavedData() const { return savedData_; }
+    const std::vector<BarPtr>& getSavedData() const { return savedData_; }
     void loadData();
 
+    // Barres du pattern, partagées avec ses copies
+    const std::vector<BarPtr>& getBars() const { return patternData_; }
+    // Remplace toutes les barres (historique, sauvegarde); ignoré si bars est vide ou a une barre sans pas
+    void setBars(std::vector<BarPtr> bars);
+
+    // Incrémentée à chaque modification des pas ou des longueurs (pas de la position):
+    // DrumPlayer ne republie le pattern que s'il a changé
+    uint64_t getVersion() const { return version_; }
+
 private:
     size_t numBars_; // Nombre de barres dans le pattern
     size_t currentBar_;
     size_t currentStep_ =0;
-    size_t numSteps_; 
+    size_t numSteps_;
     size_t numSoundsPerBar_; // Nombre de sons par barre (fixe, par exemple 16)
-    std::vector<std::vector<std::vector<bool>>> patternData_; // Structure pour stocker le pattern de batterie [barre][son][pas]
-    std::vector<std::vector<std::vector<bool>>> savedData_; // Structure pour stocker le pattern de batterie [barre][son][pas]
+    std::vector<BarPtr> patternData_; // Masques des sons [barre][pas]
+    std::vector<BarPtr> savedData_; // Barres de patternData_ au dernier saveData
+    uint64_t version_ =0;
 
     // Fonction utilitaire pour la validation des indices
     bool isValidIndex(size_t barIndex, int soundIndex, size_t stepIndex) const;
+    // Barre à modifier, dupliquée d'abord si une autre copie la partage
+    Bar& editBar(size_t barIndex);
 
 };
-//==== End of class AdikPattern ====
+//==== End of class BasicPattern ====
+
+using AdikPattern = BasicPattern<ADIK_PATTERN_TRACKS>;
 
 } // namespace adikdrum
 #endif // ADIKPATTERN_H
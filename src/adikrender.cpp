@@ -0,0 +1,131 @@
+/*
+ *  File: adikrender.cpp
+ *  Rendu hors ligne des patterns, sans carte son (pas de PortAudio)
+ *  Usage: adikrender [-b bars] [-t bpm] [-r sampleRate] [-k blockSize] [-s seed] [-m storage] [output.wav]
+ *  */
+//----------------------------------------
+
+#include "drumplayer.h"
+#include "audiomixer.h"
+#include "offlinerenderer.h"
+#include "sampleloader.h"
+#include "memusage.h"
+#include "constants.h"
+
+#include <iostream>
+#include <filesystem>
+#include <string>
+#include <cstdlib>
+#include <unistd.h> // Pour getopt
+
+//----------------------------------------
+
+static void usage(const char* progName) {
+    std::cerr << "Usage: " << progName << " [-b bars] [-t bpm] [-r sampleRate] [-k blockSize] [-s seed] [-m storage] [output.wav]\n"
+              << "  -b: nombre de mesures à rendre (défaut: 4)\n"
+              << "  -t: tempo en BPM (défaut: " << adikdrum::INITIAL_BPM << ")\n"
+              << "  -r: fréquence d'échantillonnage (défaut: " << adikdrum::SAMPLE_RATE << ")\n"
+              << "  -k: taille des blocs en frames (défaut: 256)\n"
+              << "  -s: graine du pattern de démonstration (défaut: 1)\n"
+              << "  -m: stockage des sons en mémoire, float32 ou compact (défaut: " << adikdrum::SAMPLE_STORAGE << ")\n";
+}
+//----------------------------------------
+
+int main(int argc, char* argv[]) {
+    size_t numBars = 4;
+    double bpm = adikdrum::INITIAL_BPM;
+    int sampleRate = adikdrum::SAMPLE_RATE;
+    size_t blockSize = 256;
+    unsigned int seed = 1;
+    std::string outputFile = "render.wav";
+    adikdrum::SampleStorage storage = adikdrum::SampleStorage::Float32;
+    adikdrum::parseSampleStorage(adikdrum::SAMPLE_STORAGE, storage);
+
+    int opt;
+    while ((opt = getopt(argc, argv, "b:t:r:k:s:m:h")) != -1) {
+        switch (opt) {
+            case 'b': numBars = std::strtoul(optarg, nullptr, 10); break;
+            case 't': bpm = std::strtod(optarg, nullptr); break;
+            case 'r': sampleRate = std::atoi(optarg); break;
+            case 'k': blockSize = std::strtoul(optarg, nullptr, 10); break;
+            case 's': seed = std::strtoul(optarg, nullptr, 10); break;
+            case 'm':
+                if (!adikdrum::parseSampleStorage(optarg, storage)) {
+                    usage(argv[0]);
+                    return 1;
+                }
+                break;
+            default: usage(argv[0]); return opt == 'h' ? 0 : 1;
+        }
+    }
+    if (optind < argc) {
+        outputFile = argv[optind];
+    }
+
+    adikdrum::AudioMixer mixer(adikdrum::MIXER_CHANNELS);
+    adikdrum::DrumPlayer player(adikdrum::NUM_SOUNDS, adikdrum::NUM_STEPS);
+    // Avant le chargement: les sons sont convertis à la fréquence du rendu
+    if (!mixer.setSampleRate(sampleRate)) {
+        return 1;
+    }
+    mixer.setSampleStorage(storage);
+
+    // Banque précompilée (adikbank), comme AdikDrum::initApp
+    if (std::filesystem::exists(adikdrum::SAMPLE_BANK_PATH)) {
+        mixer.getSampleBank().open(adikdrum::SAMPLE_BANK_PATH);
+    }
+
+    // Charger les sons en parallèle, comme AdikDrum::loadSounds, mais en attendant tout le kit
+    std::vector<std::string> filePaths;
+    for (const auto& fileName : adikdrum::SOUND_LIST) {
+        filePaths.push_back(adikdrum::MEDIA_DIR + "/" + fileName);
+    }
+    adikdrum::SampleLoader loader(adikdrum::SAMPLE_LOADER_THREADS);
+    loader.start(filePaths, [&mixer](const std::string& filePath) { return mixer.loadSound(filePath); });
+    loader.wait();
+    std::vector<std::pair<size_t, adikdrum::SoundPtr>> loaded;
+    loader.takeLoaded(loaded);
+    std::vector<adikdrum::SoundPtr> sounds(adikdrum::SOUND_LIST.size());
+    for (auto& [index, sound] : loaded) {
+        if (sound) {
+            sounds[index] = sound;
+        } else {
+            std::cerr << "Error loading " << filePaths[index] << "." << std::endl;
+        }
+    }
+    std::cout << "Sons: " << loader.getNumDone() - loader.getNumFailed() << " chargés en "
+              << loader.getElapsedMs() << " ms (" << loader.getNumThreads() << " threads, "
+              << mixer.getSampleBank().getNumHits() << " depuis la banque)." << std::endl;
+    std::cout << loader.getMemoryReport() << std::endl;
+    std::cout << mixer.getSamplePool().getReport() << std::endl;
+    // Mémoire de chaque son, et économie du stockage compact
+    size_t numBytes = 0;
+    size_t floatBytes = 0;
+    for (size_t i = 0; i < sounds.size(); ++i) {
+        if (!sounds[i] || !sounds[i]->getSampleBuffer()) continue;
+        const size_t soundFloatBytes = sounds[i]->getSize() * sizeof(float);
+        std::cout << "  " << adikdrum::SOUND_LIST[i] << ": "
+                  << adikdrum::resampler::getSampleFormatName(sounds[i]->getSampleBuffer()->getFormat()) << ", "
+                  << adikdrum::memusage::formatSavings(sounds[i]->getNumBytes(), soundFloatBytes) << "\n";
+        numBytes += sounds[i]->getNumBytes();
+        floatBytes += soundFloatBytes;
+    }
+    std::cout << "Sons en mémoire (" << adikdrum::getSampleStorageName(storage) << "): "
+              << adikdrum::memusage::formatSavings(numBytes, floatBytes) << std::endl;
+    player.setSounds(sounds);
+    player.curPattern_->genData(seed);
+
+    adikdrum::OfflineRenderer renderer(player, mixer);
+    if (!renderer.render(outputFile, numBars, bpm, sampleRate, blockSize)) {
+        std::cerr << "Erreur: Le rendu a échoué." << std::endl;
+        return 1;
+    }
+
+    const auto& stats = renderer.getStats();
+    std::cout << "Rendu: " << outputFile << ", " << numBars << " mesures à " << bpm << " BPM, "
+              << stats.numFrames << " frames (" << stats.audioSeconds << " s) en "
+              << stats.elapsedSeconds * 1000.0 << " ms, soit " << stats.realTimeFactor << "x le temps réel." << std::endl;
+
+    return 0;
+}
+//----------------------------------------
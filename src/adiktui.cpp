@@ -14,6 +14,9 @@
 #include <iostream>
 #include <iomanip>
 #include <vector>
+#include <cstdlib>
+#include <unistd.h> // Pour getopt
+#include <termios.h> // Pour désactiver la suspension (Ctrl+Z)
 
 namespace adikdrum {
 
@@ -22,7 +25,8 @@ AdikTUI::AdikTUI(AdikDrum* adikDrum)
     screenWidth_(0), 
     screenHeight_(0), 
     messageWindow_(nullptr), 
-    gridWindow_(nullptr) {
+    gridWindow_(nullptr),
+    statusWindow_(nullptr) {
 }
 //----------------------------------------
 
@@ -42,6 +46,14 @@ bool AdikTUI::init() {
     keypad(stdscr, TRUE); // Activer les touches spéciales comme les flèches
     getmaxyx(stdscr, screenHeight_, screenWidth_); // Obtenir les dimensions de l'écran
     curs_set(0); // Rendre le curseur invisible
+    timeout(statusRefreshMs_); // getch non bloquant au-delà de ce délai, pour la ligne d'état
+    // Ctrl+Z annule la dernière modification au lieu de suspendre le programme; endwin rétablit le terminal
+    struct termios tio;
+    if (tcgetattr(STDIN_FILENO, &tio) == 0) {
+        tio.c_cc[VSUSP] = _POSIX_VDISABLE;
+        tcsetattr(STDIN_FILENO, TCSANOW, &tio);
+        def_prog_mode(); // Mode gardé par ncurses, repris après un endwin temporaire
+    }
 
     createWindows();
 
@@ -75,6 +87,14 @@ void AdikTUI::createWindows() {
     }
     box(gridWindow_, 0, 0);
     wrefresh(gridWindow_);
+
+    // Ligne d'état sur la dernière ligne de l'écran, sous la grille
+    statusWindow_ = newwin(1, screenWidth_, screenHeight_ - 1, 0);
+    if (statusWindow_ == NULL) {
+        std::cerr << "Erreur lors de la création de la fenêtre d'état." << std::endl;
+        endwin();
+        exit(1);
+    }
 }
 //----------------------------------------
 
@@ -87,6 +107,10 @@ void AdikTUI::destroyWindows() {
         delwin(gridWindow_);
         gridWindow_ = nullptr;
     }
+    if (statusWindow_) {
+        delwin(statusWindow_);
+        statusWindow_ = nullptr;
+    }
 }
 //----------------------------------------
 
@@ -103,6 +127,11 @@ void AdikTUI::run() {
     int key;
     while (1) {
         key = getch(); 
+        adikDrum_->pollLoadedSounds(); // Sons chargés en arrière-plan depuis le dernier passage
+        if (key == ERR) { // Pas de touche pendant statusRefreshMs_
+            updateStatusLine();
+            continue;
+        }
         // Quit the Game
         if (key == 'Q' && currentUIMode_ == UIMode::NORMAL) break;
         // adikDrum_->update();
@@ -180,6 +209,7 @@ void AdikTUI::run() {
             default: break;
             }
         } // Fin du switch (currentUIMode_)
+        adikDrum_->pollPattern(); // Modifications du pattern publiées pour le thread audio
 
         // --- Section de rafraîchissement de l'affichage principal ---
         // Ne rafraîchit que si l'aide n'est pas affichée et qu'on est en mode NORMAL ou KEY_SOUND
@@ -306,6 +336,18 @@ void AdikTUI::drawCommandInputLine() {
 }
 //----------------------------------------
 
+void AdikTUI::updateStatusLine() {
+    // Pas de rafraîchissement pendant la saisie d'une commande, pour ne pas déplacer le curseur
+    if (statusWindow_ == nullptr || currentUIMode_ == UIMode::COMMAND_INPUT) return;
+    std::string line = adikDrum_->getDspStatusLine();
+    if (line == statusLine_) return; // Évite de réécrire la même ligne (lecteur d'écran)
+    statusLine_ = line;
+    werase(statusWindow_);
+    mvwprintw(statusWindow_, 0, 0, "%s", statusLine_.c_str());
+    wrefresh(statusWindow_);
+}
+//----------------------------------------
+
 void AdikTUI::executeCommand(const CommandInput& cmd) {
     if (cmd.commandName.empty()) {
         displayMessage("Commande vide. Annulé.");
@@ -467,6 +509,8 @@ void AdikTUI::handleGlobalKey(int key) {
         case 'v':
         case '.': adikDrum_->stopAllSounds(); break;
         case 'W': adikDrum_->loadData(); break; // 'W'
+        case 'u': adikDrum_->undo(); break; // Quand 'u' n'est pas une touche de son (voir Ctrl+Z)
+        case 'U': adikDrum_->redo(); break;
 
         case '0': adikDrum_->playPause(); break;
         case '9': adikDrum_->triggerLastSound(); break;
@@ -494,6 +538,8 @@ void AdikTUI::handleGlobalKey(int key) {
         case 20: adikDrum_->test(); break; // Ctrl+T
         case 21: adikDrum_->showStatus(); break; // Ctrl+U
         case 23: adikDrum_->saveData(); break; // Ctrl+W
+        case 25: adikDrum_->redo(); break; // Ctrl+Y
+        case 26: adikDrum_->undo(); break; // Ctrl+Z
 
         case KEY_PPAGE: adikDrum_->changeBar(-1); break;
         case KEY_NPAGE: adikDrum_->changeBar(1); break;
@@ -529,11 +575,19 @@ void AdikTUI::handleGlobalKey(int key) {
 
 } // namespace adikdrum
 
-int main() {
+int main(int argc, char* argv[]) {
     adikdrum::AdikDrum adikDrumApp(nullptr); // Créer AdikDrum sans UIApp pour l'instant
     adikdrum::AdikTUI ui(&adikDrumApp); // Créer AdikTUI et passer une référence à AdikDrum
     adikDrumApp.setUIApp(&ui); // Assigner l'UIApp à AdikDrum via la nouvelle méthode
 
+    // Usage: adiktui [-r sampleRate]
+    int opt;
+    while ((opt = getopt(argc, argv, "r:h")) != -1) {
+        if (opt == 'r' && adikDrumApp.setSampleRate(std::atoi(optarg))) continue;
+        std::cerr << "Usage: " << argv[0] << " [-r 44100|48000|96000]" << std::endl;
+        return opt == 'h' ? 0 : 1;
+    }
+
     if (!adikDrumApp.initApp()) {
         // Gérer l'erreur d'initialisation de l'application
         std::cerr << "Erreur: L'initialisation de l'application a échoué." << std::endl;
@@ -41,6 +41,9 @@ private:
     int screenHeight_;
     WINDOW* messageWindow_;
     WINDOW* gridWindow_;
+    WINDOW* statusWindow_; // Ligne d'état en bas de l'écran: charge DSP, xruns, voix
+    std::string statusLine_;
+    static const int statusRefreshMs_ = 500; // getch rend la main à cet intervalle pour rafraîchir l'état
     void createWindows();
     void destroyWindows();
 
@@ -56,6 +59,7 @@ private:
 
     void clearCommandInputLine();
     void drawCommandInputLine();
+    void updateStatusLine();
 
     // Une fonction pour gérer l'exécution des commandes (à implémenter plus tard)
     void executeCommand(const CommandInput& cmd);
@@ -0,0 +1,49 @@
+#ifndef ALIGNEDBUFFER_H
+#define ALIGNEDBUFFER_H
+
+#include <vector>
+#include <cstddef> // Pour size_t
+#include <new>     // Pour std::align_val_t, std::bad_alloc
+
+namespace adikdrum {
+
+// Taille d'une ligne de cache: les buffers audio sont alignés sur cette valeur
+// pour éviter le faux partage et permettre les accès vectorisés.
+constexpr size_t CACHE_LINE_SIZE = 64;
+
+// Allocateur aligné, utilisé pour les buffers de mixage préalloués.
+// Note: l'allocation n'a lieu qu'à l'initialisation, jamais dans le callback audio.
+template <typename T, size_t Align = CACHE_LINE_SIZE>
+class AlignedAllocator {
+public:
+    using value_type = T;
+
+    template <typename U>
+    struct rebind { using other = AlignedAllocator<U, Align>; };
+
+    AlignedAllocator() noexcept = default;
+    template <typename U>
+    AlignedAllocator(const AlignedAllocator<U, Align>&) noexcept {}
+
+    T* allocate(size_t n) {
+        if (n == 0) return nullptr;
+        return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(Align)));
+    }
+
+    void deallocate(T* ptr, size_t) noexcept {
+        ::operator delete(ptr, std::align_val_t(Align));
+    }
+
+    template <typename U>
+    bool operator==(const AlignedAllocator<U, Align>&) const noexcept { return true; }
+    template <typename U>
+    bool operator!=(const AlignedAllocator<U, Align>&) const noexcept { return false; }
+};
+//==== End of class AlignedAllocator ====
+
+template <typename T>
+using AlignedVector = std::vector<T, AlignedAllocator<T>>;
+
+} // namespace adikdrum
+
+#endif // ALIGNEDBUFFER_H
@@ -0,0 +1,45 @@
+#ifndef AUDIOCOMMAND_H
+#define AUDIOCOMMAND_H
+
+#include <cstddef> // Pour size_t
+#include <memory>
+
+namespace adikdrum {
+
+class AudioSound;
+
+// Messages envoyés par le thread UI au thread audio, via DrumPlayer::postCommand.
+// Le thread audio les applique au début de chaque bloc (DrumPlayer::processCommands),
+// c'est donc le seul à modifier l'état du mixer et des sons.
+enum class AudioCommandType {
+    Trigger,         // Jouer le son soundIndex sur le canal channel
+    Stop,            // Arrêter le canal channel
+    StopAll,         // Arrêter tous les canaux et remettre la lecture à zéro
+    SetVolume,       // Volume du canal channel (value)
+    SetGlobalVolume, // Volume global (value)
+    SetPan,          // Panoramique du canal channel (value)
+    SetSpeed,        // Vitesse de lecture du canal channel (value)
+    SetMute,         // Mute du canal channel (flag)
+    SetDelay,        // Délai du canal channel actif ou non (flag)
+    SetPolyphony,    // Nombre de voix maximum du canal channel (value)
+    SetInterpolation, // Interpolation des voix du mixer (value: resampler::Interpolation)
+    SetBar,          // Passer à la mesure bar au prochain pas
+    SetSound,        // Remplir l'emplacement vide soundIndex avec sound (chargement en arrière-plan)
+    RecordStep       // Enregistrement en attente: soundIndex, bar, step
+};
+
+// Structure POD: copiée telle quelle dans la file, sans allocation.
+struct AudioCommand {
+    AudioCommandType type = AudioCommandType::Stop;
+    size_t channel =0;
+    int soundIndex =0;
+    float value =0.0f;
+    bool flag =false;
+    size_t bar =0;
+    size_t step =0;
+    const std::shared_ptr<AudioSound>* sound = nullptr; // Non possédé: le thread audio en fait une copie
+};
+
+} // namespace adikdrum
+
+#endif // AUDIOCOMMAND_H
@@ -1,7 +1,9 @@
 #include "audiodriver.h"
 #include "constants.h"
 #include "adikdrum.h"
+#include "rtcheck.h"
 #include <iostream>
+#include <chrono>
 #include <portaudio.h>
 
 namespace adikdrum {
@@ -127,45 +129,23 @@ int AudioDriver::drumMachineCallback(const void* inputBuffer, void* outputBuffer
     // Note: Casting parameters in void here, to avoid compiler warnings: inused parameter.
     (void)inputBuffer;
     (void)timeInfo;
-    (void)statusFlags;
+    // Aucune allocation n'est permise à partir d'ici (vérifié avec make RTCHECK=1)
+    rtcheck::AudioThreadScope rtScope;
     AdikDrum::DrumMachineData* data = static_cast<AdikDrum::DrumMachineData*>(userData);
-    if (data && data->mixer) {
+    if (data && data->mixer && data->player) {
+        const auto startTime = std::chrono::steady_clock::now();
         float* out = static_cast<float*>(outputBuffer);
-        static size_t frameCounter = 0;
         const size_t outputNumChannels = 2; // Assumons stéréo pour l'instant
-        size_t samplesPerStep = static_cast<unsigned long>(data->sampleRate * data->player->secondsPerStep);
-        const size_t numSamples = framesPerBuffer * outputNumChannels;
-        std::vector<float> bufData(numSamples, 0.0f);
-
-        if (frameCounter >= samplesPerStep) {
-            frameCounter = 0;
-            auto numSteps = data->player->getNumSteps();
-            if (data->player->isPlaying()) {
-                data->player->clickStep_ = data->player->getCurrentStep();
-                if (data->player->isClicking() && data->player->clickStep_ % 4 == 0) {
-                  data->player->playMetronome();
-                }
-                data->player->playPattern(numSteps);
-            } else if (data->player->isClicking()) {
-                if (data->player->clickStep_ % 4 == 0) {
-                    data->player->playMetronome();
-                }
-                data->player->clickStep_ = (data->player->clickStep_ + 1) % numSteps;
-            }
-        }
-
-        // Mixer les sons en utilisant la fonction dédiée
-        data->mixer->mixSoundData(bufData, framesPerBuffer, outputNumChannels);
-
-        // Copie du buffer de mixage vers le buffer de sortie PortAudio
-        for (size_t i =0; i < numSamples; ++i) {
-          // Note: il est recommandé de convertir la sortie en static_cast float, pour éviter des comportements inattendus de convertion de types implicites.  
-          out[i] = static_cast<float>(data->player->hardClip(bufData[i] * data->mixer->getGlobalVolume() * GLOBAL_GAIN));
-        
-        }
-
-        if (data->player->isPlaying() || data->player->isClicking()) {
-            frameCounter += framesPerBuffer;
+        // Même traitement que le rendu hors ligne (OfflineRenderer)
+        data->player->renderBlock(out, framesPerBuffer, outputNumChannels, data->sampleRate);
+
+        if (data->stats) {
+            const auto elapsed = std::chrono::steady_clock::now() - startTime;
+            const uint64_t elapsedNs = std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+            const uint64_t bufferNs = static_cast<uint64_t>(framesPerBuffer * 1e9 / data->sampleRate);
+            data->stats->recordCallback(elapsedNs, bufferNs);
+            data->stats->recordStatus(statusFlags & paOutputUnderflow, statusFlags & paOutputOverflow);
+            data->stats->setActiveVoices(data->mixer->getNumActiveVoices());
         }
         return paContinue;
     }
@@ -1,9 +1,13 @@
 #include "audiofile.h"
 #include "audiosound.h"
+#include "constants.h"
 #include <iostream>
 #include <vector>
 #include <stdexcept>
 #include <sndfile.h>
+#include <algorithm>
+#include <cstdint>
+#include <cstdio> // Pour SEEK_SET
 
 namespace adikdrum {
 
@@ -14,6 +18,10 @@ AudioFile::~AudioFile() {
 }
 
 bool AudioFile::load(const std::string& filePath) {
+    return open(filePath) && read();
+}
+
+bool AudioFile::open(const std::string& filePath) {
     close(); // Close any previously opened file
 
     filePath_ = filePath;
@@ -24,9 +32,18 @@ bool AudioFile::load(const std::string& filePath) {
         std::cerr << "Error opening audio file: " << filePath_ << " - " << sf_strerror(nullptr) << std::endl;
         return false;
     }
+    return true;
+}
+
+bool AudioFile::read(size_t maxFrames) {
+    if (sndFile_ == nullptr) return false;
+    if (sf_seek(sndFile_, 0, SEEK_SET) < 0) {
+        std::cerr << "Error seeking audio file: " << filePath_ << std::endl;
+        return false;
+    }
 
     // Read all samples into the buffer
-    sf_count_t numFrames = sfInfo_.frames;
+    sf_count_t numFrames = std::min<sf_count_t>(sfInfo_.frames, static_cast<sf_count_t>(std::min<size_t>(maxFrames, INT64_MAX)));
     samples_.resize(numFrames * sfInfo_.channels);
 
     sf_count_t framesRead = sf_read_float(sndFile_, samples_.data(), numFrames * sfInfo_.channels);
@@ -48,7 +65,7 @@ void AudioFile::close() {
         }
         sndFile_ = nullptr;
     }
-    samples_.clear();
+    AlignedVector<float>().swap(samples_); // Libère la mémoire
     filePath_.clear();
     numChannels_ = 0;
     sampleRate_ = 0;
@@ -70,6 +87,13 @@ std::optional<uint32_t> AudioFile::getSampleRate() const {
     return std::nullopt;
 }
 
+std::optional<uint64_t> AudioFile::getNumFrames() const {
+    if (sndFile_ != nullptr) {
+        return static_cast<uint64_t>(sfInfo_.frames);
+    }
+    return std::nullopt;
+}
+
 std::optional<uint32_t> AudioFile::getBitDepth() const {
     if (sndFile_ != nullptr) {
         if (sndFile_) {
@@ -95,21 +119,67 @@ std::optional<uint32_t> AudioFile::getBitDepth() const {
 }
 
 
-std::optional<std::vector<float>> AudioFile::getSamples() const {
-    if (sndFile_ != nullptr) {
-        return samples_;
-    }
-    return std::nullopt;
+AlignedVector<float> AudioFile::takeSamples() {
+    AlignedVector<float> samples;
+    samples.swap(samples_);
+    return samples;
 }
 
-std::optional<SoundPtr> AudioFile::getSound() const {
+std::optional<SoundPtr> AudioFile::getSound() {
     if (!samples_.empty()) {
-        // Créer un shared_ptr vers un nouvel objet AudioSound
-        auto sound = std::make_shared<AudioSound>(samples_, getNumChannels().value_or(1));
-        return sound;
+        // Le SampleBuffer reprend les données décodées: pas de copie intermédiaire
+        auto buffer = std::make_shared<const SampleBuffer>(takeSamples(), getNumChannels().value_or(1),
+                getSampleRate().value_or(SAMPLE_RATE));
+        return std::make_shared<AudioSound>(std::move(buffer), getBitDepth().value_or(16));
     }
     return std::nullopt;
 }
 
 
+AudioFileWriter::AudioFileWriter() = default;
+
+AudioFileWriter::~AudioFileWriter() {
+    close();
+}
+
+bool AudioFileWriter::open(const std::string& filePath, int numChannels, int sampleRate, int format) {
+    close();
+
+    filePath_ = filePath;
+    sfInfo_ = SF_INFO();
+    sfInfo_.channels = numChannels;
+    sfInfo_.samplerate = sampleRate;
+    sfInfo_.format = format;
+    if (!sf_format_check(&sfInfo_)) {
+        std::cerr << "Error: Invalid audio format for file: " << filePath_ << std::endl;
+        return false;
+    }
+
+    sndFile_ = sf_open(filePath_.c_str(), SFM_WRITE, &sfInfo_);
+    if (sndFile_ == nullptr) {
+        std::cerr << "Error opening audio file for writing: " << filePath_ << " - " << sf_strerror(nullptr) << std::endl;
+        return false;
+    }
+    return true;
+}
+
+size_t AudioFileWriter::write(const float* data, size_t numFrames) {
+    if (sndFile_ == nullptr) return 0;
+    sf_count_t framesWritten = sf_writef_float(sndFile_, data, numFrames);
+    if (framesWritten < static_cast<sf_count_t>(numFrames)) {
+        std::cerr << "Warning: Could not write all frames to " << filePath_ << std::endl;
+    }
+    return framesWritten > 0 ? static_cast<size_t>(framesWritten) : 0;
+}
+
+void AudioFileWriter::close() {
+    if (sndFile_ != nullptr) {
+        if (sf_close(sndFile_) != 0) {
+            std::cerr << "Error closing audio file: " << filePath_ << " - " << sf_strerror(sndFile_) << std::endl;
+        }
+        sndFile_ = nullptr;
+    }
+}
+
+
 } // namespace adikdrum
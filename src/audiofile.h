@@ -8,6 +8,7 @@
 #include <optional>
 #include <sndfile.h> // Include libsndfile header
 #include "audiosound.h"
+#include "alignedbuffer.h"
 
 namespace adikdrum {
 
@@ -17,13 +18,21 @@ public:
     ~AudioFile();
 
     bool load(const std::string& filePath);
+    // Ouvre le fichier sans lire les données (getNumFrames, getSampleRate...), puis read
+    bool open(const std::string& filePath);
+    // Lit au plus maxFrames frames depuis le début du fichier, décodées directement
+    // dans un buffer aligné, celui que SampleBuffer reprendra sans copie
+    bool read(size_t maxFrames = SIZE_MAX);
     void close();
 
     std::optional<uint32_t> getNumChannels() const;
     std::optional<uint32_t> getSampleRate() const;
     std::optional<uint32_t> getBitDepth() const; // libsndfile retourne la profondeur en bits
-    std::optional<std::vector<float>> getSamples() const;
-    std::optional<SoundPtr> getSound() const;
+    std::optional<uint64_t> getNumFrames() const; // Longueur du fichier, même si read en a lu moins
+    // Reprend les données lues (sans copie): elles ne sont plus gardées par AudioFile
+    AlignedVector<float> takeSamples();
+    // Son créé à partir des données lues, qu'il reprend (sans copie)
+    std::optional<SoundPtr> getSound();
 
 private:
     SNDFILE* sndFile_ = nullptr;
@@ -32,7 +41,26 @@ private:
     uint16_t numChannels_ = 0;
     uint32_t sampleRate_ = 0;
     uint16_t bitDepth_ = 0;
-    std::vector<float> samples_;
+    AlignedVector<float> samples_;
+};
+
+// Écriture d'un fichier WAV par blocs, utilisée par le rendu hors ligne.
+class AudioFileWriter {
+public:
+    AudioFileWriter();
+    ~AudioFileWriter();
+
+    // format: format libsndfile, par défaut WAV 16 bits
+    bool open(const std::string& filePath, int numChannels, int sampleRate, int format = SF_FORMAT_WAV | SF_FORMAT_PCM_16);
+    // Écrit numFrames frames entrelacées, retourne le nombre de frames écrites
+    size_t write(const float* data, size_t numFrames);
+    void close();
+    bool isOpen() const { return sndFile_ != nullptr; }
+
+private:
+    SNDFILE* sndFile_ = nullptr;
+    SF_INFO sfInfo_;
+    std::string filePath_;
 };
 
 } // namespace adikdrum
@@ -3,6 +3,8 @@
 #include "audiosample.h"
 #include "soundfactory.h"
 #include "simpledelay.h" // Inclut l'en-tête de la classe SimpleDelay
+#include "mixkernels.h"
+#include "voicepool.h"
 
 #include <iostream>
 #include <cmath>
@@ -11,11 +13,14 @@
 
 namespace adikdrum {
 
-AudioMixer::AudioMixer(size_t numChannels) 
+AudioMixer::AudioMixer(size_t numChannels, size_t maxVoices) 
   : channelList_(numChannels), // initialiser la taille du vecteur  
     globalVolume_(0.8f), // Initialiser le volume global à 0.8
     numChannels_(numChannels), 
-    soundFactory_(44100, 0.3) {
+    soundFactory_(SAMPLE_RATE, 0.3),
+    sampleCache_(SAMPLE_CACHE_DIR),
+    voicePool_(maxVoices),
+    memoryManager_(*this) {
 
     soundBuffer = {};
     if (numChannels > channelList_.size()) {
@@ -24,7 +29,7 @@ AudioMixer::AudioMixer(size_t numChannels)
     for (auto& channel : channelList_) {
         channel.active_ = false;
         channel.volume = 1.0f;
-        channel.sound = nullptr; // Initialiser le shared_ptr à nullptr
+        channel.buffer = nullptr;
         channel.reserved = false; // Initialiser reserved à false
         channel.speed = 1.0f;
 
@@ -33,12 +38,22 @@ AudioMixer::AudioMixer(size_t numChannels)
     // Réserver le canal du métronome
     if (metronomeChannel_ >= 0 && metronomeChannel_ < channelList_.size()) {
         channelList_[metronomeChannel_].reserved = true;
+        channelList_[metronomeChannel_].maxPolyphony = 1; // Un clic chasse le précédent
     }
     // auto soundFactory_ = soundFactory_(44100, 0.3);
+    initDelays();
 
+}
+//----------------------------------------
+
+void AudioMixer::initDelays() {
     // Crée un vecteur de SimpleDelay, un pour chaque canal d'entrée.
     auto delayTime = 0.500f; // in seconds
     auto bufferSize = delayTime * sampleRate_;
+    // Recréés quand la fréquence change: garder les délais déjà activés
+    std::vector<bool> activeList;
+    for (auto& delay : delays_) activeList.push_back(delay.isActive());
+    delays_.clear();
 
     for (size_t i = 0; i < channelList_.size(); ++i) {
         delays_.emplace_back(bufferSize, sampleRate_); // Utilisez la sampleRate_ du mixer, c'est crucial!
@@ -48,8 +63,8 @@ AudioMixer::AudioMixer(size_t numChannels)
         delays_[i].setFeedback(0.5f);
         delays_[i].setGain(0.5f);
         // delays_[i].setActive(true); // Active le délai pour ce canal.
+        if (i < activeList.size()) delays_[i].setActive(activeList[i]);
     }
-
 }
 //----------------------------------------
 
@@ -58,37 +73,82 @@ AudioMixer::~AudioMixer() {
 }
 //----------------------------------------
 
-bool AudioMixer::init(int sampleRate, int channels, int bits) {
-    // Ajoute ici toute initialisation spécifique à AudioMixer si nécessaire
-    (void)sampleRate;
-    (void)channels;
+bool AudioMixer::init(int sampleRate, int channels, int bits, size_t maxFrames) {
     (void)bits;
-    std::cout << "AudioMixer initialized." << std::endl;
+    if (channels <= 0 || maxFrames == 0) {
+        std::cerr << "Erreur: Paramètres invalides pour l'initialisation du mixer." << std::endl;
+        return false;
+    }
+    if (!setSampleRate(sampleRate)) return false;
+    // Toute la mémoire utilisée par le callback audio est allouée ici, une seule fois.
+    maxFrames_ = maxFrames;
+    outputChannels_ = static_cast<size_t>(channels);
+    mixBuffer_.assign(maxFrames_ * outputChannels_, 0.0f);
+    soundBuffer.assign(maxFrames_ * maxSoundChannels_, 0.0f);
+    busBuffer_.assign(maxFrames_ * maxSoundChannels_, 0.0f);
+    voicePool_.setReleaseFrames(static_cast<size_t>(sampleRate * releaseTime_));
+    if (!streamer_.init(sampleRate_, maxFrames_)) return false;
+    // Le mixer lit désormais les buffers: le Reclaimer attend la fin de ses voix
+    blockEpoch_ = reclaimer_.getEpoch();
+    reclaimer_.attachReader();
+    std::cout << "AudioMixer initialized: " << maxFrames_ << " frames max par bloc, "
+        << outputChannels_ << " canaux de sortie, " << sampleRate_ << " Hz." << std::endl;
+    return true;
+}
+//----------------------------------------
+
+bool AudioMixer::setSampleRate(int sampleRate) {
+    if (sampleRate <= 0) {
+        std::cerr << "Erreur: Fréquence d'échantillonnage invalide: " << sampleRate << " Hz." << std::endl;
+        return false;
+    }
+    if (static_cast<size_t>(sampleRate) == sampleRate_) return true;
+    sampleRate_ = static_cast<size_t>(sampleRate);
+    soundFactory_.setSampleRate(sampleRate);
+    initDelays();
     return true;
 }
 //----------------------------------------
 
 void AudioMixer::close() {
     // Ajoute ici toute fermeture spécifique à AudioMixer si nécessaire
+    // Note: à appeler une fois le flux audio arrêté
+    voicePool_.clear();
+    streamer_.close();
+    reclaimer_.detachReader();
     std::cout << "AudioMixer closed." << std::endl;
 }
 //----------------------------------------
 
-void AudioMixer::play(size_t channel, SoundPtr sound) {
+void AudioMixer::play(size_t channel, const SoundPtr& sound, size_t frameOffset, float gain) {
     // Note: channel est de type size_t, donc forcément >=0, donc, on n'a pas besoin de le tester.
     if (channel < channelList_.size()) {
         // Autoriser la lecture sur le canal du métronome même s'il est réservé
         if (channel == metronomeChannel_ || !channelList_[channel].reserved) {
-            channelList_[channel].sound = sound;
-            channelList_[channel].active_ = true;
-            channelList_[channel].startPos = 0;
-            channelList_[channel].curPos = 0;
-            channelList_[channel].endPos = sound ? sound->getSize() : 0; // Gérer le cas où sound est nul
-            channelList_[channel].speed = sound ? sound->getSpeed() : 1.0f; // IMPORTANT : Initialiser la vitesse du canal
-            if (sound) {
-                sound->resetCurPos();
-                sound->setActive(true);
+            if (!sound) return;
+            // Pointeur brut: pas de compteur de références modifié sur le thread audio
+            const SampleBuffer* buffer = sound->getLiveBuffer();
+            if (!buffer) return;
+            sound->markTriggered();
+            auto& chan = channelList_[channel];
+            VoiceState* voice = voicePool_.allocate(channel, chan.maxPolyphony, frameOffset);
+            if (!voice) return;
+            voice->buffer = buffer;
+            voice->gain = gain;
+            voice->epoch = blockEpoch_;
+            voice->soundSpeed = sound->getSpeed();
+            voice->increment = resampler::speedToIncrement(static_cast<double>(chan.speed) * voice->soundSpeed);
+            if (buffer->isStreamed()) {
+                // La suite du son arrive par le thread d'E/S, pendant que la tête est jouée
+                const size_t voiceIndex = static_cast<size_t>(voice - voicePool_.getVoices().data());
+                voice->streamSlot = streamer_.acquire(buffer->getStreamSource(), buffer->getNumFrames(), voiceIndex, voice->serial);
             }
+            // Le canal garde le dernier son joué, pour les fonctions qui l'interrogent
+            chan.buffer = buffer;
+            chan.active_ = true;
+            chan.startPos = 0;
+            chan.curPos = 0;
+            chan.endPos = buffer->getTotalFrames() * buffer->getNumChannels();
         } else {
             std::cerr << "Erreur: Canal " << channel << " est réservé et ne peut pas être utilisé pour la lecture." << std::endl;
         }
@@ -106,12 +166,36 @@ bool AudioMixer::isChannelPlaying(size_t channel) const {
 }
 //----------------------------------------
 
+size_t AudioMixer::getChannelPolyphony(size_t channel) const {
+    if (channel < channelList_.size()) {
+        return channelList_[channel].maxPolyphony;
+    }
+    return 0;
+}
+//----------------------------------------
+
+void AudioMixer::setChannelPolyphony(size_t channel, size_t maxPolyphony) {
+    if (channel < channelList_.size()) {
+        channelList_[channel].maxPolyphony = std::min(maxPolyphony, voicePool_.getMaxVoices());
+    } else {
+        std::cerr << "Erreur : Canal " << channel << " invalide pour régler la polyphonie." << std::endl;
+    }
+}
+//----------------------------------------
+
+void AudioMixer::stopAll() {
+    voicePool_.releaseAll();
+    for (auto& chan : channelList_) {
+        chan.active_ = false;
+        chan.curPos = 0;
+    }
+}
+//----------------------------------------
+
 void AudioMixer::pause(size_t channel) {
     if (channel < channelList_.size()) {
         channelList_[channel].active_ = false;
-        if (channelList_[channel].sound) {
-            channelList_[channel].sound->setActive(false);
-        }
+        voicePool_.releaseChannel(channel);
     } else {
         std::cerr << "Canal invalide : " << channel << std::endl;
     }
@@ -121,7 +205,8 @@ void AudioMixer::pause(size_t channel) {
 void AudioMixer::stop(size_t channel) {
     if (channel < channelList_.size()) {
         channelList_[channel].active_ = false;
-        channelList_[channel].sound.reset(); // Décrémente le compteur de références
+        channelList_[channel].buffer = nullptr;
+        voicePool_.releaseChannel(channel); // Fondu court, sans clic
     } else {
         std::cerr << "Canal invalide : " << channel << std::endl;
     }
@@ -176,16 +261,6 @@ void AudioMixer::setChannelActive(size_t channel, bool active) {
 }
 //----------------------------------------
 
-SoundPtr AudioMixer::getSound(size_t channel) const {
-    if (channel < channelList_.size()) {
-        return channelList_[channel].sound; // Retourne le shared_ptr
-    } else {
-        std::cerr << "Canal invalide : " << channel << std::endl;
-        return nullptr;
-    }
-}
-//----------------------------------------
-
 void AudioMixer::reserveChannel(size_t channel, bool reserved) {
     if (channel < channelList_.size()) {
         channelList_[channel].reserved = reserved;
@@ -235,7 +310,6 @@ std::vector<ChannelInfo>& AudioMixer::getChannelList() {
 void AudioMixer::setChannelMuted(size_t channelIndex, bool muted) {
     if (channelIndex < channelList_.size()) {
         channelList_[channelIndex].muted = muted;
-        std::cout << "Canal " << channelIndex << " est maintenant " << (muted ? "muté" : "démuté") << "." << std::endl;
     } else {
         std::cerr << "Index de canal invalide: " << channelIndex + 1 << std::endl;
     }
@@ -254,14 +328,12 @@ void AudioMixer::resetMute() {
     for (auto& channel : channelList_) {
         channel.muted = false;
     }
-    std::cout << "Tous les canaux ont été démutés." << std::endl;
 }
 //----------------------------------------
 
 void AudioMixer::setChannelPan(size_t channelIndex, float panValue) {
     if (channelIndex < channelList_.size()) {
         channelList_[channelIndex].pan = std::clamp(panValue, -1.0f, 1.0f);
-        std::cout << "Pan du canal " << channelIndex << " réglé à " << channelList_[channelIndex].pan << std::endl;
     } else {
         std::cerr << "Index de canal invalide: " << channelIndex + 1 << std::endl;
     }
@@ -308,43 +380,192 @@ void AudioMixer::fadeOutLinear(size_t channelIndex, std::vector<float>& bufData,
 }
 //----------------------------------------
 
-void AudioMixer::mixSoundData(std::vector<float>& outputBuffer, size_t numFrames, size_t outputNumChannels) {
-    for (size_t i = 0; i < channelList_.size(); ++i) {
-        auto& chan = channelList_[i];
-        if (chan.isActive() && !chan.muted && chan.sound) {
-            auto numSoundChannels = chan.sound->getNumChannels();
-            soundBuffer.assign(numFrames * numSoundChannels, 0.0f);
+// Ajoute numFrames frames de src (mono ou stéréo) à dest, avec les gains gauche/droite.
+// Une destination mono reçoit la moyenne des deux côtés.
+static void accumulateFrames(float* dest, size_t destChannels, const float* src, size_t srcChannels,
+        size_t numFrames, float gainLeft, float gainRight) {
+    if (destChannels == 2) {
+        if (srcChannels == 1) {
+            mixkernels::panMonoToStereo(dest, src, numFrames, gainLeft, gainRight);
+        } else {
+            mixkernels::addStereo(dest, src, numFrames, gainLeft, gainRight);
+        }
+        return;
+    }
+    for (size_t j = 0; j < numFrames; ++j) {
+        const float left = src[j * srcChannels] * gainLeft;
+        const float right = src[j * srcChannels + srcChannels - 1] * gainRight;
+        if (destChannels == 1) {
+            dest[j] += 0.5f * (left + right);
+        } else {
+            dest[j * destChannels] += left;
+            dest[j * destChannels + 1] += right;
+        }
+    }
+}
+//----------------------------------------
 
-            size_t framesRead = chan.sound->readData(soundBuffer, numFrames); // Passer la vitesse à readData
-            if (framesRead > 0) {
-                float volume = chan.volume;
-                float pan = chan.pan;
+void AudioMixer::mixSoundData(float* outputBuffer, size_t numFrames, size_t outputNumChannels) {
+    if (numFrames > maxFrames_) {
+        // Ne devrait pas arriver: l'appelant découpe le bloc à la taille du buffer préalloué.
+        numFrames = maxFrames_;
+    }
+    for (auto& chan : channelList_) {
+        chan.numVoices = 0;
+    }
 
-                // Applique le délai *à tout le buffer du son*
-                if (delays_[i].isActive()) {
-                    delays_[i].processData(soundBuffer, framesRead, numSoundChannels); // Appel modifié
-                }
+    // Les voix des canaux sans délai vont directement dans la sortie
+    bool hasBus = false;
+    for (auto& voice : voicePool_.getVoices()) {
+        if (!voice.active) continue;
+        auto& chan = channelList_[voice.channel];
+        chan.numVoices++;
+        if (delays_[voice.channel].isActive()) {
+            hasBus = true;
+            continue;
+        }
+        const float gainLeft = chan.volume * std::max(0.0f, 1.0f - chan.pan);
+        const float gainRight = chan.volume * std::max(0.0f, 1.0f + chan.pan);
+        renderVoice(voice, outputBuffer, outputNumChannels, numFrames, gainLeft, gainRight);
+    }
 
-                for (size_t j = 0; j < numFrames; ++j) {
-                    float leftSample = 0.0f;
-                    float rightSample = 0.0f;
+    // Le délai d'un canal s'applique à la somme de ses voix
+    if (hasBus) {
+        for (size_t i = 0; i < channelList_.size(); ++i) {
+            if (channelList_[i].numVoices > 0 && delays_[i].isActive()) {
+                mixChannelBus(i, outputBuffer, numFrames, outputNumChannels);
+            }
+        }
+    }
 
-                    if (numSoundChannels == 1) {
-                        leftSample = soundBuffer[j] * volume * std::max(0.0f, 1.0f - pan);
-                        rightSample = soundBuffer[j] * volume * std::max(0.0f, 1.0f + pan);
-                    } else if (numSoundChannels == 2) {
-                        leftSample = soundBuffer[j * numSoundChannels] * volume * std::max(0.0f, 1.0f - pan);
-                        rightSample = soundBuffer[j * numSoundChannels + 1] * volume * std::max(0.0f, 1.0f + pan);
-                    }
+    // Plus ancien epoch encore lu par une voix: les buffers retirés avant peuvent être libérés
+    uint64_t readerEpoch = blockEpoch_;
+    size_t numActive =0;
+    for (const auto& voice : voicePool_.getVoices()) {
+        if (!voice.active) continue;
+        ++numActive;
+        readerEpoch = std::min(readerEpoch, voice.epoch);
+    }
+    reclaimer_.setReaderEpoch(readerEpoch);
+    streamer_.releaseUnused(voicePool_.getVoices());
 
-                    outputBuffer[j * outputNumChannels] += leftSample;
-                    outputBuffer[j * outputNumChannels + 1] += rightSample;
-                }
+    for (auto& chan : channelList_) {
+        if (chan.numVoices == 0) chan.active_ = false;
+    }
+    numActiveVoices_.store(numActive, std::memory_order_relaxed);
+}
+//----------------------------------------
+
+size_t AudioMixer::renderVoice(VoiceState& voice, float* destBuffer, size_t destChannels, size_t numFrames, float gainLeft, float gainRight) {
+    if (voice.startOffset >= numFrames) {
+        // Le démarrage tombe dans un bloc suivant
+        voice.startOffset -= numFrames;
+        if (voice.releasing && voice.releaseOffset >= numFrames) voice.releaseOffset -= numFrames;
+        return 0;
+    }
+    const size_t startFrame = voice.startOffset;
+    voice.startOffset = 0;
+    const size_t framesWanted = numFrames - startFrame;
+    const auto& chan = channelList_[voice.channel];
+    const SampleBuffer* buffer = voice.buffer;
+    const size_t numSoundChannels = buffer ? buffer->getNumChannels() : 0;
+    if (numSoundChannels == 0 || numSoundChannels > maxSoundChannels_) {
+        voicePool_.freeVoice(voice);
+        return 0;
+    }
+
+    size_t framesRead;
+    float* sampleBuf = soundBuffer.data();
+    if (chan.muted) {
+        // Un canal muté continue d'avancer, sans mixer les données
+        if (buffer->isStreamed()) {
+            // Le flux doit suivre la position: on le lit quand même
+            framesRead = streamer_.readFrames(voice.streamSlot, *buffer, sampleBuf, framesWanted, voice.phase, voice.increment, interpolation_);
+        } else {
+            voice.phase += framesWanted * voice.increment;
+            framesRead = resampler::phaseToFrames(voice.phase) < buffer->getNumFrames() ? framesWanted : 0;
+        }
+        if (voice.releasing) {
+            voice.releaseGain = 0.0f; // Inaudible: la voix peut être libérée tout de suite
+            framesRead = 0;
+        }
+    } else {
+        framesRead = buffer->isStreamed()
+            ? streamer_.readFrames(voice.streamSlot, *buffer, sampleBuf, framesWanted, voice.phase, voice.increment, interpolation_)
+            : buffer->readFrames(sampleBuf, framesWanted, voice.phase, voice.increment, interpolation_);
+        if (voice.releasing) {
+            applyRelease(voice, sampleBuf, numSoundChannels, startFrame, framesRead);
+        }
+        if (framesRead > 0) {
+            // Niveau crête du bloc, pour le vol de la voix la plus faible
+            float peak = 0.0f;
+            const size_t numSamples = framesRead * numSoundChannels;
+            for (size_t j = 0; j < numSamples; ++j) {
+                peak = std::max(peak, std::fabs(sampleBuf[j]));
             }
+            voice.level = peak * chan.volume * voice.gain;
+            accumulateFrames(destBuffer + startFrame * destChannels, destChannels, sampleBuf, numSoundChannels,
+                    framesRead, gainLeft * voice.gain, gainRight * voice.gain);
         }
     }
+
+    if (framesRead < framesWanted) {
+        // Fin du son ou fin du fondu
+        voicePool_.freeVoice(voice);
+    }
+    return framesRead;
 }
+//----------------------------------------
+
+void AudioMixer::applyRelease(VoiceState& voice, float* sampleBuf, size_t numSoundChannels, size_t startFrame, size_t& framesRead) {
+    const size_t blockFrames = startFrame + framesRead;
+    if (voice.releaseOffset >= blockFrames) {
+        voice.releaseOffset -= blockFrames;
+        return;
+    }
+    // Le fondu commence à releaseOffset dans le bloc, soit à cet indice dans sampleBuf
+    const size_t firstFrame = voice.releaseOffset > startFrame ? voice.releaseOffset - startFrame : 0;
+    voice.releaseOffset = 0;
+    const float step = voicePool_.getReleaseStep();
+    for (size_t j = firstFrame; j < framesRead; ++j) {
+        voice.releaseGain -= step;
+        if (voice.releaseGain <= 0.0f) {
+            framesRead = j; // La voix s'arrête ici
+            return;
+        }
+        for (size_t c = 0; c < numSoundChannels; ++c) {
+            sampleBuf[j * numSoundChannels + c] *= voice.releaseGain;
+        }
+    }
+}
+//----------------------------------------
+
+void AudioMixer::mixChannelBus(size_t channelIndex, float* outputBuffer, size_t numFrames, size_t outputNumChannels) {
+    // Le bus est stéréo dès qu'une voix du canal l'est
+    auto& chan = channelList_[channelIndex];
+    size_t busChannels = 1;
+    for (const auto& voice : voicePool_.getVoices()) {
+        if (voice.active && voice.channel == channelIndex && voice.buffer->getNumChannels() == 2) {
+            busChannels = 2;
+            break;
+        }
+    }
+    float* bus = busBuffer_.data();
+    std::fill(bus, bus + numFrames * busChannels, 0.0f);
+    size_t framesUsed = 0;
+    for (auto& voice : voicePool_.getVoices()) {
+        if (!voice.active || voice.channel != channelIndex) continue;
+        const size_t startFrame = std::min(voice.startOffset, numFrames);
+        const size_t framesRead = renderVoice(voice, bus, busChannels, numFrames, 1.0f, 1.0f);
+        if (framesRead > 0) framesUsed = std::max(framesUsed, startFrame + framesRead);
+    }
+    if (framesUsed == 0) return;
 
+    delays_[channelIndex].processData(bus, framesUsed, static_cast<int>(busChannels));
+    const float gainLeft = chan.volume * std::max(0.0f, 1.0f - chan.pan);
+    const float gainRight = chan.volume * std::max(0.0f, 1.0f + chan.pan);
+    accumulateFrames(outputBuffer, outputNumChannels, bus, busChannels, framesUsed, gainLeft, gainRight);
+}
 //----------------------------------------
 
 /*
@@ -392,13 +613,23 @@ void AudioMixer::mixSoundData(std::vector<float>& outputBuffer, size_t numFrames
 */
 
 
+float AudioMixer::getSpeed(size_t channel) const {
+    if (channel < channelList_.size()) {
+        return channelList_[channel].speed;
+    }
+    return 1.0f;
+}
+//----------------------------------------
+
 void AudioMixer::setSpeed(size_t channel, float speed) {
     if (channel < channelList_.size()) {
         channelList_[channel].speed = speed;
-        if (channelList_[channel].sound) {
-            channelList_[channel].sound->setSpeed(speed);
+        // Les voix en cours suivent le changement
+        for (auto& voice : voicePool_.getVoices()) {
+            if (voice.active && voice.channel == channel) {
+                voice.increment = resampler::speedToIncrement(static_cast<double>(speed) * voice.soundSpeed);
+            }
         }
-        std::cout << "Vitesse du canal " << channel << " réglée à " << speed << std::endl;
     } else {
         std::cerr << "Erreur : Canal " << channel << " invalide pour régler la vitesse." << std::endl;
     }
@@ -406,7 +637,29 @@ void AudioMixer::setSpeed(size_t channel, float speed) {
 //----------------------------------------
 
 SoundPtr AudioMixer::loadSound(const std::string& filePath) {
-    return std::make_shared<AudioSample>(filePath); // Charger le fichier
+    const SampleStorage storage = getSampleStorage();
+    // Son déjà décodé dans la banque, à la fréquence du moteur: lu dans la projection, sans copie
+    if (SoundPtr sound = sampleBank_.getSound(filePath, sampleRate_, storage)) {
+        return sound;
+    }
+    // Déjà décodé dans le processus (autre kit, kit rechargé, autre instance): sans lire le fichier
+    uint64_t fileHash = 0;
+    if (samplePool_.findHash(filePath, fileHash)) {
+        if (SoundPtr sound = samplePool_.getSound(fileHash, sampleRate_, storage)) return sound;
+    }
+    // Charger le fichier, converti à la fréquence du moteur si besoin
+    SoundPtr sound = std::make_shared<AudioSample>(filePath, sampleRate_, &sampleCache_, &streamer_);
+    if (storage == SampleStorage::Compact) {
+        // Pas encore joué: le buffer en float est libéré tout de suite
+        sound->setSampleStorage(storage);
+    }
+    // Empreinte calculée après le décodage (fichier dans le cache du système), et pas pour les sons
+    // lus en continu: un fichier de même contenu déjà chargé sous un autre nom reprend son buffer
+    const SampleBufferPtr buffer = sound->getSampleBuffer();
+    if (buffer && !buffer->isStreamed() && samplePool_.hashFile(filePath, fileHash)) {
+        return samplePool_.addSound(fileHash, sampleRate_, storage, sound);
+    }
+    return sound;
 }
 //----------------------------------------
 
@@ -4,15 +4,25 @@
 #include "audiosound.h"
 #include "soundfactory.h"
 #include "simpledelay.h"
+#include "alignedbuffer.h"
+#include "voicepool.h"
+#include "reclaimer.h"
+#include "samplecache.h"
+#include "samplebank.h"
+#include "samplepool.h"
+#include "diskstreamer.h"
+#include "samplememory.h"
+#include "constants.h"
 
 #include <vector>
 #include <cstddef>  // Pour size_t
 #include <memory> // Pour std::shared_ptr
+#include <atomic>
 
 namespace adikdrum {
 
 struct ChannelInfo {
-    SoundPtr sound; // shared_ptr vers l'objet AudioSound
+    const SampleBuffer* buffer; // Données du dernier son joué: indicateur seulement, peut avoir été libéré
     bool active_;
     float volume;
     float pan; // Ajouter cette ligne
@@ -23,12 +33,15 @@ struct ChannelInfo {
     size_t endPos;   // Position de fin de la lecture (taille du buffer)
     float speed = 0.1f; // Ajout de la vitesse de lecture (1.0 = vitesse normale)
 
-    bool isPlaying() const { return active_ && sound && curPos < endPos; }
+    size_t maxPolyphony =4; // Voix simultanées au plus sur ce canal (0 = pas de limite)
+    size_t numVoices =0;    // Voix actives sur ce canal, mis à jour à chaque bloc mixé
+
+    bool isPlaying() const { return active_ && buffer && curPos < endPos; }
     bool isActive() const { return active_; }
     void setActive(bool active) { active_ = active; }
     bool muted;
     ChannelInfo() 
-      : sound(nullptr), 
+      : buffer(nullptr), 
       active_(false), volume(1.0f), pan(0.0f),
       reserved(false), 
       startPos(0), curPos(0), endPos(0), 
@@ -39,13 +52,46 @@ struct ChannelInfo {
 class AudioMixer {
 public:
 
-    std::vector<float> soundBuffer;
-    AudioMixer(size_t numChannels);
+    static constexpr size_t defaultMaxVoices = 128; // Voix simultanées, tous canaux confondus
+    AlignedVector<float> soundBuffer; // Buffer de lecture d'un son, préalloué dans init
+    AudioMixer(size_t numChannels, size_t maxVoices = defaultMaxVoices);
     ~AudioMixer();
 
-    bool init(int sampleRate = 44100, int channels = 2, int bits = 16);
+    // Alloue le buffer de mixage et le buffer de lecture, pour maxFrames frames au maximum par bloc.
+    // Aucune allocation n'est faite ensuite dans mixSoundData.
+    bool init(int sampleRate = SAMPLE_RATE, int channels = 2, int bits = 16, size_t maxFrames = 4096);
     void close();
-    void play(size_t channel, SoundPtr sound); // Prend un shared_ptr
+    // Fréquence du moteur: délais, sons générés et conversion des sons chargés.
+    // Appelée par init; à appeler avant de charger les sons et avant le démarrage du flux audio.
+    bool setSampleRate(int sampleRate);
+    size_t getSampleRate() const { return sampleRate_; }
+    // Sons convertis à la fréquence du moteur, gardés sur disque entre deux lancements
+    SampleCache& getSampleCache() { return sampleCache_; }
+    // Banque précompilée (adikbank), consultée par loadSound avant le décodage des fichiers.
+    // A ouvrir avant le chargement des sons.
+    SampleBank& getSampleBank() { return sampleBank_; }
+    // Sons décodés partagés par tout le processus (même contenu: même buffer), consultés par loadSound
+    SamplePool& getSamplePool() { return samplePool_; }
+    // Format en mémoire des sons chargés ensuite par loadSound (le kit en cours de chargement).
+    // Peut être changé pendant le chargement: les threads de chargement le lisent à chaque son.
+    SampleStorage getSampleStorage() const { return sampleStorage_.load(std::memory_order_relaxed); }
+    void setSampleStorage(SampleStorage storage) { sampleStorage_.store(storage, std::memory_order_relaxed); }
+    // Lecture en continu des sons longs (têtes préchargées, thread d'E/S)
+    DiskStreamer& getDiskStreamer() { return streamer_; }
+    // Budget de mémoire des sons chargés (évictions et rechargements, thread du gestionnaire)
+    SampleMemoryManager& getMemoryManager() { return memoryManager_; }
+    // Début d'un bloc audio, avant les commandes et les déclenchements:
+    // fixe l'epoch du Reclaimer qui marque les voix déclenchées dans ce bloc.
+    void beginBlock() { blockEpoch_ = reclaimer_.getEpoch(); }
+    // Libération différée des buffers remplacés pendant qu'ils sont joués
+    Reclaimer& getReclaimer() { return reclaimer_; }
+    // Déclenche le son sur une voix du canal. frameOffset: décalage en frames du démarrage,
+    // à partir du début du prochain bloc mixé (précision à l'échantillon près).
+    // Les coups précédents continuent de sonner, dans la limite de polyphonie du canal.
+    // La voix pointe sur le SampleBuffer du son, sans copie du shared_ptr:
+    // le son doit rester en vie tant que la voix joue (drumSounds_ de DrumPlayer).
+    // gain: vélocité du coup (0 à 1), appliquée en plus du volume du canal.
+    void play(size_t channel, const SoundPtr& sound, size_t frameOffset =0, float gain =1.0f);
     void pause(size_t channel);
     void stop(size_t channel);
     float getVolume(size_t channel) const;
@@ -55,10 +101,17 @@ public:
 
     bool isChannelActive(size_t channel) const;
     void setChannelActive(size_t channel, bool active);
-    SoundPtr getSound(size_t channel) const; // Retourne un shared_ptr
     void reserveChannel(size_t channel, bool reserved); // Nouvelle fonction pour réserver un canal
     bool isChannelReserved(size_t channel) const; // Nouvelle fonction pour vérifier si un canal est réservé
     bool isChannelPlaying(size_t channel) const;
+    // Mis à jour à la fin de chaque bloc mixé: lisible depuis un autre thread
+    size_t getNumActiveVoices() const { return numActiveVoices_.load(std::memory_order_relaxed); }
+    size_t getChannelPolyphony(size_t channel) const;
+    void setChannelPolyphony(size_t channel, size_t maxPolyphony);
+    VoiceStealMode getVoiceStealMode() const { return voicePool_.getStealMode(); }
+    void setVoiceStealMode(VoiceStealMode mode) { voicePool_.setStealMode(mode); }
+    size_t getNumStolenVoices() const { return voicePool_.getNumSteals(); }
+    void stopAll(); // Fondu de sortie de toutes les voix
 
     size_t getChannelCurPos(size_t channel) const;
     void setChannelCurPos(size_t channel, size_t pos);
@@ -73,8 +126,16 @@ public:
     void fadeInLinear(size_t channelIndex, std::vector<float>& bufData, unsigned long durationFrames, int outputNumChannels);
     void fadeOutLinear(size_t channelIndex, std::vector<float>& bufData, unsigned long durationFrames, int outputNumChannels);
     ChannelInfo getChannelInfo(size_t channelIndex) { return channelList_[channelIndex]; }
-    void mixSoundData(std::vector<float>& outputBuffer, size_t framesPerBuffer, size_t outputNumChannels);
+    // Note: numFrames ne doit pas dépasser getMaxFrames()
+    void mixSoundData(float* outputBuffer, size_t numFrames, size_t outputNumChannels);
+    float* getMixBuffer() { return mixBuffer_.data(); }
+    size_t getMaxFrames() const { return maxFrames_; }
+    size_t getOutputChannels() const { return outputChannels_; }
+    float getSpeed(size_t channel) const;
     void setSpeed(size_t channel, float speed); // Nouvelle fonction pour régler la vitesse
+    // Interpolation des voix jouées à une vitesse différente de 1, pour tous les canaux
+    resampler::Interpolation getInterpolation() const { return interpolation_; }
+    void setInterpolation(resampler::Interpolation interp) { interpolation_ = interp; }
     size_t getNumChannels() const { return numChannels_; }
     SoundPtr loadSound(const std::string& filePath);
     SoundPtr genTone(const std::string& type ="sine", float freq =440.0f, float length =0.1);
@@ -85,10 +146,33 @@ private:
     std::vector<ChannelInfo> channelList_;
     float globalVolume_; // Variable pour le volume global
     size_t numChannels_;
-    size_t sampleRate_ =44100;
+    size_t sampleRate_ =SAMPLE_RATE;
     SoundFactory soundFactory_;
+    SampleCache sampleCache_;
+    SampleBank sampleBank_;
+    SamplePool& samplePool_ = SamplePool::getInstance();
+    std::atomic<SampleStorage> sampleStorage_{SampleStorage::Float32};
     std::vector<SimpleDelay> delays_;
     static const int metronomeChannel_ = 0;
+    static const size_t maxSoundChannels_ = 2; // Sons mono ou stéréo
+    static constexpr float releaseTime_ = 0.005f; // Fondu des voix volées ou arrêtées, en secondes
+
+    VoicePool voicePool_;
+    std::atomic<size_t> numActiveVoices_{0};
+    Reclaimer reclaimer_;
+    DiskStreamer streamer_;
+    SampleMemoryManager memoryManager_; // Après streamer_: ses sources y sont enregistrées
+    uint64_t blockEpoch_ =0; // Thread audio uniquement
+    resampler::Interpolation interpolation_ = resampler::Interpolation::Linear;
+    void initDelays();
+    size_t renderVoice(VoiceState& voice, float* destBuffer, size_t destChannels, size_t numFrames, float gainLeft, float gainRight);
+    void applyRelease(VoiceState& voice, float* sampleBuf, size_t numSoundChannels, size_t startFrame, size_t& framesRead);
+    void mixChannelBus(size_t channelIndex, float* outputBuffer, size_t numFrames, size_t outputNumChannels);
+
+    AlignedVector<float> mixBuffer_; // Buffer de mixage stéréo, préalloué dans init
+    AlignedVector<float> busBuffer_; // Somme des voix d'un canal avec délai, préallouée dans init
+    size_t maxFrames_ =0;
+    size_t outputChannels_ =2;
 };
 //==== End of class AudioMixer ====
 
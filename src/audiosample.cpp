@@ -1,37 +1,52 @@
 #include "audiosample.h"
+#include "resampler.h"
 #include <iostream>
 #include <vector> // N'oublie pas d'inclure vector ici
+#include <algorithm>
 
 namespace adikdrum {
 
-AudioSample::AudioSample(const std::string& filePath)
+AudioSample::AudioSample(const std::string& filePath, size_t targetRate, SampleCache* cache, DiskStreamer* streamer)
     : AudioSound(std::vector<float>()), // Appel explicite au constructeur de AudioSound
       audioFile_(),
-      filePath_(filePath) {
+      filePath_(filePath),
+      targetRate_(targetRate),
+      cache_(cache),
+      streamer_(streamer) {
     if (!filePath.empty()) {
         load(filePath);
     }
 }
 
 bool AudioSample::load(const std::string& filePath) {
+    // Fichier long: seule la tête est décodée, la suite sera lue pendant la lecture
+    if (streamer_ && streamer_->isEnabled() && audioFile_.open(filePath)) {
+        const size_t fileRate = audioFile_.getSampleRate().value_or(0);
+        if (audioFile_.getNumFrames().value_or(0) > streamer_->getMinStreamFrames(fileRate) && loadStreamed(filePath)) {
+            return true;
+        }
+    }
     if (audioFile_.load(filePath)) {
         std::optional<SoundPtr> sound = audioFile_.getSound();
+        // Les données décodées sont dans le SampleBuffer du son: le fichier n'a plus rien à garder
+        audioFile_.close();
         if (sound.has_value() && sound.value()) {
+            const AudioSound& loadedSound = *sound.value();
 
-
-            // Au lieu d'assigner directement, on *copie* l'AudioSound
-            AudioSound tempSound = *(sound.value());  // Appel au constructeur de copie de AudioSound
-
-            //on assigne les valeurs de tempSound à l'objet courant
-            rawData_ = tempSound.getRawData();
-            numChannels_ = tempSound.getNumChannels();
-            sampleRate_ = tempSound.getSampleRate();
-            bitDepth_ = tempSound.getBitDepth();
-            length_ = tempSound.getLength();
+            //on reprend le SampleBuffer de loadedSound: les données sont partagées, pas copiées
+            setSampleBuffer(loadedSound.getSampleBuffer());
+            rawData_.clear();
+            numChannels_ = loadedSound.getNumChannels();
+            sampleRate_ = loadedSound.getSampleRate();
+            bitDepth_ = loadedSound.getBitDepth();
+            length_ = loadedSound.getLength();
             endPos = length_;
-            speed_ = tempSound.getSpeed();
+            speed_ = loadedSound.getSpeed();
 
             filePath_ = filePath;
+            if (targetRate_ != 0 && sampleRate_ != targetRate_) {
+                convertToTargetRate();
+            }
             return true;
             /*
             rawData_ = sound.value()->getRawData();
@@ -49,6 +64,7 @@ bool AudioSample::load(const std::string& filePath) {
         } else {
             std::cerr << "Error: Could not get AudioSound data from file: " << filePath << std::endl;
             rawData_.clear();
+            setSampleBuffer(nullptr);
             length_ = 0;
             endPos = 0;
             return false;
@@ -56,6 +72,7 @@ bool AudioSample::load(const std::string& filePath) {
     } else {
         std::cerr << "Error loading audio file: " << filePath << std::endl;
         rawData_.clear();
+        setSampleBuffer(nullptr);
         length_ = 0;
         endPos = 0;
         return false;
@@ -63,4 +80,88 @@ bool AudioSample::load(const std::string& filePath) {
     
 }
 
+void AudioSample::convertToTargetRate() {
+    const SampleBufferPtr buffer = getSampleBuffer();
+    if (!buffer) return;
+    const size_t srcRate = sampleRate_;
+    AlignedVector<float> data;
+    size_t numChannels = numChannels_;
+    uint64_t fileHash = 0;
+    const bool useCache = cache_ && cache_->isEnabled() && SampleCache::hashFile(filePath_, fileHash);
+    const bool fromCache = useCache && cache_->read(fileHash, targetRate_, data, numChannels);
+    if (!fromCache) {
+        data = resampler::convertRate(buffer->getData(), buffer->getNumFrames(), numChannels_, srcRate, targetRate_);
+        if (useCache) cache_->write(fileHash, targetRate_, data, numChannels_);
+    }
+
+    numChannels_ = numChannels;
+    sampleRate_ = targetRate_;
+    length_ = data.size();
+    startPos = 0;
+    curPos = 0;
+    endPos = length_;
+    // Remplace les données à la fréquence du fichier, libérées ici
+    setSampleBuffer(std::make_shared<const SampleBuffer>(std::move(data), numChannels_, sampleRate_));
+    std::cout << "In AudioSample::convertToTargetRate, filePath: " << filePath_ << ", " << srcRate << " -> " << targetRate_
+        << " Hz" << (fromCache ? " (cache)" : "") << "\n";
+}
+
+bool AudioSample::loadStreamed(const std::string& filePath) {
+    const size_t fileRate = audioFile_.getSampleRate().value_or(0);
+    const size_t targetRate = targetRate_ != 0 ? targetRate_ : fileRate;
+    const size_t headFrames = streamer_->getHeadFrames(targetRate);
+    StreamSource source;
+    AlignedVector<float> head;
+    size_t numChannels = audioFile_.getNumChannels().value_or(0);
+
+    if (fileRate == targetRate) {
+        // Lu directement dans le fichier audio
+        if (!audioFile_.read(headFrames)) return false;
+        head = audioFile_.takeSamples();
+        source.filePath = filePath;
+        source.numFrames = audioFile_.getNumFrames().value_or(0);
+    } else {
+        // Lu dans le fichier converti du cache: sans cache, le son est chargé en entier
+        uint64_t fileHash = 0;
+        if (!cache_ || !cache_->isEnabled() || !SampleCache::hashFile(filePath, fileHash)) return false;
+        size_t numFrames = 0;
+        if (!cache_->read(fileHash, targetRate, head, numChannels, headFrames, &numFrames)) {
+            // Première fois: conversion complète, une seule fois
+            if (!audioFile_.read()) return false;
+            AlignedVector<float> samples = audioFile_.takeSamples();
+            const AlignedVector<float> converted = resampler::convertRate(samples.data(), samples.size() / numChannels,
+                    numChannels, fileRate, targetRate);
+            AlignedVector<float>().swap(samples); // Seule la tête reste chargée
+            if (!cache_->write(fileHash, targetRate, converted, numChannels)) return false;
+            numFrames = converted.size() / numChannels;
+            head.assign(converted.begin(), converted.begin() + std::min(converted.size(), headFrames * numChannels));
+        }
+        source.filePath = cache_->getEntryPath(fileHash, targetRate);
+        source.rawFloat = true;
+        source.dataOffset = SampleCache::getDataOffset();
+        source.numFrames = numFrames;
+    }
+    if (numChannels == 0 || head.empty()) return false;
+    source.numChannels = numChannels;
+    const size_t totalFrames = source.numFrames;
+    const StreamSource* streamSource = streamer_->addSource(std::move(source));
+
+    const size_t numHeadFrames = head.size() / numChannels;
+    setSampleBuffer(std::make_shared<const SampleBuffer>(std::move(head), numChannels, targetRate,
+                streamSource, totalFrames));
+    rawData_.clear();
+    numChannels_ = numChannels;
+    sampleRate_ = targetRate;
+    bitDepth_ = audioFile_.getBitDepth().value_or(16);
+    audioFile_.close(); // La suite est lue par le DiskStreamer
+    length_ = totalFrames * numChannels;
+    startPos = 0;
+    curPos = 0;
+    endPos = length_;
+    filePath_ = filePath;
+    std::cout << "In AudioSample::loadStreamed, filePath: " << filePath_ << ", " << numHeadFrames
+        << " frames préchargées sur " << totalFrames << "\n";
+    return true;
+}
+
 } // namespace adikdrum
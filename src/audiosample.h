@@ -3,6 +3,8 @@
 
 #include "audiosound.h"
 #include "audiofile.h"
+#include "samplecache.h"
+#include "diskstreamer.h"
 #include <string>
 #include <memory>
 
@@ -10,13 +12,24 @@ namespace adikdrum {
 
 class AudioSample : public AudioSound {
 public:
-    AudioSample(const std::string& filePath = "");
+    // targetRate: fréquence du moteur audio; un fichier à une autre fréquence est converti
+    // au chargement (0: pas de conversion). cache: conversions déjà faites (optionnel).
+    // streamer: les fichiers longs ne sont chargés que pour leur tête, la suite est lue en continu (optionnel).
+    AudioSample(const std::string& filePath = "", size_t targetRate = 0, SampleCache* cache = nullptr,
+            DiskStreamer* streamer = nullptr);
     bool load(const std::string& filePath);
     // Pas besoin de redéfinir le destructeur si la classe dérivée n'alloue pas de ressources spécifiques
 
 private:
     AudioFile audioFile_;
     std::string filePath_;
+    size_t targetRate_;
+    SampleCache* cache_;
+    DiskStreamer* streamer_;
+    // Convertit les données chargées à targetRate_, en passant par le cache
+    void convertToTargetRate();
+    // Charge la tête d'un fichier long et enregistre sa source auprès du streamer
+    bool loadStreamed(const std::string& filePath);
 };
 
 } // namespace adikdrum
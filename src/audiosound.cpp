@@ -2,6 +2,8 @@
 #include <vector>
 #include <cstring> // for std::memcpy
 #include <cmath>
+#include <algorithm>
+#include <chrono>
 #include <iostream>
 
 namespace adikdrum {
@@ -15,6 +17,20 @@ AudioSound::AudioSound(std::vector<float> data, size_t numChannels, size_t sampl
     startPos = 0;
     curPos = 0;
     endPos = length_;
+    updateSampleBuffer();
+}
+//----------------------------------------
+
+AudioSound::AudioSound(SampleBufferPtr buffer, size_t bitDepth)
+    : numChannels_(buffer ? buffer->getNumChannels() : 1),
+      sampleRate_(buffer ? buffer->getSampleRate() : 0),
+      bitDepth_(bitDepth),
+      active_(false) {
+    setSampleBuffer(std::move(buffer));
+    length_ = getSize();
+    startPos = 0;
+    curPos = 0;
+    endPos = length_;
 }
 //----------------------------------------
 
@@ -28,49 +44,78 @@ void AudioSound::setActive(bool active) {
 }
 //----------------------------------------
 
+std::vector<float>& AudioSound::getRawData() {
+    // Les données publiées sont immuables: on en reprend une copie pour la modifier
+    const SampleBufferPtr buffer = getSampleBuffer();
+    if (rawData_.empty() && buffer) {
+        rawData_.resize(buffer->getNumSamples());
+        buffer->copySamples(rawData_.data(), 0, rawData_.size());
+    }
+    return rawData_;
+}
+//----------------------------------------
+
+void AudioSound::updateSampleBuffer() {
+    setSampleBuffer(std::make_shared<const SampleBuffer>(rawData_.data(), rawData_.size(), numChannels_, sampleRate_));
+    length_ = rawData_.size();
+    endPos = length_;
+    // Les données ne sont plus gardées qu'en un seul exemplaire
+    rawData_.clear();
+    rawData_.shrink_to_fit();
+}
+//----------------------------------------
+
+void AudioSound::setSampleBuffer(SampleBufferPtr buffer) {
+    const SampleBuffer* live = buffer.get();
+    SampleBufferPtr oldBuffer = sampleBuffer_.exchange(std::move(buffer), std::memory_order_acq_rel);
+    liveBuffer_.store(live, std::memory_order_release);
+    if (oldBuffer && reclaimer_) {
+        // Publié avant le retrait: les blocs suivants ne lisent plus que le nouveau buffer
+        const size_t numBytes = oldBuffer->isExternal() ? 0 : oldBuffer->getNumBytes();
+        reclaimer_->retire(std::move(oldBuffer), numBytes);
+    }
+}
+//----------------------------------------
+
+uint64_t AudioSound::getClockNs() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+//----------------------------------------
+
+bool AudioSound::setSampleStorage(SampleStorage storage) {
+    const SampleBufferPtr current = getSampleBuffer();
+    if (!current) return false;
+    SampleBufferPtr buffer = storage == SampleStorage::Compact
+        ? SampleBuffer::makeCompact(*current) : SampleBuffer::makeFloat(*current);
+    if (!buffer) return false;
+    setSampleBuffer(std::move(buffer));
+    return true;
+}
+//----------------------------------------
+
 float AudioSound::getNextSample() {
-    if (curPos < endPos) {
-        return rawData_[curPos++];
+    const SampleBuffer* buffer = getLiveBuffer();
+    if (curPos < endPos && buffer) {
+        float sample = 0.0f;
+        buffer->copySamples(&sample, curPos++, 1);
+        return sample;
     }
     return 0.0f;
 }
 //----------------------------------------
 
-// with linear interpolation  for pitch
-size_t AudioSound::readData(std::vector<float>& bufData, size_t numFrames) {
-    if (!active_) return 0;
-
-    size_t framesRead = 0;
-    size_t bufferIndex = 0;
-    float currentSamplePos = static_cast<float>(curPos);
-    while (framesRead < numFrames && currentSamplePos < endPos / numChannels_) {
-        if (speed_ == 1.0f) {
-            // Si la vitesse est de 1.0, on lit directement l'échantillon sans interpolation
-            size_t sourceIndex = static_cast<size_t>(currentSamplePos);
-            for (size_t channel = 0; channel < numChannels_; ++channel) {
-                bufData[bufferIndex++] = rawData_[sourceIndex * numChannels_ + channel];
-            }
-            currentSamplePos += 1.0f;
-        } else {
-            // Sinon, on effectue l'interpolation linéaire comme avant
-            size_t sourceIndex = static_cast<size_t>(std::floor(currentSamplePos));
-            float sampleWeight = currentSamplePos - sourceIndex;
-
-            for (size_t channel = 0; channel < numChannels_; ++channel) {
-                float sample1 = rawData_[sourceIndex * numChannels_ + channel];
-                float sample2 = (sourceIndex + 1 < endPos / numChannels_)
-                                  ? rawData_[(sourceIndex + 1) * numChannels_ + channel]
-                                  : sample1;
-
-                float interpolatedSample =
-                    sample1 * (1 - sampleWeight) + sample2 * sampleWeight;
-                bufData[bufferIndex++] = interpolatedSample;
-            }
-            currentSamplePos += speed_;
-        }
-        curPos = static_cast<size_t>(std::floor(currentSamplePos));
-        framesRead++;
+// Avec interpolation linéaire pour la vitesse (resampler, position en virgule fixe)
+size_t AudioSound::readData(float* bufData, size_t numFrames) {
+    const SampleBuffer* buffer = getLiveBuffer();
+    if (!active_ || !buffer) return 0;
+    if (resampler::phaseToFrames(phase_) != curPos) {
+        // curPos a été modifié directement (resetCurPos, setCurPos)
+        phase_ = resampler::framesToPhase(curPos);
     }
+    const size_t framesRead = buffer->readFrames(bufData, numFrames, phase_,
+            resampler::speedToIncrement(speed_));
+    curPos = resampler::phaseToFrames(phase_);
     return framesRead;
 }
 //----------------------------------------
@@ -100,11 +145,13 @@ void AudioSound::applyStaticFadeOutLinear(float fadeOutStartPercent) {
     if (fadeOutStartPercent < 0.0f || fadeOutStartPercent > 1.0f) {
         return;
     }
+    auto& rawData = getRawData();
     size_t fadeOutStart = static_cast<size_t>(length_ * fadeOutStartPercent);
     for (size_t i = fadeOutStart; i < length_; ++i) {
         float amplitude = 1.0f - static_cast<float>(i - fadeOutStart) / (length_ - fadeOutStart);
-        rawData_[i] *= amplitude;
+        rawData[i] *= amplitude;
     }
+    updateSampleBuffer();
 }
 //----------------------------------------
 
@@ -112,12 +159,14 @@ void AudioSound::applyStaticFadeOutExp(float fadeOutStartPercent, float powerFac
     if (fadeOutStartPercent < 0.0f || fadeOutStartPercent > 1.0f || powerFactor <= 0.0f) {
         return;
     }
+    auto& rawData = getRawData();
     size_t fadeOutStart = static_cast<size_t>(length_ * fadeOutStartPercent);
     for (size_t i = fadeOutStart; i < length_; ++i) {
         float t = static_cast<float>(i - fadeOutStart) / (length_ - fadeOutStart);
         float amplitude = std::pow(1.0f - t, powerFactor);
-        rawData_[i] *= amplitude;
+        rawData[i] *= amplitude;
     }
+    updateSampleBuffer();
 }
 //----------------------------------------
 //==== End of class AudioSound ====
@@ -4,6 +4,10 @@
 #include <vector>
 #include <cstddef> // for size_t
 #include <memory>  // Pour std::shared_ptr
+#include <atomic>
+#include <cstdint>
+#include "samplebuffer.h"
+#include "reclaimer.h"
 
 namespace adikdrum {
 
@@ -15,10 +19,15 @@ public:
 
     // Constructeur principal
     AudioSound(std::vector<float> data, size_t numChannels = 1, size_t sampleRate = 44100, size_t bitDepth = 16);
+    // Son sur des données déjà publiées (banque de sons), sans copie
+    explicit AudioSound(SampleBufferPtr buffer, size_t bitDepth = 16);
 
-    // Constructeur de copie *modifié* pour partager rawData_
+    // Constructeur de copie *modifié* pour partager les données (SampleBuffer), sans les copier
     AudioSound(const AudioSound& other)
-        : rawData_(other.rawData_), // Partage le vecteur, ne le copie pas
+        : rawData_(other.rawData_),
+          sampleBuffer_(other.getSampleBuffer()),
+          liveBuffer_(other.getLiveBuffer()),
+          reclaimer_(other.reclaimer_),
           numChannels_(other.numChannels_),
           sampleRate_(other.sampleRate_),
           bitDepth_(other.bitDepth_),
@@ -35,9 +44,32 @@ public:
 
     virtual bool isActive() const { return active_; }
     virtual void setActive(bool active);
-    std::vector<float>& getRawData() { return rawData_; }
-    const float* getData() const { return rawData_.data(); }
-    size_t getSize() const { return rawData_.size(); }
+    // Données modifiables (génération, enveloppes), à publier ensuite avec updateSampleBuffer().
+    std::vector<float>& getRawData();
+    // Copie les données modifiées dans un nouveau SampleBuffer, lu par le mixer.
+    // Les voix en cours finissent sur l'ancien buffer, libéré ensuite par le Reclaimer.
+    void updateSampleBuffer();
+    // Remplace les données lues par le mixer (thread UI). L'ancien buffer est retiré
+    // par le Reclaimer s'il y en a un, sinon libéré tout de suite (son pas encore joué).
+    void setSampleBuffer(SampleBufferPtr buffer);
+    // Change le format des données en mémoire (voir SampleStorage), comme setSampleBuffer.
+    // Renvoie true si les données ont été converties.
+    bool setSampleStorage(SampleStorage storage);
+    // Copie du buffer courant: le gestionnaire de mémoire peut le remplacer depuis son thread
+    SampleBufferPtr getSampleBuffer() const { return sampleBuffer_.load(std::memory_order_acquire); }
+    // Buffer courant, pour le thread audio: ni verrou ni compteur de références
+    const SampleBuffer* getLiveBuffer() const { return liveBuffer_.load(std::memory_order_acquire); }
+    void setReclaimer(Reclaimer* reclaimer) { reclaimer_ = reclaimer; }
+    // Date du dernier déclenchement (thread audio, AudioMixer::play), pour le budget mémoire
+    void markTriggered() { lastTrigger_.store(getClockNs(), std::memory_order_relaxed); }
+    uint64_t getLastTrigger() const { return lastTrigger_.load(std::memory_order_relaxed); }
+    // Horloge monotone en nanosecondes
+    static uint64_t getClockNs();
+    // nullptr si les données ne sont pas en float (stockage compact)
+    const float* getData() const { const SampleBuffer* buffer = getLiveBuffer(); return buffer ? buffer->getData() : nullptr; }
+    size_t getSize() const { const SampleBufferPtr buffer = getSampleBuffer(); return buffer ? buffer->getNumSamples() : 0; }
+    // Taille des données en mémoire, en octets
+    size_t getNumBytes() const { const SampleBufferPtr buffer = getSampleBuffer(); return buffer ? buffer->getNumBytes() : 0; }
     size_t getLength() const { return length_; }
     virtual float getNextSample();
     void resetCurPos() { curPos = 0; }
@@ -46,8 +78,10 @@ public:
     size_t getNumChannels() const { return numChannels_; }
     size_t getSampleRate() const { return sampleRate_; }
     size_t getBitDepth() const { return bitDepth_; }
-    // virtual size_t readData(std::vector<float>& bufData, size_t numFrames);
-    virtual size_t readData(std::vector<float>& buffer, size_t numFrames);
+    // Note: bufData doit pouvoir contenir numFrames * numChannels échantillons.
+    // Pour un son lu en continu, seule la tête préchargée est lue ici (le mixer lit la suite).
+    virtual size_t readData(float* bufData, size_t numFrames);
+    size_t getNumFrames() const { const SampleBufferPtr buffer = getSampleBuffer(); return buffer ? buffer->getNumFrames() : 0; }
     virtual bool isFramesRemaining(size_t framesRemaining) const { return (endPos - curPos) >= framesRemaining * numChannels_; }
     virtual void applyStaticFadeOutLinear(float fadeOutStartPercent);
     virtual void applyStaticFadeOutExp(float fadeOutStartPercent, float powerFactor);
@@ -60,12 +94,17 @@ public:
     bool isFinished() const { return !active_ || curPos >= endPos / numChannels_; }
 
 protected:
-    std::vector<float> rawData_;
+    std::vector<float> rawData_; // Vide, sauf pendant une modification des données
+    std::atomic<SampleBufferPtr> sampleBuffer_; // Remplacé par le thread UI ou celui du gestionnaire de mémoire
+    std::atomic<const SampleBuffer*> liveBuffer_{nullptr}; // sampleBuffer_.get(), publié pour le mixer
+    Reclaimer* reclaimer_ = nullptr;
+    std::atomic<uint64_t> lastTrigger_{0}; // getClockNs, 0: jamais joué
     size_t numChannels_;
     size_t sampleRate_;
     size_t bitDepth_;
     size_t length_ = 0;
     float speed_ =1.0f;
+    uint64_t phase_ =0; // Position de readData en virgule fixe 32.32, curPos en est la partie entière
 
 private:
     bool active_ = false;
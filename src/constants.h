@@ -73,13 +73,33 @@ const std::vector<std::string> SOUND_LIST = {
     "singing.wav",
     "rhodes.wav",
 };
+// Kit de SOUND_LIST; les autres kits sont les sous-répertoires de MEDIA_DIR (commande kit)
+const std::string DEFAULT_KIT = "default";
 
 // Autres constantes globales
 const int NUM_SOUNDS = 16;
 const int NUM_STEPS = 16;
 const int INITIAL_BPM = 120;
 const int MIXER_CHANNELS = 32;
-const int SAMPLE_RATE = 44100;
+const int SAMPLE_RATE = 44100; // Fréquence par défaut du moteur audio
+// Fréquences proposées au démarrage; les sons sont convertis au chargement
+const std::vector<int> SUPPORTED_SAMPLE_RATES = {44100, 48000, 96000};
+// Sons convertis à la fréquence du moteur (voir SampleCache)
+const std::string SAMPLE_CACHE_DIR = "./cache/samples";
+// Banque de sons précompilée (adikbank), utilisée si elle existe
+const std::string SAMPLE_BANK_PATH = MEDIA_DIR + "/sounds.adkbank";
+// Sons chargés avant le démarrage du flux audio; les suivants arrivent pendant la lecture
+const size_t NUM_READY_PADS = 8;
+// Threads de chargement des sons (0: un par cœur)
+const size_t SAMPLE_LOADER_THREADS = 0;
+// Stockage des sons du kit en mémoire: "float32", ou "compact" (int16 / 24 bits, sans perte)
+const std::string SAMPLE_STORAGE = "float32";
+// Mémoire des sons décodés, en Mo (0: pas de limite); au-delà, les sons les moins récemment joués
+// ne gardent que leur attaque, et sont rechargés dès qu'ils sont rejoués (SampleMemoryManager)
+const size_t SAMPLE_MEMORY_BUDGET_MB = 0;
+// Fichiers de projet (commandes save, load et export): binaire, et export texte pour les comparer
+const std::string PROJECT_EXT = ".adkp";
+const std::string PROJECT_TEXT_EXT = ".txt";
 
 const float GLOBAL_GAIN = 0.2f;
 
@@ -0,0 +1,357 @@
+#include "diskstreamer.h"
+
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <cstring> // Pour std::memcpy, std::memmove
+
+namespace adikdrum {
+
+DiskStreamer::DiskStreamer(size_t maxStreams) {
+    for (size_t i = 0; i < maxStreams; ++i) {
+        slots_.push_back(std::make_unique<Slot>());
+    }
+}
+//----------------------------------------
+
+DiskStreamer::~DiskStreamer() {
+    stop();
+    close();
+}
+//----------------------------------------
+
+bool DiskStreamer::init(size_t sampleRate, size_t maxFrames) {
+    if (sampleRate == 0 || maxFrames == 0) {
+        std::cerr << "Erreur: Paramètres invalides pour l'initialisation du streamer." << std::endl;
+        return false;
+    }
+    close();
+    std::lock_guard<std::mutex> lock(serviceMutex_);
+    sampleRate_ = sampleRate;
+    // Fenêtre: un bloc à la vitesse maximale, plus les points de l'interpolation
+    stageCapacity_ = maxFrames * maxStreamSpeed_ + resampler::maxTapsBefore + resampler::maxTapsAfter + 1;
+    const size_t ringSamples = static_cast<size_t>(maxPrefetchMs * sampleRate / 1000.0) * maxStreamChannels_;
+    for (auto& slot : slots_) {
+        slot->ring.init(ringSamples);
+        slot->stage.assign(stageCapacity_ * maxStreamChannels_, 0.0f);
+    }
+    ioBuffer_.assign(ioChunkFrames_ * maxStreamChannels_, 0.0f);
+    return true;
+}
+//----------------------------------------
+
+void DiskStreamer::close() {
+    std::lock_guard<std::mutex> lock(serviceMutex_);
+    for (auto& slot : slots_) {
+        closeSlot(*slot);
+        slot->state.store(Free, std::memory_order_release);
+    }
+}
+//----------------------------------------
+
+const StreamSource* DiskStreamer::addSource(StreamSource source) {
+    std::lock_guard<std::mutex> lock(sourcesMutex_);
+    sources_.push_back(std::move(source));
+    return &sources_.back();
+}
+//----------------------------------------
+
+bool DiskStreamer::setPrefetchMs(double ms) {
+    if (ms <= 0.0 || ms > maxPrefetchMs) {
+        std::cerr << "Erreur: Profondeur de préchargement invalide: " << ms << " ms (maximum " << maxPrefetchMs << " ms)." << std::endl;
+        return false;
+    }
+    prefetchMs_.store(ms, std::memory_order_relaxed);
+    return true;
+}
+//----------------------------------------
+
+int DiskStreamer::acquire(const StreamSource* source, size_t headFrames, size_t voiceIndex, uint64_t serial) {
+    if (!source || source->numChannels == 0 || source->numChannels > maxStreamChannels_) return -1;
+    for (size_t i = 0; i < slots_.size(); ++i) {
+        Slot& slot = *slots_[i];
+        if (slot.state.load(std::memory_order_acquire) != Free) continue;
+        // Libre: le thread d'E/S n'y touche pas, on peut tout réinitialiser
+        slot.source = source;
+        slot.startFrame = headFrames;
+        slot.ownerVoice = voiceIndex;
+        slot.ownerSerial = serial;
+        slot.stageStart = 0;
+        slot.stageFrames = 0;
+        slot.ring.reset();
+        slot.eof.store(false, std::memory_order_relaxed);
+        slot.state.store(Opening, std::memory_order_release);
+        return static_cast<int>(i);
+    }
+    numRefused_.fetch_add(1, std::memory_order_relaxed);
+    return -1;
+}
+//----------------------------------------
+
+void DiskStreamer::fillStage(Slot& slot, const SampleBuffer& head, size_t endFrame) {
+    const size_t numChannels = head.getNumChannels();
+    size_t frame = slot.stageStart + slot.stageFrames;
+    if (frame < slot.startFrame && frame < endFrame) {
+        // Encore dans la tête préchargée
+        const size_t count = std::min(endFrame, slot.startFrame) - frame;
+        std::memcpy(slot.stage.data() + slot.stageFrames * numChannels, head.getData() + frame * numChannels,
+                count * numChannels * sizeof(float));
+        slot.stageFrames += count;
+        frame += count;
+    }
+    if (frame >= slot.startFrame && frame < endFrame) {
+        const size_t numSamples = slot.ring.read(slot.stage.data() + slot.stageFrames * numChannels,
+                (endFrame - frame) * numChannels);
+        slot.stageFrames += numSamples / numChannels;
+    }
+}
+//----------------------------------------
+
+size_t DiskStreamer::readFrames(int slotIndex, const SampleBuffer& head, float* out, size_t numFrames,
+        uint64_t& phase, uint64_t increment, resampler::Interpolation interp) {
+    if (slotIndex < 0 || static_cast<size_t>(slotIndex) >= slots_.size()) {
+        // Pas de flux pour cette voix: la tête seulement
+        return head.readFrames(out, numFrames, phase, increment, interp);
+    }
+    Slot& slot = *slots_[slotIndex];
+    const size_t numChannels = head.getNumChannels();
+    const size_t totalFrames = slot.source->numFrames;
+    const size_t firstFrame = resampler::phaseToFrames(phase);
+    if (numFrames == 0 || firstFrame >= totalFrames) return 0;
+
+    // Oublie les frames déjà jouées, en gardant les points nécessaires à l'interpolation
+    const size_t keepFrom = firstFrame > resampler::maxTapsBefore ? firstFrame - resampler::maxTapsBefore : 0;
+    if (keepFrom > slot.stageStart) {
+        const size_t drop = std::min(keepFrom - slot.stageStart, slot.stageFrames);
+        slot.stageFrames -= drop;
+        slot.stageStart += drop;
+        if (slot.stageFrames > 0) {
+            std::memmove(slot.stage.data(), slot.stage.data() + drop * numChannels,
+                    slot.stageFrames * numChannels * sizeof(float));
+        } else if (keepFrom > slot.stageStart) {
+            // La position a sauté plus loin que la fenêtre (canal muté): on saute aussi dans le flux
+            size_t frame = slot.stageStart;
+            if (frame < slot.startFrame) frame = std::min(keepFrom, slot.startFrame);
+            if (frame >= slot.startFrame && keepFrom > frame) {
+                frame += slot.ring.skip((keepFrom - frame) * numChannels) / numChannels;
+            }
+            slot.stageStart = frame;
+        }
+    }
+
+    // Lu avant la file: si eof est vu et que la file est vide ensuite, tout le fichier est passé
+    const bool eof = slot.eof.load(std::memory_order_acquire);
+    const uint64_t lastPhase = phase + increment * (numFrames - 1);
+    const size_t endFrame = std::min({totalFrames, resampler::phaseToFrames(lastPhase) + resampler::maxTapsAfter + 1,
+            slot.stageStart + stageCapacity_});
+    fillStage(slot, head, endFrame);
+
+    const size_t availEnd = slot.stageStart + slot.stageFrames;
+    const bool atEnd = availEnd >= totalFrames
+        || (eof && availEnd >= slot.startFrame && slot.ring.getReadAvailable() == 0);
+    size_t numSafe = numFrames;
+    if (!atEnd) {
+        // Frames dont tous les points d'interpolation sont dans la fenêtre
+        const size_t safeEnd = availEnd > resampler::maxTapsAfter ? availEnd - resampler::maxTapsAfter : 0;
+        const uint64_t limit = resampler::framesToPhase(safeEnd);
+        if (limit <= phase) {
+            numSafe = 0;
+        } else if (increment > 0) {
+            numSafe = static_cast<size_t>(std::min<uint64_t>(numFrames, (limit - phase + increment - 1) / increment));
+        }
+    }
+
+    // A la fin du son, la fenêtre se termine comme un SampleBuffer
+    uint64_t relPhase = phase - resampler::framesToPhase(slot.stageStart);
+    const size_t framesRead = resampler::process(out, numSafe, slot.stage.data(), slot.stageFrames, numChannels,
+            relPhase, increment, interp);
+    phase = relPhase + resampler::framesToPhase(slot.stageStart);
+    if (atEnd || framesRead < numSafe) return framesRead;
+
+    if (numSafe < numFrames) {
+        // Manque: la voix attend la suite en silence, à la même position
+        std::fill(out + numSafe * numChannels, out + numFrames * numChannels, 0.0f);
+        numUnderruns_.fetch_add(1, std::memory_order_relaxed);
+        numUnderrunFrames_.fetch_add(numFrames - numSafe, std::memory_order_relaxed);
+    }
+    return numFrames;
+}
+//----------------------------------------
+
+void DiskStreamer::releaseUnused(const std::vector<VoiceState>& voices) {
+    for (auto& slotPtr : slots_) {
+        Slot& slot = *slotPtr;
+        int state = slot.state.load(std::memory_order_relaxed);
+        if (state != Opening && state != Streaming) continue;
+        const bool owned = slot.ownerVoice < voices.size()
+            && voices[slot.ownerVoice].active && voices[slot.ownerVoice].serial == slot.ownerSerial;
+        if (owned) continue;
+        // Le thread d'E/S peut passer en même temps de Opening à Streaming
+        while ((state == Opening || state == Streaming)
+                && !slot.state.compare_exchange_weak(state, Closing, std::memory_order_acq_rel)) {
+        }
+    }
+}
+//----------------------------------------
+
+bool DiskStreamer::start(int periodMs) {
+    if (ioThread_.joinable()) return true;
+    if (periodMs <= 0) {
+        std::cerr << "Erreur: Période du thread d'E/S invalide: " << periodMs << " ms." << std::endl;
+        return false;
+    }
+    stopping_ = false;
+    ioThread_ = std::thread(&DiskStreamer::ioLoop, this, periodMs);
+    return true;
+}
+//----------------------------------------
+
+void DiskStreamer::stop() {
+    if (!ioThread_.joinable()) return;
+    {
+        std::lock_guard<std::mutex> lock(ioMutex_);
+        stopping_ = true;
+    }
+    ioCond_.notify_one();
+    ioThread_.join();
+}
+//----------------------------------------
+
+void DiskStreamer::ioLoop(int periodMs) {
+    std::unique_lock<std::mutex> lock(ioMutex_);
+    while (!stopping_) {
+        lock.unlock();
+        service();
+        lock.lock();
+        ioCond_.wait_for(lock, std::chrono::milliseconds(periodMs), [this] { return stopping_; });
+    }
+}
+//----------------------------------------
+
+void DiskStreamer::service() {
+    std::lock_guard<std::mutex> lock(serviceMutex_);
+    for (auto& slotPtr : slots_) {
+        Slot& slot = *slotPtr;
+        int state = slot.state.load(std::memory_order_acquire);
+        if (state == Opening) {
+            if (!openSlot(slot)) {
+                // La voix finira avec la tête
+                slot.eof.store(true, std::memory_order_release);
+            }
+            int expected = Opening;
+            if (!slot.state.compare_exchange_strong(expected, Streaming, std::memory_order_acq_rel)) {
+                state = expected; // Rendu entre-temps par le thread audio
+            } else {
+                state = Streaming;
+            }
+        }
+        if (state == Streaming) {
+            fillSlot(slot);
+        } else if (state == Closing) {
+            closeSlot(slot);
+            slot.state.store(Free, std::memory_order_release);
+        }
+    }
+}
+//----------------------------------------
+
+bool DiskStreamer::openSlot(Slot& slot) {
+    const StreamSource& source = *slot.source;
+    slot.ioFrame = slot.startFrame;
+    if (source.rawFloat) {
+        slot.rawFile = std::fopen(source.filePath.c_str(), "rb");
+        if (!slot.rawFile) {
+            std::cerr << "Erreur: Impossible d'ouvrir le flux: " << source.filePath << std::endl;
+            return false;
+        }
+        const long offset = static_cast<long>(source.dataOffset + slot.startFrame * source.numChannels * sizeof(float));
+        if (std::fseek(slot.rawFile, offset, SEEK_SET) != 0) {
+            std::cerr << "Erreur: Position invalide dans le flux: " << source.filePath << std::endl;
+            closeSlot(slot);
+            return false;
+        }
+    } else {
+        SF_INFO info = SF_INFO();
+        slot.sndFile = sf_open(source.filePath.c_str(), SFM_READ, &info);
+        if (!slot.sndFile) {
+            std::cerr << "Erreur: Impossible d'ouvrir le flux: " << source.filePath << " - " << sf_strerror(nullptr) << std::endl;
+            return false;
+        }
+        if (static_cast<size_t>(info.channels) != source.numChannels
+                || sf_seek(slot.sndFile, static_cast<sf_count_t>(slot.startFrame), SEEK_SET) < 0) {
+            std::cerr << "Erreur: Flux invalide: " << source.filePath << std::endl;
+            closeSlot(slot);
+            return false;
+        }
+    }
+    return true;
+}
+//----------------------------------------
+
+void DiskStreamer::closeSlot(Slot& slot) {
+    if (slot.sndFile) {
+        sf_close(slot.sndFile);
+        slot.sndFile = nullptr;
+    }
+    if (slot.rawFile) {
+        std::fclose(slot.rawFile);
+        slot.rawFile = nullptr;
+    }
+}
+//----------------------------------------
+
+void DiskStreamer::fillSlot(Slot& slot) {
+    if (slot.eof.load(std::memory_order_relaxed)) return;
+    const StreamSource& source = *slot.source;
+    const size_t numChannels = source.numChannels;
+    const size_t depthFrames = static_cast<size_t>(getPrefetchMs() * sampleRate_ / 1000.0);
+    while (true) {
+        const size_t queued = slot.ring.getReadAvailable() / numChannels;
+        if (queued >= depthFrames || slot.ioFrame >= source.numFrames) break;
+        const size_t count = std::min({depthFrames - queued, slot.ring.getWriteAvailable() / numChannels,
+                ioChunkFrames_, source.numFrames - slot.ioFrame});
+        if (count == 0) break;
+
+        size_t framesRead = 0;
+        if (slot.rawFile) {
+            framesRead = std::fread(ioBuffer_.data(), sizeof(float) * numChannels, count, slot.rawFile);
+        } else if (slot.sndFile) {
+            const sf_count_t numRead = sf_readf_float(slot.sndFile, ioBuffer_.data(), static_cast<sf_count_t>(count));
+            framesRead = numRead > 0 ? static_cast<size_t>(numRead) : 0;
+        }
+        slot.ring.write(ioBuffer_.data(), framesRead * numChannels);
+        slot.ioFrame += framesRead;
+        bytesRead_.fetch_add(framesRead * numChannels * sizeof(float), std::memory_order_relaxed);
+        if (framesRead < count) {
+            // Fichier plus court que prévu, ou erreur de lecture: le son s'arrête là
+            std::cerr << "Attention: Flux interrompu: " << source.filePath << std::endl;
+            slot.ioFrame = source.numFrames;
+        }
+    }
+    if (slot.ioFrame >= source.numFrames) {
+        // Après les dernières écritures dans la file
+        slot.eof.store(true, std::memory_order_release);
+    }
+}
+//----------------------------------------
+
+size_t DiskStreamer::getNumActiveStreams() const {
+    size_t count = 0;
+    for (const auto& slot : slots_) {
+        if (slot->state.load(std::memory_order_relaxed) != Free) ++count;
+    }
+    return count;
+}
+//----------------------------------------
+
+void DiskStreamer::resetStats() {
+    numUnderruns_.store(0, std::memory_order_relaxed);
+    numUnderrunFrames_.store(0, std::memory_order_relaxed);
+    numRefused_.store(0, std::memory_order_relaxed);
+    bytesRead_.store(0, std::memory_order_relaxed);
+}
+//----------------------------------------
+
+//==== End of class DiskStreamer ====
+
+} // namespace adikdrum
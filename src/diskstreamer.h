@@ -0,0 +1,159 @@
+#ifndef DISKSTREAMER_H
+#define DISKSTREAMER_H
+
+#include "samplebuffer.h"
+#include "voicepool.h"
+#include "spscring.h"
+#include "alignedbuffer.h"
+#include "resampler.h"
+
+#include <sndfile.h>
+#include <atomic>
+#include <memory>
+#include <deque>
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cstdio>
+#include <cstddef> // Pour size_t
+#include <cstdint>
+
+namespace adikdrum {
+
+// Fichier d'un son lu en continu depuis le disque
+struct StreamSource {
+    std::string filePath;
+    bool rawFloat = false;  // Entrée du SampleCache (floats bruts), sinon fichier lu par libsndfile
+    size_t dataOffset = 0;  // Octets avant les données (rawFloat)
+    size_t numChannels = 1;
+    size_t numFrames = 0;   // Longueur totale du son, tête comprise
+};
+
+// Lecture en continu des sons longs (boucles, nappes).
+// Seule la tête du son (headMs) est chargée en mémoire, dans son SampleBuffer:
+// l'attaque est jouée tout de suite, pendant que le thread d'E/S ouvre le fichier
+// et remplit la file de la voix avec la suite.
+//
+// Chaque voix jouant un son long prend un flux (slot), dans une réserve fixe allouée par init:
+// - une file sans verrou (SpscRing), remplie par le thread d'E/S jusqu'à la profondeur de préchargement;
+// - une fenêtre (stage) côté thread audio, où la tête puis la file sont recopiées:
+//   le rééchantillonnage (vitesse, interpolation) se fait dessus comme sur un SampleBuffer.
+// Si la file est vide avant la fin du son (disque trop lent), la voix attend en silence
+// et le manque est compté (underrun); si aucun flux n'est libre, seule la tête est jouée.
+class DiskStreamer {
+public:
+    static constexpr size_t defaultMaxStreams = 8;
+    static constexpr double defaultHeadMs = 250.0;      // Tête préchargée de chaque son long
+    static constexpr double defaultPrefetchMs = 500.0;  // Profondeur de préchargement des flux
+    static constexpr double maxPrefetchMs = 1000.0;     // Taille des files
+    static constexpr double defaultMinStreamSec = 3.0;  // Sons plus longs lus en continu
+
+    DiskStreamer(size_t maxStreams = defaultMaxStreams);
+    ~DiskStreamer();
+    DiskStreamer(const DiskStreamer&) = delete;
+    DiskStreamer& operator=(const DiskStreamer&) = delete;
+
+    // Alloue les files et les fenêtres, avant le démarrage du flux audio
+    bool init(size_t sampleRate, size_t maxFrames);
+    void close(); // Flux audio arrêté: ferme tous les fichiers
+
+    // Chargement des sons (thread UI ou de chargement)
+    bool isEnabled() const { return enabled_; }
+    void setEnabled(bool enabled) { enabled_ = enabled; }
+    size_t getMinStreamFrames(size_t sampleRate) const { return static_cast<size_t>(minStreamSec_ * sampleRate); }
+    void setMinStreamSec(double seconds) { minStreamSec_ = seconds; }
+    size_t getHeadFrames(size_t sampleRate) const { return static_cast<size_t>(headMs_ * sampleRate / 1000.0); }
+    void setHeadMs(double ms) { headMs_ = ms; }
+    // Enregistre la source d'un son long; le pointeur reste valide tant que le streamer existe
+    const StreamSource* addSource(StreamSource source);
+
+    // Profondeur de préchargement, modifiable pendant la lecture (bornée à maxPrefetchMs)
+    double getPrefetchMs() const { return prefetchMs_.load(std::memory_order_relaxed); }
+    bool setPrefetchMs(double ms);
+
+    // Thread audio, sans allocation ni verrou
+    // Prend un flux pour la voix voiceIndex (identifiée par son numéro serial); -1 si aucun n'est libre
+    int acquire(const StreamSource* source, size_t headFrames, size_t voiceIndex, uint64_t serial);
+    // Comme SampleBuffer::readFrames, sur la tête puis le flux. En cas de manque, complète en silence:
+    // moins de numFrames frames lues signifie la fin du son.
+    size_t readFrames(int slotIndex, const SampleBuffer& head, float* out, size_t numFrames,
+            uint64_t& phase, uint64_t increment, resampler::Interpolation interp);
+    // Fin de bloc: rend les flux des voix terminées, volées ou remplacées
+    void releaseUnused(const std::vector<VoiceState>& voices);
+
+    // Thread d'E/S: service() toutes les periodMs millisecondes
+    bool start(int periodMs = 5);
+    void stop();
+    bool isRunning() const { return ioThread_.joinable(); }
+    // Un passage: ouvre, remplit et ferme les flux demandés.
+    // Appelée par le thread d'E/S, ou directement avant chaque bloc (rendu hors ligne).
+    void service();
+
+    size_t getMaxStreams() const { return slots_.size(); }
+    size_t getNumActiveStreams() const;
+    size_t getNumUnderruns() const { return numUnderruns_.load(std::memory_order_relaxed); }
+    size_t getNumUnderrunFrames() const { return numUnderrunFrames_.load(std::memory_order_relaxed); }
+    size_t getNumRefused() const { return numRefused_.load(std::memory_order_relaxed); }
+    size_t getBytesRead() const { return bytesRead_.load(std::memory_order_relaxed); }
+    void resetStats();
+
+private:
+    enum SlotState { Free, Opening, Streaming, Closing };
+    static constexpr size_t maxStreamChannels_ = 2;
+    static constexpr size_t maxStreamSpeed_ = 8; // Vitesse maximale sans manque (fenêtre)
+    static constexpr size_t ioChunkFrames_ = 4096;
+
+    struct Slot {
+        std::atomic<int> state{Free};
+        std::atomic<bool> eof{false}; // Le thread d'E/S a tout écrit dans la file
+        // Écrits par le thread audio avant Opening
+        const StreamSource* source = nullptr;
+        size_t startFrame = 0;
+        size_t ownerVoice = 0;
+        uint64_t ownerSerial = 0;
+        SpscRing ring;
+        // Thread audio: fenêtre de frames consécutives du son, à partir de stageStart
+        AlignedVector<float> stage;
+        size_t stageStart = 0;
+        size_t stageFrames = 0;
+        // Thread d'E/S
+        SNDFILE* sndFile = nullptr;
+        std::FILE* rawFile = nullptr;
+        size_t ioFrame = 0; // Prochaine frame à lire dans le fichier
+    };
+
+    std::vector<std::unique_ptr<Slot>> slots_;
+    std::deque<StreamSource> sources_; // deque: adresses stables
+    std::mutex sourcesMutex_;
+    size_t sampleRate_ = 0;
+    size_t stageCapacity_ = 0; // En frames
+    bool enabled_ = true;
+    double headMs_ = defaultHeadMs;
+    double minStreamSec_ = defaultMinStreamSec;
+    std::atomic<double> prefetchMs_{defaultPrefetchMs};
+    std::vector<float> ioBuffer_; // Thread d'E/S
+    std::mutex serviceMutex_;     // Entre le thread d'E/S et un appel direct à service()
+
+    std::atomic<size_t> numUnderruns_{0};
+    std::atomic<size_t> numUnderrunFrames_{0};
+    std::atomic<size_t> numRefused_{0};
+    std::atomic<size_t> bytesRead_{0};
+
+    std::thread ioThread_;
+    std::mutex ioMutex_;
+    std::condition_variable ioCond_;
+    bool stopping_ = false;
+
+    void ioLoop(int periodMs);
+    bool openSlot(Slot& slot);
+    void closeSlot(Slot& slot);
+    void fillSlot(Slot& slot);
+    void fillStage(Slot& slot, const SampleBuffer& head, size_t endFrame);
+};
+//==== End of class DiskStreamer ====
+
+} // namespace adikdrum
+
+#endif // DISKSTREAMER_H
@@ -2,6 +2,8 @@
 #include "audiosound.h"
 #include "audiomixer.h"
 #include "adikpattern.h"
+#include "constants.h"
+#include "mixkernels.h"
 
 #include <cmath>
 #include <vector>
@@ -9,6 +11,8 @@
 #include <memory>
 #include <algorithm> // pour std::clamp
 #include <chrono>
+#include <sstream>
+#include <iomanip>
 
 
 namespace adikdrum {
@@ -18,7 +22,7 @@ DrumPlayer::DrumPlayer(int numSounds, int numSteps)
       clickStep_(0),
       // pattern_(numSounds, std::vector<bool>(numSteps, false)),
       numSteps_(numSteps),
-      sampleRate_(44100),
+      sampleRate_(SAMPLE_RATE),
       playing_(false),
       recording_(false),
       clicking_(false),
@@ -39,12 +43,19 @@ DrumPlayer::DrumPlayer(int numSounds, int numSteps)
     std::cout << "DrumPlayer::Constructor - numSteps_: " << numSteps_ << std::endl;
     // Création d'un objet AdikPattern avec 2 barres
     curPattern_ = std::make_shared<AdikPattern>(2);
-    patternData_ = curPattern_->getPatternData();
     curPattern_->setPosition(0, 0);
+    // Première copie publiée, prise tout de suite: le flux audio n'est pas encore démarré
+    publishPattern();
+    audioPattern_ = pendingPattern_.exchange(nullptr);
+    ackPattern_.store(audioPattern_);
+    lastAckPattern_ = audioPattern_;
     // quantizer_ = std::make_unique<Quantizer>(curPattern_, bpm_);
     // Initialisation du quantificateur APRÈS que curPattern_ soit créé
     // Il a besoin du pattern, d'une référence au BPM de DrumPlayer, et du nombre de sons.
     quantizer_ = std::make_unique<Quantizer>(curPattern_, bpm_, numSounds_);
+    // Réserve de la place pour les enregistrements en attente, pour ne pas allouer dans le callback
+    pendingRecordings_.reserve(maxPendingRecordings_);
+    recordingsToMerge_.reserve(maxPendingRecordings_);
 
     quantResolutionMap[1] = numSteps_;       // Ronde = Mesure complète (16 steps)
     quantResolutionMap[2] = numSteps_ / 2;   // Blanche = Demi-mesure (8 steps)
@@ -62,6 +73,16 @@ DrumPlayer::~DrumPlayer() {
 
 void DrumPlayer::setMixer(AudioMixer& mixer) {
     mixer_ = &mixer;
+    // Copie initiale des paramètres des canaux, avant le démarrage du flux audio
+    channelParams_.assign(mixer_->getNumChannels(), ChannelParams());
+    for (size_t i = 0; i < channelParams_.size(); ++i) {
+        channelParams_[i].volume = mixer_->getVolume(i);
+        channelParams_[i].pan = mixer_->getChannelPan(i);
+        channelParams_[i].speed = mixer_->getChannelList()[i].speed;
+        channelParams_[i].delay = mixer_->isDelayActive(i);
+        channelParams_[i].polyphony = mixer_->getChannelPolyphony(i);
+    }
+    globalVolume_ = mixer_->getGlobalVolume();
 }
 //----------------------------------------
 
@@ -123,8 +144,8 @@ void DrumPlayer::playSound0(int soundIndex) {
 //----------------------------------------
 
 SoundPtr DrumPlayer::getSound(size_t soundIndex) {
-    if (soundIndex < drumSounds_.size()) {
-        return drumSounds_[soundIndex];
+    if (soundIndex < uiSounds_.size()) {
+        return uiSounds_[soundIndex];
     } else {
         std::cerr << "Erreur: Index de son hors limites: " << soundIndex << std::endl;
         return nullptr;
@@ -135,7 +156,11 @@ SoundPtr DrumPlayer::getSound(size_t soundIndex) {
 void DrumPlayer::playSound(size_t soundIndex) {
     auto sound = getSound(soundIndex);
     if (sound) {
-        mixer_->play(soundIndex+1, sound);
+        AudioCommand cmd;
+        cmd.type = AudioCommandType::Trigger;
+        cmd.channel = soundIndex + 1;
+        cmd.soundIndex = static_cast<int>(soundIndex);
+        postCommand(cmd);
         lastSoundIndex_ = soundIndex;
     } else {
         std::cerr << "Erreur: Aucun son trouvé avec cet (index: "
@@ -148,9 +173,12 @@ void DrumPlayer::playLastSound() {
     SoundPtr lastSound = getSound(lastSoundIndex_);
     if (lastSound) {
         const int channelIndex = 31;
-        // Créer une *copie* du AudioSound en utilisant le constructeur de copie
-        SoundPtr soundToPlay = std::make_shared<AudioSound>(*lastSound); // Appel explicite au constructeur de copie
-        mixer_->play(channelIndex, soundToPlay); // Jouer la copie
+        // Une nouvelle voix lit les mêmes données que le son: plus besoin de copie
+        AudioCommand cmd;
+        cmd.type = AudioCommandType::Trigger;
+        cmd.channel = channelIndex;
+        cmd.soundIndex = static_cast<int>(lastSoundIndex_);
+        postCommand(cmd);
 
     }
 }
@@ -168,24 +196,25 @@ void DrumPlayer::stopPlay() {
 //----------------------------------------
 
 void DrumPlayer::stopAllSounds() {
-    auto& chanList = mixer_->getChannelList();  
-    for (auto& chan : chanList) {
-        chan.setActive(0);
-        chan.curPos =0;
-    }
-
-    for (const auto& sound : drumSounds_) {
-        if (sound) {
-            sound->setActive(false);
-        }
-    }
-
     playing_ = false;
     recording_ = false;
     clicking_ = false;
+    // Les canaux et les positions de lecture sont remis à zéro par le thread audio
+    AudioCommand cmd;
+    cmd.type = AudioCommandType::StopAll;
+    postCommand(cmd);
+}
+//----------------------------------------
+
+void DrumPlayer::stopAllChannels() {
+    // Fondu de sortie de toutes les voix, sans clic
+    mixer_->stopAll();
+
     currentStep_ = 0;
     clickStep_ = 0;
     beatCounter_ = 0;
+    framesToNextStep_ = 0.0;
+    seekSong(0);
 }
 //----------------------------------------
 
@@ -199,16 +228,7 @@ void DrumPlayer::startClick() {
       clickStep_ =0;
       beatCounter_ =0;
     }
-
-    if (mixer_) {
-        mixer_->setChannelActive(0, true); 
-    }
-    // Activer les sons du métronome (s'assurer qu'ils sont chargés)
-    if (soundClick1_) {
-        soundClick1_->setActive(true);
-    } if (soundClick2_) {
-        soundClick2_->setActive(true);
-    }
+    // Note: le canal du métronome est activé par le thread audio, au premier clic joué
 
 }
 //----------------------------------------
@@ -216,20 +236,16 @@ void DrumPlayer::startClick() {
 void DrumPlayer::stopClick() {
     clicking_ = false;
     if (mixer_) {
-        if (mixer_->isChannelActive(0)) {
-            mixer_->stop(0);
-        }
-    }
-    if (soundClick1_) {
-        soundClick1_->setActive(false);
-    } if (soundClick2_) {
-        soundClick2_->setActive(false);
+        AudioCommand cmd;
+        cmd.type = AudioCommandType::Stop;
+        cmd.channel = 0;
+        postCommand(cmd);
     }
 
 }
 //----------------------------------------
 
-void DrumPlayer::playMetronome() {
+void DrumPlayer::playMetronome(size_t frameOffset) {
     if (playing_) {
         // valable aussi pour si currentStep =0 et beatCounter =0
         beatCounter_ = currentStep_ / 4; // Note: Le résultat est une division entière puisque les deux nombres sont des entiers.
@@ -237,9 +253,9 @@ void DrumPlayer::playMetronome() {
     
     if (mixer_) {
         if (beatCounter_ % 4 == 0 && soundClick1_) {
-            mixer_->play(0, soundClick1_);
+            mixer_->play(0, soundClick1_, frameOffset);
         } else if (soundClick2_) {
-            mixer_->play(0, soundClick2_);
+            mixer_->play(0, soundClick2_, frameOffset);
         }
         beatCounter_ = (beatCounter_ + 1) % 4;
     }
@@ -248,29 +264,32 @@ void DrumPlayer::playMetronome() {
 }
 //----------------------------------------
 
-void DrumPlayer::playPattern(size_t mergeIntervalSteps) {
+void DrumPlayer::playPattern(size_t mergeIntervalSteps, size_t frameOffset) {
     if (mixer_ && playing_) {
-        if (curPattern_) {
+        // Note: audioPattern_ n'est modifié que par le thread audio: applyPendingPattern y reprend
+        // la copie immuable publiée par le thread UI (pendingPattern_), entre deux pas ou à l'arrêt
+        if (audioPattern_) {
             // *** Mettre à jour lastUpdateTime_ ICI, au début de chaque "pas" logique ***
             lastUpdateTime_ = std::chrono::high_resolution_clock::now();
             // auto endTime = std::chrono::high_resolution_clock::now();
             // std::chrono::duration<double> lastTime = lastUpdateTime_ - endTime;
             // std::cout << "DEBUG, in playPattern: lastUpdateTime: " << lastTime.count() << "\n";
 
-            currentBar_ = curPattern_->getCurrentBar();
-            numTotalBars_ = curPattern_->getNumBars();
-            numSteps_ = curPattern_->getBarLength(currentBar_);
+            // Nouveau kit pris au premier pas d'une mesure
+            if (currentStep_ == 0) applyPendingKit();
+            // Nouvelle copie du pattern prise entre deux pas
+            applyPendingPattern();
 
-            // Jouer les sons du pas actuel (cette partie reste inchangée)
-            auto& currentBarData = curPattern_->getPatternData()[currentBar_];
-            for (size_t i = 0; i < currentBarData.size(); ++i) {
-                if (currentStep_ < currentBarData[i].size() &&
-                    currentBarData[i][currentStep_]) {
-                    if (drumSounds_[i]) {
-                        mixer_->play(static_cast<int>(i + 1), drumSounds_[i]);
-                    }
+            numTotalBars_ = audioPattern_->getNumBars();
+            if (currentBar_ >= numTotalBars_) currentBar_ = 0; // Copie avec moins de mesures
+            numSteps_ = audioPattern_->getBarLength(currentBar_);
+
+            // Jouer les sons du pas actuel: un masque lu, un bit par son déclenché
+            audioPattern_->getStepMask(currentBar_, currentStep_).forEach([&](size_t i) {
+                if (i < drumSounds_.size() && drumSounds_[i]) {
+                    mixer_->play(static_cast<int>(i + 1), drumSounds_[i], frameOffset);
                 }
-            }
+            });
 
             // Incrémente le pas courant
             currentStep_++;
@@ -283,10 +302,8 @@ void DrumPlayer::playPattern(size_t mergeIntervalSteps) {
                 if (nextBarIndex >= numTotalBars_) {
                     nextBarIndex = 0;
                 }
-                curPattern_->setCurrentBar(nextBarIndex);
                 currentBar_ = nextBarIndex;
             }
-            curPattern_->setCurrentStep(currentStep_);
 
             // *** NOUVELLE LOGIQUE POUR LA FUSION : DÉCLENCHEMENT CONDITIONNEL ***
             // La fusion est déclenchée si le pas courant (après incrémentation)
@@ -317,6 +334,84 @@ void DrumPlayer::playPattern(size_t mergeIntervalSteps) {
 }
 //----------------------------------------
 
+void DrumPlayer::scheduleSteps(size_t numFrames, double sampleRate) {
+    if (!playing_ && !clicking_) {
+        // À l'arrêt, le prochain pas sera joué dès le démarrage
+        framesToNextStep_ = 0.0;
+        return;
+    }
+
+    const double framesPerStep = sampleRate * secondsPerStep;
+    if (framesPerStep < 1.0) return;
+
+    // Chaque pas tombant dans ce bloc est déclenché à son décalage exact.
+    // La partie fractionnaire est conservée dans framesToNextStep_, pour éviter la dérive du tempo.
+    while (framesToNextStep_ < static_cast<double>(numFrames)) {
+        size_t frameOffset = framesToNextStep_ > 0.0 ? static_cast<size_t>(framesToNextStep_) : 0;
+        tickStep(frameOffset);
+        framesToNextStep_ += framesPerStep;
+    }
+    framesToNextStep_ -= static_cast<double>(numFrames);
+}
+//----------------------------------------
+
+void DrumPlayer::renderBlock(float* outputBuffer, size_t numFrames, size_t outputNumChannels, double sampleRate) {
+    // Epoch du bloc lu avant les commandes: les sons qu'elles désignent sont à jour
+    if (mixer_) mixer_->beginBlock();
+    // Appliquer les commandes envoyées par le thread UI, avant tout mixage
+    processCommands();
+
+    // Buffer de mixage préalloué par AudioMixer::init, aligné sur une ligne de cache
+    float* bufData = mixer_ ? mixer_->getMixBuffer() : nullptr;
+    const size_t maxFrames = mixer_ ? mixer_->getMaxFrames() : 0;
+    if (!bufData || maxFrames == 0) {
+        std::fill(outputBuffer, outputBuffer + numFrames * outputNumChannels, 0.0f);
+        return;
+    }
+
+    // Si on demande plus de frames que le buffer préalloué, on mixe par morceaux.
+    const float gain = mixer_->getGlobalVolume() * GLOBAL_GAIN;
+    size_t framesDone = 0;
+    while (framesDone < numFrames) {
+        const size_t chunkFrames = std::min(maxFrames, numFrames - framesDone);
+        const size_t numSamples = chunkFrames * outputNumChannels;
+        std::fill(bufData, bufData + numSamples, 0.0f);
+
+        // Déclenche les pas (ou les coups du morceau) de ce bloc à leur décalage exact, avant le mixage.
+        // À l'arrêt, le métronome suit les pas comme en mode pattern.
+        if (playing_ && isSongPlaying()) {
+            scheduleSong(chunkFrames);
+        } else {
+            scheduleSteps(chunkFrames, sampleRate);
+        }
+
+        // Mixer les sons en utilisant la fonction dédiée
+        mixer_->mixSoundData(bufData, chunkFrames, outputNumChannels);
+
+        // Copie du buffer de mixage vers le buffer de sortie, avec gain global et écrêtage
+        float* chunkOut = outputBuffer + framesDone * outputNumChannels;
+        mixkernels::gainClip(chunkOut, bufData, numSamples, gain);
+        framesDone += chunkFrames;
+    }
+}
+//----------------------------------------
+
+void DrumPlayer::tickStep(size_t frameOffset) {
+    if (playing_) {
+        clickStep_ = getCurrentStep();
+        if (clicking_ && clickStep_ % 4 == 0) {
+            playMetronome(frameOffset);
+        }
+        playPattern(numSteps_, frameOffset);
+    } else if (clicking_) {
+        if (clickStep_ % 4 == 0) {
+            playMetronome(frameOffset);
+        }
+        clickStep_ = (clickStep_ + 1) % numSteps_;
+    }
+}
+//----------------------------------------
+
 
 /*
 // Marche bien avec fusion des enregistrements par mesure
@@ -478,12 +573,8 @@ void DrumPlayer::setBpm(double newBpm) {
 //----------------------------------------
 
 bool DrumPlayer::isSoundPlaying() const {
-    for (const auto& sound : drumSounds_) {
-        if (sound && sound->isActive()) {
-            return true;
-        }
-    }
-    return false;
+    // L'état de lecture est dans les voix du mixer, pas dans les sons
+    return mixer_ && mixer_->getNumActiveVoices() > 0;
 }
 //----------------------------------------
 
@@ -498,7 +589,11 @@ bool DrumPlayer::isSoundMuted(size_t soundIndex) const {
 void DrumPlayer::setSoundMuted(size_t soundIndex, bool muted) {
     if (mixer_ && soundIndex < drumSounds_.size()) {
         int channelToMute = soundIndex+1;
-        mixer_->setChannelMuted(channelToMute, muted); // Utiliser la fonction de AudioMixer
+        AudioCommand cmd;
+        cmd.type = AudioCommandType::SetMute;
+        cmd.channel = channelToMute;
+        cmd.flag = muted;
+        postCommand(cmd);
         isMuted_[soundIndex] = muted; // Garder une trace locale si nécessaire
         std::cout << "Son " << soundIndex<< " (canal " << channelToMute << ") est maintenant " << (muted ? "muté" : "démuté") << "." << std::endl;
     }
@@ -507,7 +602,14 @@ void DrumPlayer::setSoundMuted(size_t soundIndex, bool muted) {
 
 void DrumPlayer::resetMute() {
     if (mixer_) {
-        mixer_->resetMute(); // S'assurer que le mixer est aussi réinitialisé
+        // S'assurer que le mixer est aussi réinitialisé
+        AudioCommand cmd;
+        cmd.type = AudioCommandType::SetMute;
+        cmd.flag = false;
+        for (size_t i = 0; i < mixer_->getNumChannels(); ++i) {
+            cmd.channel = i;
+            postCommand(cmd);
+        }
     }
 
     // Note: best way to modify directly an vector
@@ -547,7 +649,7 @@ void DrumPlayer::recordStep(size_t soundIndex) {
 
         // S'assurer que l'index du son et le pas sont valides
         if (soundIndex < numSounds_ && currentStep < curPattern_->getNumSteps()) {
-            curPattern_->getPatternBar(currentBar)[soundIndex][currentStep] = true;
+            curPattern_->setNote(currentBar, soundIndex, currentStep, true);
             playSound(soundIndex); // Joue le son immédiatement lors de l'enregistrement
         }
     } else {
@@ -569,7 +671,7 @@ bool DrumPlayer::deleteStepAtPos(int soundIndex, size_t currentStep, size_t curr
         currentStep < curPattern_->getNumSteps() &&
         currentBar < curPattern_->getNumBars()) { // Ajout de la vérification de la barre
 
-        curPattern_->getPatternBar(currentBar)[soundIndex][currentStep] = false;
+        curPattern_->clearNote(currentBar, soundIndex, currentStep);
         return true; // Suppression réussie
     } else {
         std::cerr << "Erreur interne: Indices de suppression invalides dans DrumPlayer::deleteStepAtPos." << std::endl;
@@ -591,20 +693,8 @@ bool DrumPlayer::clearSoundFromPattern(int soundIndex) {
         return false;
     }
 
-    // Parcourir toutes les barres et tous les pas pour désactiver le son
-    size_t totalBars = curPattern_->getNumBars(); // Assurez-vous que getNumBars() retourne le nombre total de barres
-    size_t totalSteps = curPattern_->getNumSteps();
-
-    bool changed = false;
-    for (size_t barIdx = 0; barIdx < totalBars; ++barIdx) {
-        for (size_t stepIdx = 0; stepIdx < totalSteps; ++stepIdx) {
-            if (curPattern_->getPatternBar(barIdx)[soundIndex][stepIdx]) {
-                curPattern_->getPatternBar(barIdx)[soundIndex][stepIdx] = false;
-                changed = true;
-            }
-        }
-    }
-    return changed; // Indique si des modifications ont été apportées
+    // Désactive le son dans toutes les barres et tous les pas
+    return curPattern_->clearSound(soundIndex); // Indique si des modifications ont été apportées
 }
 //----------------------------------------
 
@@ -614,33 +704,8 @@ bool DrumPlayer::clearPattern() {
         return false;
     }
 
-    // Récupérer le nombre total de mesures, de sons et de pas par mesure
-    size_t totalBars = curPattern_->getNumBars();
-    size_t totalSounds = numSounds_; // curPattern_->getNumSounds();
-    size_t totalSteps = curPattern_->getNumSteps();
-
-    bool changed = false;
-
-    // Parcourir toutes les mesures
-    for (size_t barIdx = 0; barIdx < totalBars; ++barIdx) {
-        // Obtenir la référence à la barre de pattern actuelle pour éviter de la copier
-        // Assurez-vous que getPatternBar() renvoie une référence ou un moyen modifiable.
-        // Si getPatternBar() renvoie const, vous aurez besoin d'une version non-const ou d'une autre approche.
-        // Supposons que getPatternBar(barIdx) renvoie un std::vector<std::vector<bool>>&
-        auto& currentBar = curPattern_->getPatternBar(barIdx);
-
-        // Parcourir tous les sons dans cette mesure
-        for (size_t soundIdx = 0; soundIdx < totalSounds; ++soundIdx) {
-            // Parcourir tous les pas pour ce son
-            for (size_t stepIdx = 0; stepIdx < totalSteps; ++stepIdx) {
-                // Si le step est actif, le désactiver et marquer qu'un changement a eu lieu
-                if (currentBar[soundIdx][stepIdx]) {
-                    currentBar[soundIdx][stepIdx] = false;
-                    changed = true;
-                }
-            }
-        }
-    }
+    // Désactive tous les pas de toutes les mesures
+    bool changed = curPattern_->clearAll();
 
     // Le pattern a été modifié, donc l'interface utilisateur devra peut-être être rafraîchie.
     // Vous pouvez déclencher un événement ou mettre à jour un flag si nécessaire.
@@ -656,33 +721,43 @@ void DrumPlayer::addPendingRecording(int soundIndex, size_t barIndex, size_t ste
         std::cerr << "Erreur: Tentative d'ajouter un enregistrement en attente invalide." << std::endl;
         return;
     }
-    pendingRecordings_.emplace_back(soundIndex, barIndex, stepIndex);
+    // pendingRecordings_ appartient au thread audio: on lui envoie l'enregistrement
+    AudioCommand cmd;
+    cmd.type = AudioCommandType::RecordStep;
+    cmd.soundIndex = soundIndex;
+    cmd.bar = barIndex;
+    cmd.step = stepIndex;
+    postCommand(cmd);
 }
 //----------------------------------------
 
 bool DrumPlayer::mergePendingRecordings() {
-    if (pendingRecordings_.empty() || !curPattern_) {
+    if (pendingRecordings_.empty() || !audioPattern_) {
         return false;
     }
 
     bool changed = false;
-    // On itère sur une copie pour vider immédiatement pendingRecordings_
-    std::vector<std::tuple<int, size_t, size_t>> recordingsToMerge = pendingRecordings_;
-    pendingRecordings_.clear();
+    // On échange avec un vecteur préalloué pour vider immédiatement pendingRecordings_
+    // Note: appelée depuis le callback audio, un swap n'alloue pas de mémoire, contrairement à une copie.
+    recordingsToMerge_.clear();
+    recordingsToMerge_.swap(pendingRecordings_);
 
-    for (const auto& rec : recordingsToMerge) {
+    for (const auto& rec : recordingsToMerge_) {
         int soundIndex = std::get<0>(rec);
         size_t barIndex = std::get<1>(rec);
         size_t stepIndex = std::get<2>(rec);
 
-        if (barIndex < curPattern_->getNumBars() && stepIndex < curPattern_->getNumSteps() &&
+        if (barIndex < audioPattern_->getNumBars() && stepIndex < audioPattern_->getNumSteps() &&
             soundIndex >= 0 && static_cast<size_t>(soundIndex) < numSounds_)
         {
-            // Utilisation de la référence locale pour la lisibilité
-            auto& targetBar = curPattern_->getPatternBar(barIndex);
-            if (!targetBar[soundIndex][stepIndex]) {
-                targetBar[soundIndex][stepIndex] = true;
-                changed = true;
+            // La copie jouée est immuable: le thread UI ajoute le pas à curPattern_ et republie
+            if (!audioPattern_->getNote(barIndex, soundIndex, stepIndex)) {
+                AudioCommand rec;
+                rec.type = AudioCommandType::RecordStep;
+                rec.soundIndex = soundIndex;
+                rec.bar = barIndex;
+                rec.step = stepIndex;
+                if (recordedQueue_.push(rec)) changed = true;
             }
         }
     }
@@ -1207,6 +1282,481 @@ bool DrumPlayer::quantizeStepsFromSound() {
 }
 //----------------------------------------
 
+bool DrumPlayer::postCommand(const AudioCommand& cmd) {
+    if (!commandQueue_.push(cmd)) {
+        std::cerr << "Erreur: File de commandes audio pleine, commande ignorée." << std::endl;
+        return false;
+    }
+    return true;
+}
+//----------------------------------------
+
+void DrumPlayer::processCommands() {
+    AudioCommand cmd;
+    while (commandQueue_.pop(cmd)) {
+        applyCommand(cmd);
+    }
+    // À l'arrêt, pas de mesure ni de pas à attendre pour changer de kit ou de pattern
+    if (!playing_) {
+        applyPendingKit();
+        applyPendingPattern();
+    }
+    applyPendingSong();
+    // Passage en mode morceau: lecture depuis le début
+    const bool songMode = songMode_.load(std::memory_order_relaxed);
+    if (songMode && !songActive_) seekSong(0);
+    songActive_ = songMode;
+}
+//----------------------------------------
+
+void DrumPlayer::applyPendingSong() {
+    const SongTimeline* song = pendingSong_.exchange(nullptr, std::memory_order_acq_rel);
+    if (!song) return;
+    audioSong_ = song;
+    ackSong_.store(song, std::memory_order_release);
+    // Même position dans le morceau modifié: une modification ne fait pas repartir du début
+    seekSong(songFrame_ < song->numFrames ? songFrame_ : 0);
+}
+//----------------------------------------
+
+void DrumPlayer::seekSong(uint64_t frame) {
+    songFrame_ = frame;
+    songEvent_ = 0;
+    songBar_ = 0;
+    songBeat_ = 0;
+    if (!audioSong_) return;
+    const auto& events = audioSong_->events;
+    songEvent_ = static_cast<size_t>(std::lower_bound(events.begin(), events.end(), frame,
+        [](const SongEvent& event, uint64_t f) { return event.frame < f; }) - events.begin());
+    const auto& bars = audioSong_->bars;
+    songBar_ = static_cast<size_t>(std::lower_bound(bars.begin(), bars.end(), frame,
+        [](const SongBar& bar, uint64_t f) { return bar.frame < f; }) - bars.begin());
+    const auto& beats = audioSong_->beats;
+    songBeat_ = static_cast<size_t>(std::lower_bound(beats.begin(), beats.end(), frame,
+        [](const SongBeat& beat, uint64_t f) { return beat.frame < f; }) - beats.begin());
+}
+//----------------------------------------
+
+void DrumPlayer::scheduleSong(size_t numFrames) {
+    if (!playing_ || !mixer_) return;
+    const SongTimeline& song = *audioSong_;
+    size_t framesDone = 0;
+    while (framesDone < numFrames) {
+        const uint64_t endFrame = std::min<uint64_t>(songFrame_ + (numFrames - framesDone), song.numFrames);
+        // Mesures commencées avant endFrame: position affichée, et nouveau kit pris en début de mesure
+        while (songBar_ < song.bars.size() && song.bars[songBar_].frame < endFrame) {
+            const SongBar& bar = song.bars[songBar_++];
+            currentBar_ = bar.bar;
+            songSection_.store(bar.section, std::memory_order_relaxed);
+            applyPendingKit();
+        }
+        // Un coup lu par coup joué: ni section, ni répétition, ni masque à parcourir
+        while (songEvent_ < song.events.size() && song.events[songEvent_].frame < endFrame) {
+            const SongEvent& event = song.events[songEvent_++];
+            const size_t frameOffset = framesDone + static_cast<size_t>(event.frame - songFrame_);
+            if (event.sound < drumSounds_.size() && drumSounds_[event.sound]) {
+                mixer_->play(event.sound + 1, drumSounds_[event.sound], frameOffset, event.velocity / 127.0f);
+            }
+        }
+        while (songBeat_ < song.beats.size() && song.beats[songBeat_].frame < endFrame) {
+            const SongBeat& beat = song.beats[songBeat_++];
+            const SoundPtr& click = beat.accent ? soundClick1_ : soundClick2_;
+            if (clicking_ && click) {
+                mixer_->play(0, click, framesDone + static_cast<size_t>(beat.frame - songFrame_));
+            }
+        }
+        framesDone += static_cast<size_t>(endFrame - songFrame_);
+        songFrame_ = endFrame;
+        if (songFrame_ >= song.numFrames) seekSong(0); // Fin du morceau: reprise au début
+    }
+}
+//----------------------------------------
+
+void DrumPlayer::applyPendingKit() {
+    std::vector<SoundPtr>* kit = pendingKit_.exchange(nullptr, std::memory_order_acq_rel);
+    if (!kit) return;
+    // Échange des buffers des deux vecteurs: ni allocation ni libération sur le thread audio.
+    // Les anciens sons repartent dans la table du thread UI, qui les retire.
+    drumSounds_.swap(*kit);
+    ackKit_.store(kit, std::memory_order_release);
+}
+//----------------------------------------
+
+void DrumPlayer::applyPendingPattern() {
+    const AdikPattern* pattern = pendingPattern_.exchange(nullptr, std::memory_order_acq_rel);
+    if (!pattern) return;
+    // L'ancienne copie n'est plus lue: le thread UI la libère quand il voit l'acquittement
+    audioPattern_ = pattern;
+    ackPatternNs_.store(AudioSound::getClockNs(), std::memory_order_relaxed);
+    ackPattern_.store(pattern, std::memory_order_release);
+}
+//----------------------------------------
+
+void DrumPlayer::applyCommand(const AudioCommand& cmd) {
+    // Note: appelée par le thread audio uniquement, sans allocation ni verrou.
+    if (!mixer_) return;
+    const bool validSound = cmd.soundIndex >= 0 && static_cast<size_t>(cmd.soundIndex) < drumSounds_.size();
+    switch (cmd.type) {
+        case AudioCommandType::Trigger:
+            if (validSound && drumSounds_[cmd.soundIndex]) {
+                if (cmd.channel != static_cast<size_t>(cmd.soundIndex) + 1) {
+                    // Canal d'écoute (playLastSound): même vitesse que le canal du son
+                    mixer_->setSpeed(cmd.channel, mixer_->getSpeed(cmd.soundIndex + 1));
+                }
+                mixer_->play(cmd.channel, drumSounds_[cmd.soundIndex]);
+            }
+            break;
+        case AudioCommandType::Stop:
+            if (cmd.channel < mixer_->getNumChannels() && mixer_->isChannelActive(cmd.channel)) {
+                mixer_->stop(cmd.channel);
+            }
+            break;
+        case AudioCommandType::StopAll:
+            stopAllChannels();
+            break;
+        case AudioCommandType::SetVolume:
+            mixer_->setVolume(cmd.channel, cmd.value);
+            break;
+        case AudioCommandType::SetGlobalVolume:
+            mixer_->setGlobalVolume(cmd.value);
+            break;
+        case AudioCommandType::SetPan:
+            mixer_->setChannelPan(cmd.channel, cmd.value);
+            break;
+        case AudioCommandType::SetSpeed:
+            mixer_->setSpeed(cmd.channel, cmd.value);
+            break;
+        case AudioCommandType::SetMute:
+            mixer_->setChannelMuted(cmd.channel, cmd.flag);
+            break;
+        case AudioCommandType::SetDelay:
+            mixer_->setDelayActive(cmd.channel, cmd.flag);
+            break;
+        case AudioCommandType::SetPolyphony:
+            mixer_->setChannelPolyphony(cmd.channel, static_cast<size_t>(cmd.value));
+            break;
+        case AudioCommandType::SetInterpolation:
+            mixer_->setInterpolation(static_cast<resampler::Interpolation>(static_cast<int>(cmd.value)));
+            break;
+        case AudioCommandType::SetBar:
+            currentBar_ = cmd.bar; // Ramenée dans le pattern joué par playPattern
+            break;
+        case AudioCommandType::SetSound:
+            // Emplacement vide: la copie n'incrémente qu'un compteur, rien n'est libéré ici
+            if (validSound && cmd.sound && !drumSounds_[cmd.soundIndex]) {
+                drumSounds_[cmd.soundIndex] = *cmd.sound;
+            }
+            break;
+        case AudioCommandType::RecordStep:
+            // La capacité est réservée dans le constructeur: on ignore l'enregistrement plutôt que d'allouer
+            if (pendingRecordings_.size() < pendingRecordings_.capacity()) {
+                pendingRecordings_.emplace_back(cmd.soundIndex, cmd.bar, cmd.step);
+            }
+            break;
+    }
+}
+//----------------------------------------
+
+void DrumPlayer::setSounds(const std::vector<SoundPtr>& sounds) {
+    Reclaimer* reclaimer = mixer_ ? &mixer_->getReclaimer() : nullptr;
+    if (reclaimer) {
+        // Les voix en cours peuvent encore lire les anciens sons
+        for (auto& sound : drumSounds_) {
+            if (!sound || std::find(sounds.begin(), sounds.end(), sound) != sounds.end()) continue;
+            const size_t numBytes = sound->getNumBytes();
+            reclaimer->retire(std::move(sound), numBytes);
+        }
+    }
+    drumSounds_ = sounds;
+    uiSounds_ = sounds;
+    for (auto& sound : drumSounds_) {
+        // Les données modifiées plus tard (enveloppes) passent aussi par le Reclaimer
+        if (sound) sound->setReclaimer(reclaimer);
+    }
+}
+//----------------------------------------
+
+bool DrumPlayer::setSound(size_t soundIndex, const SoundPtr& sound) {
+    if (!sound || soundIndex >= uiSounds_.size() || uiSounds_[soundIndex]) return false;
+    if (mixer_) {
+        sound->setReclaimer(&mixer_->getReclaimer());
+    }
+    // uiSounds_ garde le son en vie: le thread audio n'a qu'une copie à faire
+    uiSounds_[soundIndex] = sound;
+    AudioCommand cmd;
+    cmd.type = AudioCommandType::SetSound;
+    cmd.soundIndex = static_cast<int>(soundIndex);
+    cmd.sound = &uiSounds_[soundIndex];
+    if (!postCommand(cmd)) {
+        uiSounds_[soundIndex] = nullptr;
+        return false;
+    }
+    return true;
+}
+//----------------------------------------
+
+bool DrumPlayer::setKit(std::vector<SoundPtr> sounds) {
+    if (!pollKit()) return false;
+    // Même nombre d'emplacements: les canaux et le pattern restent valides
+    sounds.resize(uiSounds_.size());
+    Reclaimer* reclaimer = mixer_ ? &mixer_->getReclaimer() : nullptr;
+    for (auto& sound : sounds) {
+        if (sound) sound->setReclaimer(reclaimer);
+    }
+    // Pas de commande SetSound en attente (chargement terminé): uiSounds_ peut être réécrit
+    std::copy(sounds.begin(), sounds.end(), uiSounds_.begin());
+    kitTable_ = std::make_unique<std::vector<SoundPtr>>(std::move(sounds));
+    pendingKit_.store(kitTable_.get(), std::memory_order_release);
+    return true;
+}
+//----------------------------------------
+
+bool DrumPlayer::pollKit() {
+    if (!kitTable_) return true;
+    if (ackKit_.load(std::memory_order_acquire) != kitTable_.get()) return false;
+    // La table contient maintenant les anciens sons: les voix en cours peuvent encore les lire
+    Reclaimer* reclaimer = mixer_ ? &mixer_->getReclaimer() : nullptr;
+    for (auto& sound : *kitTable_) {
+        if (!sound || !reclaimer) continue;
+        const size_t numBytes = sound->getNumBytes();
+        reclaimer->retire(std::move(sound), numBytes);
+    }
+    ackKit_.store(nullptr, std::memory_order_relaxed);
+    kitTable_.reset();
+    return true;
+}
+//----------------------------------------
+
+void DrumPlayer::setPattern(std::shared_ptr<AdikPattern> pattern) {
+    if (!pattern) return;
+    curPattern_ = pattern;
+    if (quantizer_) {
+        quantizer_->setPattern(curPattern_);
+    }
+    publishedSource_ = nullptr; // Nouvelle copie de travail: toujours publiée
+    publishPattern();
+}
+//----------------------------------------
+
+bool DrumPlayer::publishPattern() {
+    releasePatterns();
+    if (!curPattern_) return false;
+    if (curPattern_.get() == publishedSource_ && curPattern_->getVersion() == publishedVersion_) return false;
+    // Copie faite ici, sur le thread UI: le thread audio ne voit jamais un pattern en cours de modification
+    auto snapshot = std::make_shared<const AdikPattern>(*curPattern_);
+    publishedSource_ = curPattern_.get();
+    publishedVersion_ = curPattern_->getVersion();
+    publishedPatterns_.push_back({snapshot, AudioSound::getClockNs()});
+    const AdikPattern* replaced = pendingPattern_.exchange(snapshot.get(), std::memory_order_acq_rel);
+    if (replaced) {
+        // Jamais prise par le thread audio: libérée tout de suite
+        publishedPatterns_.erase(std::find_if(publishedPatterns_.begin(), publishedPatterns_.end(),
+            [replaced](const PublishedPattern& published) { return published.pattern.get() == replaced; }));
+    }
+    ++numPublishedPatterns_;
+    return true;
+}
+//----------------------------------------
+
+void DrumPlayer::releasePatterns() {
+    const AdikPattern* ack = ackPattern_.load(std::memory_order_acquire);
+    auto it = std::find_if(publishedPatterns_.begin(), publishedPatterns_.end(),
+        [ack](const PublishedPattern& published) { return published.pattern.get() == ack; });
+    if (it == publishedPatterns_.end()) return;
+    if (ack != lastAckPattern_) {
+        lastAckPattern_ = ack;
+        const uint64_t ackNs = ackPatternNs_.load(std::memory_order_relaxed);
+        lastPublishMs_ = ackNs > it->publishNs ? (ackNs - it->publishNs) / 1e6 : 0.0;
+        maxPublishMs_ = std::max(maxPublishMs_, lastPublishMs_);
+        totalPublishMs_ += lastPublishMs_;
+        ++numAckedPatterns_;
+    }
+    // Le thread audio ne lit plus les copies publiées avant celle-ci
+    publishedPatterns_.erase(publishedPatterns_.begin(), it);
+}
+//----------------------------------------
+
+void DrumPlayer::setSong(std::shared_ptr<const SongTimeline> song) {
+    releaseSongs();
+    if (!song) return;
+    publishedSongs_.push_back(song);
+    const SongTimeline* replaced = pendingSong_.exchange(song.get(), std::memory_order_acq_rel);
+    if (replaced) {
+        // Jamais pris par le thread audio: libéré tout de suite
+        publishedSongs_.erase(std::find_if(publishedSongs_.begin(), publishedSongs_.end(),
+            [replaced](const auto& published) { return published.get() == replaced; }));
+    }
+}
+//----------------------------------------
+
+void DrumPlayer::releaseSongs() {
+    const SongTimeline* ack = ackSong_.load(std::memory_order_acquire);
+    auto it = std::find_if(publishedSongs_.begin(), publishedSongs_.end(),
+        [ack](const auto& published) { return published.get() == ack; });
+    // Le thread audio ne lit plus les morceaux publiés avant celui-ci
+    if (it != publishedSongs_.end()) publishedSongs_.erase(publishedSongs_.begin(), it);
+}
+//----------------------------------------
+
+void DrumPlayer::pollPattern() {
+    // Pas enregistrés pendant la lecture, fusionnés par le thread audio
+    AudioCommand rec;
+    while (recordedQueue_.pop(rec)) {
+        if (curPattern_) curPattern_->setNote(rec.bar, rec.soundIndex, rec.step, true);
+    }
+    // La mesure affichée suit la lecture (en mode morceau, c'est une mesure du pattern de la section)
+    if (playing_ && !songMode_ && curPattern_) curPattern_->setCurrentBar(currentBar_);
+    publishPattern();
+    releaseSongs();
+}
+//----------------------------------------
+
+void DrumPlayer::setPosition(size_t bar, size_t step) {
+    if (!curPattern_) return;
+    curPattern_->setPosition(bar, step);
+    AudioCommand cmd;
+    cmd.type = AudioCommandType::SetBar;
+    cmd.bar = curPattern_->getCurrentBar();
+    postCommand(cmd);
+}
+//----------------------------------------
+
+double DrumPlayer::getAvgPublishMs() const {
+    return numAckedPatterns_ ? totalPublishMs_ / numAckedPatterns_ : 0.0;
+}
+//----------------------------------------
+
+std::string DrumPlayer::getPatternReport() const {
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(2)
+        << "Patterns publiés: " << numPublishedPatterns_ << ", pris en " << getAvgPublishMs()
+        << " ms en moyenne (dernier " << lastPublishMs_ << ", max " << maxPublishMs_ << ")";
+    return oss.str();
+}
+//----------------------------------------
+
+void DrumPlayer::resetPatternStats() {
+    numPublishedPatterns_ = 0;
+    numAckedPatterns_ = 0;
+    lastPublishMs_ = 0.0;
+    maxPublishMs_ = 0.0;
+    totalPublishMs_ = 0.0;
+}
+//----------------------------------------
+
+float DrumPlayer::getChannelVolume(size_t channel) const {
+    return channel < channelParams_.size() ? channelParams_[channel].volume : 0.0f;
+}
+//----------------------------------------
+
+void DrumPlayer::setChannelVolume(size_t channel, float volume) {
+    if (channel < channelParams_.size()) {
+        channelParams_[channel].volume = std::clamp(volume, 0.0f, 1.0f);
+        AudioCommand cmd;
+        cmd.type = AudioCommandType::SetVolume;
+        cmd.channel = channel;
+        cmd.value = channelParams_[channel].volume;
+        postCommand(cmd);
+    } else {
+        std::cerr << "Canal invalide : " << channel << std::endl;
+    }
+}
+//----------------------------------------
+
+float DrumPlayer::getChannelPan(size_t channel) const {
+    return channel < channelParams_.size() ? channelParams_[channel].pan : 0.0f;
+}
+//----------------------------------------
+
+void DrumPlayer::setChannelPan(size_t channel, float pan) {
+    if (channel < channelParams_.size()) {
+        channelParams_[channel].pan = std::clamp(pan, -1.0f, 1.0f);
+        AudioCommand cmd;
+        cmd.type = AudioCommandType::SetPan;
+        cmd.channel = channel;
+        cmd.value = channelParams_[channel].pan;
+        postCommand(cmd);
+    } else {
+        std::cerr << "Index de canal invalide: " << channel << std::endl;
+    }
+}
+//----------------------------------------
+
+float DrumPlayer::getChannelSpeed(size_t channel) const {
+    return channel < channelParams_.size() ? channelParams_[channel].speed : 1.0f;
+}
+//----------------------------------------
+
+void DrumPlayer::setChannelSpeed(size_t channel, float speed) {
+    if (channel < channelParams_.size()) {
+        channelParams_[channel].speed = speed;
+        AudioCommand cmd;
+        cmd.type = AudioCommandType::SetSpeed;
+        cmd.channel = channel;
+        cmd.value = speed;
+        postCommand(cmd);
+    } else {
+        std::cerr << "Erreur : Canal " << channel << " invalide pour régler la vitesse." << std::endl;
+    }
+}
+//----------------------------------------
+
+bool DrumPlayer::isChannelDelayActive(size_t channel) const {
+    return channel < channelParams_.size() ? channelParams_[channel].delay : false;
+}
+//----------------------------------------
+
+void DrumPlayer::setChannelDelay(size_t channel, bool active) {
+    if (channel < channelParams_.size()) {
+        channelParams_[channel].delay = active;
+        AudioCommand cmd;
+        cmd.type = AudioCommandType::SetDelay;
+        cmd.channel = channel;
+        cmd.flag = active;
+        postCommand(cmd);
+    } else {
+        std::cerr << "Erreur : Canal " << channel << " invalide pour régler le délai" << std::endl;
+    }
+}
+//----------------------------------------
+
+size_t DrumPlayer::getChannelPolyphony(size_t channel) const {
+    return channel < channelParams_.size() ? channelParams_[channel].polyphony : 0;
+}
+//----------------------------------------
+
+void DrumPlayer::setChannelPolyphony(size_t channel, size_t maxPolyphony) {
+    if (channel < channelParams_.size()) {
+        channelParams_[channel].polyphony = maxPolyphony;
+        AudioCommand cmd;
+        cmd.type = AudioCommandType::SetPolyphony;
+        cmd.channel = channel;
+        cmd.value = static_cast<float>(maxPolyphony);
+        postCommand(cmd);
+    } else {
+        std::cerr << "Erreur : Canal " << channel << " invalide pour régler la polyphonie." << std::endl;
+    }
+}
+//----------------------------------------
+
+void DrumPlayer::setInterpolation(resampler::Interpolation interp) {
+    interpolation_ = interp;
+    AudioCommand cmd;
+    cmd.type = AudioCommandType::SetInterpolation;
+    cmd.value = static_cast<float>(static_cast<int>(interp));
+    postCommand(cmd);
+}
+//----------------------------------------
+
+void DrumPlayer::setGlobalVolume(float volume) {
+    globalVolume_ = std::clamp(volume, 0.0f, 1.0f);
+    AudioCommand cmd;
+    cmd.type = AudioCommandType::SetGlobalVolume;
+    cmd.value = globalVolume_;
+    postCommand(cmd);
+}
+//----------------------------------------
+
 //==== End of class DrumPlayer ====
 
 } // namespace adikdrum
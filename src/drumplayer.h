@@ -6,12 +6,17 @@
 #include "audiosound.h"
 #include "audiomixer.h" // Assurez-vous que l'inclusion est là
 #include "adikpattern.h"
+#include "song.h"
 #include "quantizer.h"
+#include "audiocommand.h"
+#include "spscqueue.h"
 
 #include <cmath>
 #include <algorithm> // pour std::clamp
 #include <chrono>
 #include <map>
+#include <atomic>
+#include <string>
 
 namespace adikdrum {
 class DrumPlayer {
@@ -22,7 +27,7 @@ public:
 
     size_t currentStep_;
     double secondsPerStep;
-    std::vector<SoundPtr> drumSounds_; // Utilisation de shared_ptr
+    std::vector<SoundPtr> drumSounds_; // Lus par le thread audio (le thread UI lit uiSounds_)
     SoundPtr soundClick1_; // Nouveau membre pour le son aigu du métronome
     SoundPtr soundClick2_; // Nouveau membre pour le son grave du métronome
 
@@ -31,8 +36,7 @@ public:
     size_t numSteps_;
     int sampleRate_;
     std::shared_ptr<AdikPattern> curPattern_; // CHANGEMENT ICI : c'est maintenant un pointeur intelligent
-    std::vector<std::vector<std::vector<bool>>> patternData_;
-    size_t currentBar_;  // Supposons que ces membres existent et sont gérés
+    size_t currentBar_ =0; // Mesure jouée par le thread audio
     size_t numTotalBars_ =0;
 
     // Nouvelle structure pour stocker les enregistrements en attente
@@ -41,13 +45,22 @@ public:
 
     void playSound(size_t soundIndex);
     void stopAllSounds();
-    void playMetronome();
-    void playPattern(size_t mergeIntervalSteps=16);
+    void playMetronome(size_t frameOffset =0);
+    void playPattern(size_t mergeIntervalSteps=16, size_t frameOffset =0);
+    // Déclenche les pas qui tombent dans le bloc de numFrames frames, à leur position exacte dans le bloc.
+    // Appelée par le callback audio avant le mixage du bloc.
+    void scheduleSteps(size_t numFrames, double sampleRate);
+    // Traitement complet d'un bloc audio: commandes, pas du séquenceur, mixage et gain global.
+    // Utilisée par le callback PortAudio et par le rendu hors ligne.
+    void renderBlock(float* outputBuffer, size_t numFrames, size_t outputNumChannels, double sampleRate);
 
     double softClip(double x) { return tanh(x); }
     float hardClip(double x) { return std::clamp(x, -1.0, 1.0); }
 
 
+    // Fréquence du moteur audio, fixée au démarrage (avant le flux audio)
+    int getSampleRate() const { return sampleRate_; }
+    void setSampleRate(int sampleRate) { sampleRate_ = sampleRate; }
     double getBpm() const { return bpm_; }
     void setBpm(double newBpm);
     bool isSoundPlaying() const;
@@ -98,14 +111,75 @@ public:
     bool genStepsFromSound();
     bool quantizeStepsFromSound();
 
+    // Partie Commandes: le thread UI n'écrit jamais directement dans le mixer,
+    // il poste des commandes que le thread audio applique au début de chaque bloc.
+    bool postCommand(const AudioCommand& cmd); // Thread UI
+    void processCommands(); // Thread audio
+    void setSounds(const std::vector<SoundPtr>& sounds); // Avant le démarrage du flux audio
+    // Remplit un emplacement encore vide pendant la lecture (sons chargés en arrière-plan).
+    // Renvoie false si l'emplacement est pris ou si la file de commandes est pleine.
+    bool setSound(size_t soundIndex, const SoundPtr& sound);
+    // Change tous les sons pendant la lecture (changement de kit). La nouvelle table est prise
+    // par le thread audio d'un seul échange de pointeur, au début de la prochaine mesure
+    // (au prochain bloc à l'arrêt). Renvoie false si un changement est déjà en attente.
+    bool setKit(std::vector<SoundPtr> sounds);
+    // Thread UI: une fois le changement pris en compte, retire les anciens sons (Reclaimer).
+    // Renvoie true quand plus aucun changement n'est en cours.
+    bool pollKit();
+    bool isKitPending() const { return kitTable_ != nullptr; }
+    // Pattern en copie sur écriture: curPattern_ est la copie de travail du thread UI, que les éditeurs
+    // (grille, enregistrement, quantificateur) modifient librement. Le thread audio joue une copie
+    // immuable, publiée par un échange de pointeur et prise entre deux pas (au prochain bloc à l'arrêt).
+    void setPattern(std::shared_ptr<AdikPattern> pattern);
+    // Thread UI: publie une copie de curPattern_ s'il a changé depuis la dernière publication.
+    // Une copie pas encore prise par le thread audio est remplacée. Renvoie true si publié.
+    bool publishPattern();
+    // Thread UI: ajoute à curPattern_ les pas enregistrés fusionnés par le thread audio, publie,
+    // et libère les copies que le thread audio ne lit plus
+    void pollPattern();
+    // Position de la copie de travail; la lecture passe à cette mesure au pas suivant
+    void setPosition(size_t bar, size_t step);
+    // Morceau (song.h), compilé par le thread UI et publié comme les patterns: pris au début du bloc
+    // suivant, à la même position. En mode morceau, la lecture avance un curseur dans les coups
+    // compilés au lieu de lire le pattern pas à pas; le métronome et l'enregistrement suivent le pattern.
+    // Thread UI: un morceau vide (numFrames = 0) revient à la lecture du pattern.
+    void setSong(std::shared_ptr<const SongTimeline> song);
+    void setSongMode(bool active) { songMode_ = active; } // Actif: lecture depuis le début du morceau
+    bool isSongMode() const { return songMode_; }
+    size_t getSongSection() const { return songSection_.load(std::memory_order_relaxed); }
+    size_t getNumPublishedPatterns() const { return numPublishedPatterns_; }
+    // De la publication d'une copie à sa prise par le thread audio
+    double getLastPublishMs() const { return lastPublishMs_; }
+    double getMaxPublishMs() const { return maxPublishMs_; }
+    double getAvgPublishMs() const;
+    std::string getPatternReport() const;
+    void resetPatternStats();
+
+    // Paramètres des canaux du mixer, vus du thread UI
+    float getChannelVolume(size_t channel) const;
+    void setChannelVolume(size_t channel, float volume);
+    float getChannelPan(size_t channel) const;
+    void setChannelPan(size_t channel, float pan);
+    float getChannelSpeed(size_t channel) const;
+    void setChannelSpeed(size_t channel, float speed);
+    bool isChannelDelayActive(size_t channel) const;
+    void setChannelDelay(size_t channel, bool active);
+    size_t getChannelPolyphony(size_t channel) const;
+    void setChannelPolyphony(size_t channel, size_t maxPolyphony); // 0 = pas de limite
+    float getGlobalVolume() const { return globalVolume_; }
+    void setGlobalVolume(float volume);
+    resampler::Interpolation getInterpolation() const { return interpolation_; }
+    void setInterpolation(resampler::Interpolation interp);
+
 
 
 
 
 private:
-    bool playing_;
-    bool recording_ = false; // Nouvelle variable pour l'état d'enregistrement
-    bool clicking_;
+    // Note: ces états sont modifiés par le thread UI et lus par le thread audio
+    std::atomic<bool> playing_;
+    std::atomic<bool> recording_ = false; // Nouvelle variable pour l'état d'enregistrement
+    std::atomic<bool> clicking_;
     double bpm_;
     int beatCounter_;
     AudioMixer* mixer_; // Pointeur vers l'AudioMixer
@@ -124,6 +198,80 @@ private:
     size_t quantRecReso_; // 0: Désactivé, 1: Mesure, 2: Demi-Mesure, etc.
     size_t quantPlayReso_; // --- NOUVEAU: Résolution de quantification pour la lecture/édition ---
     std::map<size_t, size_t> quantResolutionMap;
+    // Vecteur de travail pour mergePendingRecordings, échangé avec pendingRecordings_
+    std::vector<std::tuple<int, size_t, size_t>> recordingsToMerge_;
+    static const size_t maxPendingRecordings_ = 256;
+    // Nombre de frames (avec la partie fractionnaire) avant le prochain pas,
+    // reporté d'un bloc à l'autre pour rester calé sur le tempo.
+    double framesToNextStep_ =0.0;
+    void tickStep(size_t frameOffset);
+
+    // Copie des paramètres des canaux, tenue à jour par le thread UI
+    struct ChannelParams {
+        float volume =1.0f;
+        float pan =0.0f;
+        float speed =1.0f;
+        bool delay =false;
+        size_t polyphony =4;
+    };
+    std::vector<ChannelParams> channelParams_;
+    float globalVolume_ =0.8f;
+    resampler::Interpolation interpolation_ = resampler::Interpolation::Linear;
+
+    static const size_t commandQueueSize_ = 512;
+    SpscQueue<AudioCommand, commandQueueSize_> commandQueue_;
+    // Copies publiées que le thread audio peut encore lire, de la plus ancienne à la plus récente
+    struct PublishedPattern {
+        std::shared_ptr<const AdikPattern> pattern;
+        uint64_t publishNs =0; // AudioSound::getClockNs
+    };
+    std::vector<PublishedPattern> publishedPatterns_;
+    const AdikPattern* publishedSource_ = nullptr; // Copie de travail et version de la dernière publication
+    uint64_t publishedVersion_ =0;
+    const AdikPattern* lastAckPattern_ = nullptr;
+    const AdikPattern* audioPattern_ = nullptr; // Pattern lu par le thread audio
+    std::atomic<const AdikPattern*> pendingPattern_{nullptr};
+    std::atomic<const AdikPattern*> ackPattern_{nullptr}; // Dernier pattern pris en compte par le thread audio
+    std::atomic<uint64_t> ackPatternNs_{0};
+    // Pas enregistrés fusionnés par le thread audio, ajoutés à curPattern_ par le thread UI
+    SpscQueue<AudioCommand, commandQueueSize_> recordedQueue_;
+    size_t numPublishedPatterns_ =0;
+    size_t numAckedPatterns_ =0;
+    double lastPublishMs_ =0.0;
+    double maxPublishMs_ =0.0;
+    double totalPublishMs_ =0.0;
+    void applyPendingPattern(); // Thread audio
+    void releasePatterns(); // Thread UI
+    std::vector<std::shared_ptr<const SongTimeline>> publishedSongs_;
+    std::atomic<const SongTimeline*> pendingSong_{nullptr};
+    std::atomic<const SongTimeline*> ackSong_{nullptr};
+    std::atomic<bool> songMode_{false};
+    std::atomic<size_t> songSection_{0}; // Section jouée, pour l'affichage
+    const SongTimeline* audioSong_ = nullptr; // Morceau lu par le thread audio
+    bool songActive_ = false; // Thread audio: mode morceau au bloc précédent
+    uint64_t songFrame_ =0;   // Position dans le morceau
+    size_t songEvent_ =0;     // Prochain coup à jouer
+    size_t songBar_ =0;       // Prochaine mesure
+    size_t songBeat_ =0;      // Prochain temps du métronome
+    void applyPendingSong(); // Thread audio
+    void releaseSongs(); // Thread UI
+    // Thread audio: curseurs placés à frame par recherche dichotomique
+    void seekSong(uint64_t frame);
+    bool isSongPlaying() const { return songMode_ && audioSong_ && audioSong_->numFrames > 0; }
+    // Déclenche les coups du morceau qui tombent dans le bloc, et le métronome s'il est actif.
+    // Reprend au début à la fin du morceau.
+    void scheduleSong(size_t numFrames);
+    // Sons vus par le thread UI, copiés dans drumSounds_ par le thread audio (SetSound).
+    // Taille fixée par setSounds: les adresses restent valides pour les commandes.
+    std::vector<SoundPtr> uiSounds_;
+    // Changement de kit: table préparée par le thread UI, échangée avec drumSounds_ par le thread audio
+    // (sans allocation), puis rendue avec les anciens sons, retirés par le thread UI
+    std::unique_ptr<std::vector<SoundPtr>> kitTable_;
+    std::atomic<std::vector<SoundPtr>*> pendingKit_{nullptr};
+    std::atomic<std::vector<SoundPtr>*> ackKit_{nullptr};
+    void applyPendingKit(); // Thread audio
+    void applyCommand(const AudioCommand& cmd);
+    void stopAllChannels();
 
 
 
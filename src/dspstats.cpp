@@ -0,0 +1,130 @@
+#include "dspstats.h"
+
+#include <sstream>
+#include <iomanip>
+
+namespace adikdrum {
+
+double DspStatsSnapshot::getPercentile(double percent) const {
+    uint64_t total =0;
+    for (auto count : histogram) total += count;
+    if (total == 0) return 0.0;
+    const double target = total * percent / 100.0;
+    uint64_t sum =0;
+    for (size_t i = 0; i < numBins; ++i) {
+        sum += histogram[i];
+        if (sum >= target) {
+            return (i + 1) * DspStats::binWidth; // Borne haute de la case
+        }
+    }
+    return numBins * DspStats::binWidth;
+}
+//----------------------------------------
+
+//==== End of struct DspStatsSnapshot ====
+
+DspStats::DspStats() {
+    for (auto& bin : histogram_) bin.store(0, std::memory_order_relaxed);
+}
+//----------------------------------------
+
+void DspStats::recordCallback(uint64_t elapsedNs, uint64_t bufferNs) {
+    if (bufferNs == 0) return;
+    const uint32_t load = static_cast<uint32_t>(elapsedNs * 10000 / bufferNs);
+    // La dernière case reçoit toutes les charges au-delà de l'histogramme
+    size_t bin = static_cast<size_t>(load / (binWidth * 100));
+    if (bin >= numBins) bin = numBins - 1;
+    histogram_[bin].fetch_add(1, std::memory_order_relaxed);
+
+    numCallbacks_.fetch_add(1, std::memory_order_relaxed);
+    if (elapsedNs > bufferNs) {
+        numLateCallbacks_.fetch_add(1, std::memory_order_relaxed);
+    }
+    totalElapsedNs_.fetch_add(elapsedNs, std::memory_order_relaxed);
+    totalBufferNs_.fetch_add(bufferNs, std::memory_order_relaxed);
+    lastLoad_.store(load, std::memory_order_relaxed);
+    if (load > peakLoad_.load(std::memory_order_relaxed)) {
+        peakLoad_.store(load, std::memory_order_relaxed);
+    }
+}
+//----------------------------------------
+
+void DspStats::recordStatus(bool underflow, bool overflow) {
+    if (underflow) numUnderflows_.fetch_add(1, std::memory_order_relaxed);
+    if (overflow) numOverflows_.fetch_add(1, std::memory_order_relaxed);
+}
+//----------------------------------------
+
+void DspStats::setActiveVoices(size_t numVoices) {
+    const uint32_t voices = static_cast<uint32_t>(numVoices);
+    activeVoices_.store(voices, std::memory_order_relaxed);
+    if (voices > peakVoices_.load(std::memory_order_relaxed)) {
+        peakVoices_.store(voices, std::memory_order_relaxed);
+    }
+}
+//----------------------------------------
+
+DspStatsSnapshot DspStats::getSnapshot() const {
+    DspStatsSnapshot snap;
+    for (size_t i = 0; i < numBins; ++i) {
+        snap.histogram[i] = histogram_[i].load(std::memory_order_relaxed);
+    }
+    snap.numCallbacks = numCallbacks_.load(std::memory_order_relaxed);
+    snap.numLateCallbacks = numLateCallbacks_.load(std::memory_order_relaxed);
+    snap.numUnderflows = numUnderflows_.load(std::memory_order_relaxed);
+    snap.numOverflows = numOverflows_.load(std::memory_order_relaxed);
+    snap.lastLoad = lastLoad_.load(std::memory_order_relaxed) / 100.0;
+    snap.peakLoad = peakLoad_.load(std::memory_order_relaxed) / 100.0;
+    const uint64_t totalBufferNs = totalBufferNs_.load(std::memory_order_relaxed);
+    if (totalBufferNs > 0) {
+        snap.avgLoad = 100.0 * totalElapsedNs_.load(std::memory_order_relaxed) / totalBufferNs;
+    }
+    snap.activeVoices = activeVoices_.load(std::memory_order_relaxed);
+    snap.peakVoices = peakVoices_.load(std::memory_order_relaxed);
+    return snap;
+}
+//----------------------------------------
+
+void DspStats::reset() {
+    // Une mise à jour concurrente du thread audio peut survivre à la remise à zéro:
+    // sans importance pour des statistiques.
+    for (auto& bin : histogram_) bin.store(0, std::memory_order_relaxed);
+    numCallbacks_.store(0, std::memory_order_relaxed);
+    numLateCallbacks_.store(0, std::memory_order_relaxed);
+    numUnderflows_.store(0, std::memory_order_relaxed);
+    numOverflows_.store(0, std::memory_order_relaxed);
+    totalElapsedNs_.store(0, std::memory_order_relaxed);
+    totalBufferNs_.store(0, std::memory_order_relaxed);
+    lastLoad_.store(0, std::memory_order_relaxed);
+    peakLoad_.store(0, std::memory_order_relaxed);
+    peakVoices_.store(0, std::memory_order_relaxed);
+}
+//----------------------------------------
+
+std::string DspStats::getStatusLine() const {
+    const auto snap = getSnapshot();
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(1)
+        << "DSP: " << snap.lastLoad << "% (max " << snap.peakLoad << "%), "
+        << "Xruns: " << snap.getXruns() << ", "
+        << "Voix: " << snap.activeVoices;
+    return oss.str();
+}
+//----------------------------------------
+
+std::string DspStats::getReport() const {
+    const auto snap = getSnapshot();
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(1)
+        << "DSP: moy " << snap.avgLoad << "%, p50 " << snap.getPercentile(50.0)
+        << "%, p99 " << snap.getPercentile(99.0) << "%, max " << snap.peakLoad << "%, "
+        << "Callbacks: " << snap.numCallbacks << " (" << snap.numLateCallbacks << " en retard), "
+        << "Underflows: " << snap.numUnderflows << ", Overflows: " << snap.numOverflows << ", "
+        << "Voix: " << snap.activeVoices << " (max " << snap.peakVoices << ")";
+    return oss.str();
+}
+//----------------------------------------
+
+//==== End of class DspStats ====
+
+} // namespace adikdrum
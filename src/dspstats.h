@@ -0,0 +1,72 @@
+#ifndef DSPSTATS_H
+#define DSPSTATS_H
+
+#include <atomic>
+#include <array>
+#include <string>
+#include <cstddef> // Pour size_t
+#include <cstdint>
+
+namespace adikdrum {
+
+// Copie des statistiques, lue par le thread UI
+struct DspStatsSnapshot {
+    static const size_t numBins = 32;
+    uint64_t numCallbacks =0;
+    uint64_t numLateCallbacks =0;  // Callbacks plus longs que la durée du buffer
+    uint64_t numUnderflows =0;     // paOutputUnderflow signalé par PortAudio
+    uint64_t numOverflows =0;      // paOutputOverflow signalé par PortAudio
+    double lastLoad =0.0;          // Charge du dernier callback, en % de la durée du buffer
+    double avgLoad =0.0;           // Charge moyenne depuis la dernière remise à zéro
+    double peakLoad =0.0;          // Charge maximale
+    size_t activeVoices =0;        // Voix actives à la fin du dernier callback
+    size_t peakVoices =0;
+    std::array<uint64_t, numBins> histogram {};
+
+    uint64_t getXruns() const { return numUnderflows + numOverflows; }
+    // Charge (en %) sous laquelle se trouvent percent % des callbacks, à la largeur d'une case près
+    double getPercentile(double percent) const;
+};
+
+// Statistiques de charge DSP du callback audio.
+// Un seul écrivain (le thread audio), sans verrou ni allocation;
+// les lectures (snapshot) peuvent se faire depuis n'importe quel thread.
+class DspStats {
+public:
+    static const size_t numBins = DspStatsSnapshot::numBins;
+    static constexpr double binWidth = 5.0; // Largeur d'une case de l'histogramme, en % de charge
+
+    DspStats();
+
+    // Thread audio: temps passé dans le callback et durée du buffer, en nanosecondes
+    void recordCallback(uint64_t elapsedNs, uint64_t bufferNs);
+    void recordStatus(bool underflow, bool overflow);
+    void setActiveVoices(size_t numVoices);
+
+    // Thread UI
+    DspStatsSnapshot getSnapshot() const;
+    void reset();
+    // Ligne d'état courte, pour AdikTUI
+    std::string getStatusLine() const;
+    // Rapport détaillé, pour la commande :stats
+    std::string getReport() const;
+
+private:
+    std::array<std::atomic<uint64_t>, numBins> histogram_;
+    std::atomic<uint64_t> numCallbacks_ {0};
+    std::atomic<uint64_t> numLateCallbacks_ {0};
+    std::atomic<uint64_t> numUnderflows_ {0};
+    std::atomic<uint64_t> numOverflows_ {0};
+    std::atomic<uint64_t> totalElapsedNs_ {0};
+    std::atomic<uint64_t> totalBufferNs_ {0};
+    // Charges en dix-millièmes (100% = 10000), pour rester sur des entiers atomiques
+    std::atomic<uint32_t> lastLoad_ {0};
+    std::atomic<uint32_t> peakLoad_ {0};
+    std::atomic<uint32_t> activeVoices_ {0};
+    std::atomic<uint32_t> peakVoices_ {0};
+};
+//==== End of class DspStats ====
+
+} // namespace adikdrum
+
+#endif // DSPSTATS_H
@@ -0,0 +1,38 @@
+#include "memusage.h"
+
+#include <cmath>
+#include <fstream>
+#include <sys/resource.h>
+#include <unistd.h> // Pour sysconf
+
+namespace adikdrum {
+namespace memusage {
+
+size_t getPeakRssKb() {
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+    return static_cast<size_t>(usage.ru_maxrss); // En Ko sous Linux
+}
+//----------------------------------------
+
+size_t getCurrentRssKb() {
+    std::ifstream file("/proc/self/statm");
+    size_t totalPages = 0, residentPages = 0;
+    if (!(file >> totalPages >> residentPages)) return 0;
+    const long pageSize = sysconf(_SC_PAGESIZE);
+    return pageSize > 0 ? residentPages * static_cast<size_t>(pageSize) / 1024 : 0;
+}
+//----------------------------------------
+
+std::string formatSavings(size_t numBytes, size_t floatBytes) {
+    std::string text = std::to_string(numBytes / 1024) + " Ko";
+    if (numBytes < floatBytes) {
+        const long percent = std::lround(100.0 * (floatBytes - numBytes) / floatBytes);
+        text += " au lieu de " + std::to_string(floatBytes / 1024) + " Ko (-" + std::to_string(percent) + "%)";
+    }
+    return text;
+}
+//----------------------------------------
+
+} // namespace memusage
+} // namespace adikdrum
@@ -0,0 +1,24 @@
+#ifndef MEMUSAGE_H
+#define MEMUSAGE_H
+
+#include <cstddef> // Pour size_t
+#include <string>
+
+// Mémoire occupée par le processus, pour mesurer le coût du chargement des sons.
+// Linux: pic via getrusage, mémoire résidente via /proc/self/statm. 0 si indisponible.
+
+namespace adikdrum {
+namespace memusage {
+
+// Pic de mémoire résidente depuis le lancement, en Ko
+size_t getPeakRssKb();
+// Mémoire résidente actuelle, en Ko
+size_t getCurrentRssKb();
+// Taille des données d'un son (ou d'un kit) et ce qu'elle serait en float32:
+// "120 Ko au lieu de 240 Ko (-50%)", ou "240 Ko" sans économie
+std::string formatSavings(size_t numBytes, size_t floatBytes);
+
+} // namespace memusage
+} // namespace adikdrum
+
+#endif // MEMUSAGE_H
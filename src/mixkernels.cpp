@@ -0,0 +1,318 @@
+#include "mixkernels.h"
+
+#include <algorithm>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define ADIK_MIXKERNELS_X86 1
+#include <immintrin.h>
+#endif
+
+namespace adikdrum {
+namespace mixkernels {
+
+namespace {
+
+// Mêmes échelles que libsndfile en lecture: un fichier 16 ou 24 bits relu en float est retrouvé à l'identique
+constexpr float int16Scale = 1.0f / 32768.0f;
+constexpr float int24Scale = 1.0f / 8388608.0f;
+
+} // namespace
+
+namespace scalar {
+
+void panMonoToStereo(float* out, const float* in, size_t numFrames, float gainLeft, float gainRight) {
+    for (size_t i = 0; i < numFrames; ++i) {
+        out[2 * i] += in[i] * gainLeft;
+        out[2 * i + 1] += in[i] * gainRight;
+    }
+}
+//----------------------------------------
+
+void addStereo(float* out, const float* in, size_t numFrames, float gainLeft, float gainRight) {
+    for (size_t i = 0; i < numFrames; ++i) {
+        out[2 * i] += in[2 * i] * gainLeft;
+        out[2 * i + 1] += in[2 * i + 1] * gainRight;
+    }
+}
+//----------------------------------------
+
+void gainClip(float* out, const float* in, size_t numSamples, float gain) {
+    for (size_t i = 0; i < numSamples; ++i) {
+        out[i] = std::clamp(in[i] * gain, -1.0f, 1.0f);
+    }
+}
+//----------------------------------------
+
+void int16ToFloat(float* out, const int16_t* in, size_t numSamples) {
+    for (size_t i = 0; i < numSamples; ++i) {
+        out[i] = static_cast<float>(in[i]) * int16Scale;
+    }
+}
+//----------------------------------------
+
+void int24ToFloat(float* out, const int32_t* in, size_t numSamples) {
+    for (size_t i = 0; i < numSamples; ++i) {
+        out[i] = static_cast<float>(in[i]) * int24Scale;
+    }
+}
+//----------------------------------------
+
+} // namespace scalar
+
+#ifdef ADIK_MIXKERNELS_X86
+
+// Les fins de buffer (moins d'un vecteur) sont traitées par les versions scalaires.
+namespace sse2 {
+
+__attribute__((target("sse2")))
+void panMonoToStereo(float* out, const float* in, size_t numFrames, float gainLeft, float gainRight) {
+    const __m128 gl = _mm_set1_ps(gainLeft);
+    const __m128 gr = _mm_set1_ps(gainRight);
+    size_t i = 0;
+    for (; i + 4 <= numFrames; i += 4) {
+        const __m128 m = _mm_loadu_ps(in + i);
+        const __m128 left = _mm_mul_ps(m, gl);
+        const __m128 right = _mm_mul_ps(m, gr);
+        // Entrelacement: L0 R0 L1 R1 | L2 R2 L3 R3
+        float* o = out + 2 * i;
+        _mm_storeu_ps(o, _mm_add_ps(_mm_loadu_ps(o), _mm_unpacklo_ps(left, right)));
+        _mm_storeu_ps(o + 4, _mm_add_ps(_mm_loadu_ps(o + 4), _mm_unpackhi_ps(left, right)));
+    }
+    scalar::panMonoToStereo(out + 2 * i, in + i, numFrames - i, gainLeft, gainRight);
+}
+//----------------------------------------
+
+__attribute__((target("sse2")))
+void addStereo(float* out, const float* in, size_t numFrames, float gainLeft, float gainRight) {
+    const __m128 g = _mm_setr_ps(gainLeft, gainRight, gainLeft, gainRight);
+    const size_t numSamples = numFrames * 2;
+    size_t i = 0;
+    for (; i + 4 <= numSamples; i += 4) {
+        _mm_storeu_ps(out + i, _mm_add_ps(_mm_loadu_ps(out + i), _mm_mul_ps(_mm_loadu_ps(in + i), g)));
+    }
+    scalar::addStereo(out + i, in + i, (numSamples - i) / 2, gainLeft, gainRight);
+}
+//----------------------------------------
+
+__attribute__((target("sse2")))
+void gainClip(float* out, const float* in, size_t numSamples, float gain) {
+    const __m128 g = _mm_set1_ps(gain);
+    const __m128 lo = _mm_set1_ps(-1.0f);
+    const __m128 hi = _mm_set1_ps(1.0f);
+    size_t i = 0;
+    for (; i + 4 <= numSamples; i += 4) {
+        const __m128 x = _mm_mul_ps(_mm_loadu_ps(in + i), g);
+        _mm_storeu_ps(out + i, _mm_min_ps(_mm_max_ps(x, lo), hi));
+    }
+    scalar::gainClip(out + i, in + i, numSamples - i, gain);
+}
+//----------------------------------------
+
+__attribute__((target("sse2")))
+void int16ToFloat(float* out, const int16_t* in, size_t numSamples) {
+    const __m128 scale = _mm_set1_ps(int16Scale);
+    size_t i = 0;
+    for (; i + 8 <= numSamples; i += 8) {
+        const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        // Extension de signe: chaque int16 dans la moitié haute d'un int32, puis décalage arithmétique
+        const __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(x, x), 16);
+        const __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(x, x), 16);
+        _mm_storeu_ps(out + i, _mm_mul_ps(_mm_cvtepi32_ps(lo), scale));
+        _mm_storeu_ps(out + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), scale));
+    }
+    scalar::int16ToFloat(out + i, in + i, numSamples - i);
+}
+//----------------------------------------
+
+__attribute__((target("sse2")))
+void int24ToFloat(float* out, const int32_t* in, size_t numSamples) {
+    const __m128 scale = _mm_set1_ps(int24Scale);
+    size_t i = 0;
+    for (; i + 4 <= numSamples; i += 4) {
+        const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        _mm_storeu_ps(out + i, _mm_mul_ps(_mm_cvtepi32_ps(x), scale));
+    }
+    scalar::int24ToFloat(out + i, in + i, numSamples - i);
+}
+//----------------------------------------
+
+} // namespace sse2
+
+namespace avx2 {
+
+__attribute__((target("avx2")))
+void panMonoToStereo(float* out, const float* in, size_t numFrames, float gainLeft, float gainRight) {
+    const __m256 gl = _mm256_set1_ps(gainLeft);
+    const __m256 gr = _mm256_set1_ps(gainRight);
+    size_t i = 0;
+    for (; i + 8 <= numFrames; i += 8) {
+        const __m256 m = _mm256_loadu_ps(in + i);
+        const __m256 left = _mm256_mul_ps(m, gl);
+        const __m256 right = _mm256_mul_ps(m, gr);
+        // unpack travaille par moitiés de 128 bits: on recompose l'ordre des frames ensuite
+        const __m256 lo = _mm256_unpacklo_ps(left, right); // L0 R0 L1 R1 | L4 R4 L5 R5
+        const __m256 hi = _mm256_unpackhi_ps(left, right); // L2 R2 L3 R3 | L6 R6 L7 R7
+        float* o = out + 2 * i;
+        _mm256_storeu_ps(o, _mm256_add_ps(_mm256_loadu_ps(o), _mm256_permute2f128_ps(lo, hi, 0x20)));
+        _mm256_storeu_ps(o + 8, _mm256_add_ps(_mm256_loadu_ps(o + 8), _mm256_permute2f128_ps(lo, hi, 0x31)));
+    }
+    sse2::panMonoToStereo(out + 2 * i, in + i, numFrames - i, gainLeft, gainRight);
+}
+//----------------------------------------
+
+__attribute__((target("avx2")))
+void addStereo(float* out, const float* in, size_t numFrames, float gainLeft, float gainRight) {
+    const __m256 g = _mm256_setr_ps(gainLeft, gainRight, gainLeft, gainRight,
+            gainLeft, gainRight, gainLeft, gainRight);
+    const size_t numSamples = numFrames * 2;
+    size_t i = 0;
+    for (; i + 8 <= numSamples; i += 8) {
+        _mm256_storeu_ps(out + i, _mm256_add_ps(_mm256_loadu_ps(out + i), _mm256_mul_ps(_mm256_loadu_ps(in + i), g)));
+    }
+    sse2::addStereo(out + i, in + i, (numSamples - i) / 2, gainLeft, gainRight);
+}
+//----------------------------------------
+
+__attribute__((target("avx2")))
+void gainClip(float* out, const float* in, size_t numSamples, float gain) {
+    const __m256 g = _mm256_set1_ps(gain);
+    const __m256 lo = _mm256_set1_ps(-1.0f);
+    const __m256 hi = _mm256_set1_ps(1.0f);
+    size_t i = 0;
+    for (; i + 8 <= numSamples; i += 8) {
+        const __m256 x = _mm256_mul_ps(_mm256_loadu_ps(in + i), g);
+        _mm256_storeu_ps(out + i, _mm256_min_ps(_mm256_max_ps(x, lo), hi));
+    }
+    sse2::gainClip(out + i, in + i, numSamples - i, gain);
+}
+//----------------------------------------
+
+__attribute__((target("avx2")))
+void int16ToFloat(float* out, const int16_t* in, size_t numSamples) {
+    const __m256 scale = _mm256_set1_ps(int16Scale);
+    size_t i = 0;
+    for (; i + 8 <= numSamples; i += 8) {
+        const __m256i x = _mm256_cvtepi16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i)));
+        _mm256_storeu_ps(out + i, _mm256_mul_ps(_mm256_cvtepi32_ps(x), scale));
+    }
+    sse2::int16ToFloat(out + i, in + i, numSamples - i);
+}
+//----------------------------------------
+
+__attribute__((target("avx2")))
+void int24ToFloat(float* out, const int32_t* in, size_t numSamples) {
+    const __m256 scale = _mm256_set1_ps(int24Scale);
+    size_t i = 0;
+    for (; i + 8 <= numSamples; i += 8) {
+        const __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+        _mm256_storeu_ps(out + i, _mm256_mul_ps(_mm256_cvtepi32_ps(x), scale));
+    }
+    sse2::int24ToFloat(out + i, in + i, numSamples - i);
+}
+//----------------------------------------
+
+} // namespace avx2
+
+#endif // ADIK_MIXKERNELS_X86
+
+namespace {
+
+struct KernelTable {
+    SimdLevel level;
+    void (*panMonoToStereo)(float*, const float*, size_t, float, float);
+    void (*addStereo)(float*, const float*, size_t, float, float);
+    void (*gainClip)(float*, const float*, size_t, float);
+    void (*int16ToFloat)(float*, const int16_t*, size_t);
+    void (*int24ToFloat)(float*, const int32_t*, size_t);
+};
+
+KernelTable makeTable(SimdLevel level) {
+    switch (level) {
+#ifdef ADIK_MIXKERNELS_X86
+        case SimdLevel::AVX2: return {level, avx2::panMonoToStereo, avx2::addStereo, avx2::gainClip,
+            avx2::int16ToFloat, avx2::int24ToFloat};
+        case SimdLevel::SSE2: return {level, sse2::panMonoToStereo, sse2::addStereo, sse2::gainClip,
+            sse2::int16ToFloat, sse2::int24ToFloat};
+#endif
+        default: return {SimdLevel::Scalar, scalar::panMonoToStereo, scalar::addStereo, scalar::gainClip,
+            scalar::int16ToFloat, scalar::int24ToFloat};
+    }
+}
+//----------------------------------------
+
+SimdLevel detectSimdLevel() {
+#ifdef ADIK_MIXKERNELS_X86
+    // Nécessaire avant __builtin_cpu_supports pendant l'initialisation statique
+    __builtin_cpu_init();
+#endif
+    if (isSimdLevelSupported(SimdLevel::AVX2)) return SimdLevel::AVX2;
+    if (isSimdLevelSupported(SimdLevel::SSE2)) return SimdLevel::SSE2;
+    return SimdLevel::Scalar;
+}
+//----------------------------------------
+
+// Choisi à l'initialisation du programme, avant tout callback audio
+KernelTable kernels = makeTable(detectSimdLevel());
+
+} // namespace
+
+void panMonoToStereo(float* out, const float* in, size_t numFrames, float gainLeft, float gainRight) {
+    kernels.panMonoToStereo(out, in, numFrames, gainLeft, gainRight);
+}
+//----------------------------------------
+
+void addStereo(float* out, const float* in, size_t numFrames, float gainLeft, float gainRight) {
+    kernels.addStereo(out, in, numFrames, gainLeft, gainRight);
+}
+//----------------------------------------
+
+void gainClip(float* out, const float* in, size_t numSamples, float gain) {
+    kernels.gainClip(out, in, numSamples, gain);
+}
+//----------------------------------------
+
+void int16ToFloat(float* out, const int16_t* in, size_t numSamples) {
+    kernels.int16ToFloat(out, in, numSamples);
+}
+//----------------------------------------
+
+void int24ToFloat(float* out, const int32_t* in, size_t numSamples) {
+    kernels.int24ToFloat(out, in, numSamples);
+}
+//----------------------------------------
+
+SimdLevel getSimdLevel() {
+    return kernels.level;
+}
+//----------------------------------------
+
+const char* getSimdLevelName(SimdLevel level) {
+    switch (level) {
+        case SimdLevel::AVX2: return "avx2";
+        case SimdLevel::SSE2: return "sse2";
+        default: return "scalar";
+    }
+}
+//----------------------------------------
+
+bool isSimdLevelSupported(SimdLevel level) {
+    switch (level) {
+#ifdef ADIK_MIXKERNELS_X86
+        case SimdLevel::AVX2: return __builtin_cpu_supports("avx2");
+        case SimdLevel::SSE2: return __builtin_cpu_supports("sse2");
+#endif
+        case SimdLevel::Scalar: return true;
+        default: return false;
+    }
+}
+//----------------------------------------
+
+bool setSimdLevel(SimdLevel level) {
+    if (!isSimdLevelSupported(level)) return false;
+    kernels = makeTable(level);
+    return true;
+}
+//----------------------------------------
+
+} // namespace mixkernels
+} // namespace adikdrum
@@ -0,0 +1,44 @@
+#ifndef MIXKERNELS_H
+#define MIXKERNELS_H
+
+#include <cstddef> // Pour size_t
+#include <cstdint>
+
+namespace adikdrum {
+namespace mixkernels {
+
+// Noyaux de mixage vectorisés, choisis une seule fois selon le CPU (SSE2, AVX2),
+// avec une version scalaire de référence. Les sorties sont en stéréo entrelacé.
+// Aucun alignement n'est exigé sur les buffers.
+enum class SimdLevel { Scalar, SSE2, AVX2 };
+
+// out[2*i] += in[i] * gainLeft, out[2*i+1] += in[i] * gainRight
+void panMonoToStereo(float* out, const float* in, size_t numFrames, float gainLeft, float gainRight);
+// out[2*i] += in[2*i] * gainLeft, out[2*i+1] += in[2*i+1] * gainRight
+void addStereo(float* out, const float* in, size_t numFrames, float gainLeft, float gainRight);
+// out[i] = clamp(in[i] * gain, -1, 1); out peut être égal à in
+void gainClip(float* out, const float* in, size_t numSamples, float gain);
+// Conversion des sons stockés en entiers: out[i] = in[i] / 32768 (int16), ou / 8388608 (24 bits dans un int32)
+void int16ToFloat(float* out, const int16_t* in, size_t numSamples);
+void int24ToFloat(float* out, const int32_t* in, size_t numSamples);
+
+SimdLevel getSimdLevel();
+const char* getSimdLevelName(SimdLevel level);
+bool isSimdLevelSupported(SimdLevel level);
+// Force un niveau (benchmarks, vérification). Renvoie false si le CPU ne le supporte pas.
+// A appeler avant le démarrage du flux audio.
+bool setSimdLevel(SimdLevel level);
+
+// Versions scalaires, référence pour la vérification des versions vectorisées
+namespace scalar {
+void panMonoToStereo(float* out, const float* in, size_t numFrames, float gainLeft, float gainRight);
+void addStereo(float* out, const float* in, size_t numFrames, float gainLeft, float gainRight);
+void gainClip(float* out, const float* in, size_t numSamples, float gain);
+void int16ToFloat(float* out, const int16_t* in, size_t numSamples);
+void int24ToFloat(float* out, const int32_t* in, size_t numSamples);
+} // namespace scalar
+
+} // namespace mixkernels
+} // namespace adikdrum
+
+#endif // MIXKERNELS_H
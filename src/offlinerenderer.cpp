@@ -0,0 +1,88 @@
+#include "offlinerenderer.h"
+#include "audiofile.h"
+
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <cmath>
+
+namespace adikdrum {
+
+OfflineRenderer::OfflineRenderer(DrumPlayer& player, AudioMixer& mixer)
+    : player_(player), mixer_(mixer) {
+}
+//----------------------------------------
+
+bool OfflineRenderer::render(const std::string& filePath, size_t numBars, double bpm, int sampleRate, size_t blockSize) {
+    stats_ = RenderStats();
+    if (numBars == 0 || blockSize == 0 || sampleRate <= 0) {
+        std::cerr << "Erreur: Paramètres de rendu invalides." << std::endl;
+        return false;
+    }
+    auto& pattern = player_.curPattern_;
+    if (!pattern) {
+        std::cerr << "Erreur: Aucun pattern chargé pour le rendu." << std::endl;
+        return false;
+    }
+
+    if (!mixer_.init(sampleRate, outputNumChannels_, 16, blockSize)) {
+        return false;
+    }
+    player_.setMixer(mixer_);
+    player_.setSampleRate(sampleRate);
+    player_.setBpm(bpm);
+    if (player_.getBpm() != bpm) {
+        std::cerr << "Erreur: BPM invalide pour le rendu: " << bpm << std::endl;
+        return false;
+    }
+
+    // Nombre total de pas: les mesures du pattern sont jouées en boucle
+    size_t totalSteps = 0;
+    for (size_t bar = 0; bar < numBars; ++bar) {
+        totalSteps += pattern->getBarLength(bar % pattern->getNumBars());
+    }
+    const double framesPerStep = sampleRate * player_.secondsPerStep;
+    const size_t totalFrames = static_cast<size_t>(std::llround(totalSteps * framesPerStep));
+
+    AudioFileWriter writer;
+    if (!writer.open(filePath, outputNumChannels_, sampleRate)) {
+        return false;
+    }
+
+    // Repartir du début: la remise à zéro et le pattern publié sont pris par le premier bloc rendu
+    player_.setPosition(0, 0);
+    player_.publishPattern();
+    player_.stopAllSounds();
+    player_.startPlay();
+
+    std::vector<float> block(blockSize * outputNumChannels_, 0.0f);
+    auto startTime = std::chrono::steady_clock::now();
+    size_t framesDone = 0;
+    while (framesDone < totalFrames) {
+        const size_t numFrames = std::min(blockSize, totalFrames - framesDone);
+        if (!mixer_.getDiskStreamer().isRunning()) {
+            // Sans thread d'E/S: les flux sont remplis avant chaque bloc, sans manque possible
+            mixer_.getDiskStreamer().service();
+        }
+        player_.renderBlock(block.data(), numFrames, outputNumChannels_, sampleRate);
+        if (writer.write(block.data(), numFrames) != numFrames) {
+            player_.stopPlay();
+            return false;
+        }
+        framesDone += numFrames;
+    }
+    auto endTime = std::chrono::steady_clock::now();
+    player_.stopPlay();
+    writer.close();
+
+    stats_.numFrames = framesDone;
+    stats_.audioSeconds = static_cast<double>(framesDone) / sampleRate;
+    stats_.elapsedSeconds = std::chrono::duration<double>(endTime - startTime).count();
+    stats_.realTimeFactor = stats_.elapsedSeconds > 0.0 ? stats_.audioSeconds / stats_.elapsedSeconds : 0.0;
+    return true;
+}
+//----------------------------------------
+
+//==== End of class OfflineRenderer ====
+
+} // namespace adikdrum
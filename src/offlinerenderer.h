@@ -0,0 +1,41 @@
+#ifndef OFFLINERENDERER_H
+#define OFFLINERENDERER_H
+
+#include "drumplayer.h"
+#include "audiomixer.h"
+
+#include <string>
+#include <cstddef> // Pour size_t
+
+namespace adikdrum {
+
+// Statistiques du dernier rendu
+struct RenderStats {
+    size_t numFrames =0;       // Nombre de frames rendues
+    double audioSeconds =0.0;  // Durée du rendu en secondes audio
+    double elapsedSeconds =0.0; // Temps réel passé à rendre
+    double realTimeFactor =0.0; // Vitesse du rendu, en multiple du temps réel
+};
+
+// Rendu hors ligne, sans carte son: la même chaîne que le callback audio
+// (DrumPlayer::renderBlock), exécutée en boucle aussi vite que possible,
+// et écrite dans un fichier WAV par libsndfile.
+class OfflineRenderer {
+public:
+    OfflineRenderer(DrumPlayer& player, AudioMixer& mixer);
+
+    // Rend numBars mesures du pattern courant, à partir de la première mesure.
+    bool render(const std::string& filePath, size_t numBars, double bpm, int sampleRate, size_t blockSize);
+    const RenderStats& getStats() const { return stats_; }
+
+private:
+    DrumPlayer& player_;
+    AudioMixer& mixer_;
+    RenderStats stats_;
+    static const size_t outputNumChannels_ = 2;
+};
+//==== End of class OfflineRenderer ====
+
+} // namespace adikdrum
+
+#endif // OFFLINERENDERER_H
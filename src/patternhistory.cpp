@@ -0,0 +1,105 @@
+#include "patternhistory.h"
+
+#include <algorithm> // Pour std::max
+#include <sstream>
+
+namespace adikdrum {
+
+void PatternHistory::reset(const AdikPattern& pattern) {
+    pattern_ = &pattern;
+    version_ = pattern.getVersion();
+    bars_ = pattern.getBars();
+    undoEntries_.clear();
+    redoEntries_.clear();
+}
+//----------------------------------------
+
+bool PatternHistory::commit(const AdikPattern& pattern) {
+    if (&pattern != pattern_) {
+        reset(pattern);
+        return false;
+    }
+    if (pattern.getVersion() == version_) return false;
+    version_ = pattern.getVersion();
+
+    const auto& bars = pattern.getBars();
+    Entry entry;
+    entry.numBarsBefore = bars_.size();
+    entry.numBarsAfter = bars.size();
+    // Une barre non modifiée est le même pointeur: seules les barres changées sont comparées
+    for (size_t i = 0; i < std::max(bars_.size(), bars.size()); ++i) {
+        AdikPattern::BarPtr before = i < bars_.size() ? bars_[i] : nullptr;
+        AdikPattern::BarPtr after = i < bars.size() ? bars[i] : nullptr;
+        if (before == after || (before && after && *before == *after)) continue;
+        entry.changes.push_back({i, std::move(before), std::move(after)});
+    }
+    bars_ = bars;
+    if (entry.changes.empty() && entry.numBarsBefore == entry.numBarsAfter) return false;
+
+    undoEntries_.push_back(std::move(entry));
+    redoEntries_.clear();
+    return true;
+}
+//----------------------------------------
+
+bool PatternHistory::undo(AdikPattern& pattern) {
+    commit(pattern); // Modifications pas encore retenues: annulées en premier
+    if (&pattern != pattern_ || undoEntries_.empty()) return false;
+    apply(pattern, undoEntries_.back(), false);
+    redoEntries_.push_back(std::move(undoEntries_.back()));
+    undoEntries_.pop_back();
+    return true;
+}
+//----------------------------------------
+
+bool PatternHistory::redo(AdikPattern& pattern) {
+    commit(pattern); // Une modification après une annulation a vidé les rétablissements
+    if (&pattern != pattern_ || redoEntries_.empty()) return false;
+    apply(pattern, redoEntries_.back(), true);
+    undoEntries_.push_back(std::move(redoEntries_.back()));
+    redoEntries_.pop_back();
+    return true;
+}
+//----------------------------------------
+
+void PatternHistory::apply(AdikPattern& pattern, const Entry& entry, bool forward) {
+    // Copie des pointeurs seulement: les barres non concernées restent partagées
+    std::vector<AdikPattern::BarPtr> bars = pattern.getBars();
+    bars.resize(std::max(entry.numBarsBefore, entry.numBarsAfter));
+    for (const Change& change : entry.changes) {
+        bars[change.barIndex] = forward ? change.after : change.before;
+    }
+    bars.resize(forward ? entry.numBarsAfter : entry.numBarsBefore);
+    pattern.setBars(std::move(bars));
+    bars_ = pattern.getBars();
+    version_ = pattern.getVersion();
+}
+//----------------------------------------
+
+size_t PatternHistory::getNumBytes() const {
+    size_t numBytes = 0;
+    for (const Entry& entry : undoEntries_) {
+        for (const Change& change : entry.changes) {
+            if (change.before) numBytes += change.before->size() * sizeof(AdikPattern::Mask);
+        }
+    }
+    for (const Entry& entry : redoEntries_) {
+        for (const Change& change : entry.changes) {
+            if (change.after) numBytes += change.after->size() * sizeof(AdikPattern::Mask);
+        }
+    }
+    return numBytes;
+}
+//----------------------------------------
+
+std::string PatternHistory::getReport() const {
+    std::ostringstream oss;
+    oss << "Historique: " << getNumUndo() << " à annuler, " << getNumRedo() << " à rétablir, "
+        << getNumBytes() << " octets";
+    return oss.str();
+}
+//----------------------------------------
+
+//==== End of class PatternHistory ====
+
+} // namespace adikdrum
@@ -0,0 +1,60 @@
+#ifndef PATTERNHISTORY_H
+#define PATTERNHISTORY_H
+
+#include "adikpattern.h"
+
+#include <string>
+#include <vector>
+#include <cstddef> // Pour size_t
+#include <cstdint>
+
+namespace adikdrum {
+
+// Historique d'annulation illimité des modifications d'un pattern (thread UI).
+// Chaque entrée ne garde que les barres changées, avant et après la modification: les autres
+// barres restent partagées avec le pattern (voir BasicPattern::editBar). La mémoire d'une entrée
+// est donc celle des barres modifiées, quelle que soit la taille du pattern.
+class PatternHistory {
+public:
+    // Nouveau point de départ: oublie l'historique
+    void reset(const AdikPattern& pattern);
+    // Après une ou plusieurs modifications de pattern: ajoute une entrée avec les barres changées
+    // depuis le dernier état retenu, et oublie les rétablissements. Renvoie false si rien n'a changé.
+    // Un autre pattern que celui retenu remet l'historique à zéro.
+    bool commit(const AdikPattern& pattern);
+    // Renvoient false s'il n'y a rien à annuler ou à rétablir
+    bool undo(AdikPattern& pattern);
+    bool redo(AdikPattern& pattern);
+
+    size_t getNumUndo() const { return undoEntries_.size(); }
+    size_t getNumRedo() const { return redoEntries_.size(); }
+    // Octets des versions de barres que seul l'historique garde (avant pour annuler, après pour rétablir)
+    size_t getNumBytes() const;
+    std::string getReport() const;
+
+private:
+    struct Change {
+        size_t barIndex = 0;
+        AdikPattern::BarPtr before; // nullptr: barre ajoutée par la modification
+        AdikPattern::BarPtr after;  // nullptr: barre supprimée
+    };
+    struct Entry {
+        std::vector<Change> changes;
+        size_t numBarsBefore = 0;
+        size_t numBarsAfter = 0;
+    };
+
+    const AdikPattern* pattern_ = nullptr; // Pattern suivi, pour reconnaître un changement de pattern
+    uint64_t version_ = 0;
+    std::vector<AdikPattern::BarPtr> bars_; // Dernier état retenu, partagé avec le pattern
+    std::vector<Entry> undoEntries_;
+    std::vector<Entry> redoEntries_;
+
+    // Applique entry dans un sens ou dans l'autre
+    void apply(AdikPattern& pattern, const Entry& entry, bool forward);
+};
+//==== End of class PatternHistory ====
+
+} // namespace adikdrum
+
+#endif // PATTERNHISTORY_H
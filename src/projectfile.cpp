@@ -0,0 +1,436 @@
+#include "projectfile.h"
+
+#include <algorithm> // Pour std::min
+#include <bit>      // Pour std::countl_zero
+#include <cstring>  // Pour std::memcmp, std::memcpy
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <unordered_map>
+
+namespace adikdrum {
+namespace projectfile {
+
+namespace {
+
+const char projectMagic[4] = {'A', 'D', 'K', 'P'};
+constexpr uint64_t projectVersion = 1;
+// Garde-fou contre un fichier corrompu
+constexpr uint64_t maxBarLength = 1024;
+
+enum SectionTag : uint8_t {
+    TagInfo = 1,     // Kit, fichiers des sons, BPM, volume global
+    TagChannels = 2, // Paramètres des sons
+    TagPattern = 3,  // Une section par pattern, dans l'ordre
+    TagSong = 4,     // Sections du morceau
+};
+// Garde-fou contre un fichier corrompu
+constexpr uint64_t maxSongRepeats = 100000;
+
+using Mask = AdikPattern::Mask;
+using Bar = AdikPattern::Bar;
+constexpr size_t maskBytes = sizeof(Mask::words);
+
+class Writer {
+public:
+    void putByte(uint8_t value) { data_.push_back(value); }
+    void putVarint(uint64_t value) {
+        while (value >= 0x80) {
+            putByte(static_cast<uint8_t>(value) | 0x80);
+            value >>= 7;
+        }
+        putByte(static_cast<uint8_t>(value));
+    }
+    // float, double: octets de la machine (little-endian, comme SampleBank)
+    template <typename T>
+    void putRaw(T value) {
+        const auto* bytes = reinterpret_cast<const uint8_t*>(&value);
+        data_.insert(data_.end(), bytes, bytes + sizeof(T));
+    }
+    void putBytes(const void* bytes, size_t numBytes) {
+        const auto* first = static_cast<const uint8_t*>(bytes);
+        data_.insert(data_.end(), first, first + numBytes);
+    }
+    void putString(const std::string& str) {
+        putVarint(str.size());
+        putBytes(str.data(), str.size());
+    }
+    void putSection(uint8_t tag, const Writer& section) {
+        putByte(tag);
+        putVarint(section.data_.size());
+        putBytes(section.data_.data(), section.data_.size());
+    }
+    const std::vector<uint8_t>& getData() const { return data_; }
+
+private:
+    std::vector<uint8_t> data_;
+};
+//==== End of class Writer ====
+
+// Lecture bornée: après une erreur, ok() est faux et les lectures renvoient 0
+class Reader {
+public:
+    Reader(const uint8_t* data, size_t numBytes) : pos_(data), end_(data + numBytes) {}
+
+    bool ok() const { return ok_; }
+    bool atEnd() const { return pos_ == end_; }
+    size_t getRemaining() const { return static_cast<size_t>(end_ - pos_); }
+
+    uint8_t getByte() {
+        if (!ok_ || pos_ == end_) {
+            fail();
+            return 0;
+        }
+        return *pos_++;
+    }
+    uint64_t getVarint() {
+        uint64_t value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            const uint8_t byte = getByte();
+            value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+            if (!(byte & 0x80)) return value;
+        }
+        fail(); // Plus de 64 bits
+        return 0;
+    }
+    template <typename T>
+    T getRaw() {
+        T value{};
+        if (const uint8_t* bytes = getBytes(sizeof(T))) std::memcpy(&value, bytes, sizeof(T));
+        return value;
+    }
+    // Pointe dans les données lues; nullptr si elles sont trop courtes
+    const uint8_t* getBytes(size_t numBytes) {
+        if (!ok_ || numBytes > getRemaining()) {
+            fail();
+            return nullptr;
+        }
+        const uint8_t* bytes = pos_;
+        pos_ += numBytes;
+        return bytes;
+    }
+    std::string getString() {
+        const uint64_t size = getVarint();
+        const uint8_t* bytes = getBytes(size);
+        return bytes ? std::string(reinterpret_cast<const char*>(bytes), size) : std::string();
+    }
+
+private:
+    const uint8_t* pos_;
+    const uint8_t* end_;
+    bool ok_ = true;
+
+    void fail() { ok_ = false; pos_ = end_; }
+};
+//==== End of class Reader ====
+
+// Nombre d'octets de masque utiles: jusqu'au dernier son actif du pattern
+size_t getUsedMaskBytes(const std::vector<AdikPattern::BarPtr>& bars) {
+    Mask used;
+    for (const auto& bar : bars) {
+        for (const Mask& mask : *bar) {
+            for (size_t w = 0; w < Mask::numWords; ++w) used.words[w] |= mask.words[w];
+        }
+    }
+    for (size_t w = Mask::numWords; w-- > 0;) {
+        if (used.words[w]) {
+            const size_t lastTrack = w * 64 + 63 - static_cast<size_t>(std::countl_zero(used.words[w]));
+            return lastTrack / 8 + 1;
+        }
+    }
+    return 0;
+}
+//----------------------------------------
+
+void writePattern(Writer& writer, const std::vector<AdikPattern::BarPtr>& bars) {
+    const size_t stepBytes = getUsedMaskBytes(bars);
+    // Barres distinctes, par contenu: les barres partagées ou recopiées ne sont écrites qu'une fois
+    std::unordered_map<std::string, size_t> barIndexes;
+    std::vector<size_t> indexes;
+    Writer table;
+    indexes.reserve(bars.size());
+    for (const auto& bar : bars) {
+        // Clé: longueur puis pas, pour distinguer les barres vides de longueurs différentes (stepBytes nul)
+        const size_t length = bar->size();
+        std::string key(sizeof(length) + length * stepBytes, '\0');
+        std::memcpy(&key[0], &length, sizeof(length));
+        for (size_t step = 0; step < length; ++step) {
+            std::memcpy(&key[sizeof(length) + step * stepBytes], (*bar)[step].words, stepBytes);
+        }
+        auto [it, inserted] = barIndexes.try_emplace(std::move(key), barIndexes.size());
+        if (inserted) {
+            table.putVarint(length);
+            table.putBytes(it->first.data() + sizeof(length), it->first.size() - sizeof(length));
+        }
+        indexes.push_back(it->second);
+    }
+
+    writer.putVarint(stepBytes);
+    writer.putVarint(barIndexes.size());
+    writer.putBytes(table.getData().data(), table.getData().size());
+    writer.putVarint(indexes.size());
+    for (size_t index : indexes) writer.putVarint(index);
+}
+//----------------------------------------
+
+bool readPattern(Reader& reader, std::vector<AdikPattern::BarPtr>& bars) {
+    const uint64_t stepBytes = reader.getVarint();
+    const uint64_t numUniqueBars = reader.getVarint();
+    // Chaque barre prend au moins un octet: borne les allocations d'un fichier corrompu
+    if (!reader.ok() || stepBytes > reader.getRemaining() || numUniqueBars > reader.getRemaining()) return false;
+    const size_t copyBytes = std::min<size_t>(stepBytes, maskBytes);
+    size_t numDropped = 0;
+
+    std::vector<std::shared_ptr<const Bar>> uniqueBars;
+    uniqueBars.reserve(numUniqueBars);
+    for (uint64_t i = 0; i < numUniqueBars; ++i) {
+        const uint64_t length = reader.getVarint();
+        if (length == 0 || length > maxBarLength) return false;
+        const uint8_t* bytes = reader.getBytes(length * stepBytes);
+        if (!bytes) return false;
+        auto bar = std::make_shared<Bar>(length);
+        for (size_t step = 0; step < length; ++step) {
+            const uint8_t* stepData = bytes + step * stepBytes;
+            std::memcpy((*bar)[step].words, stepData, copyBytes);
+            for (size_t b = copyBytes; b < stepBytes; ++b) {
+                if (stepData[b]) ++numDropped; // Sons au-delà de ADIK_PATTERN_TRACKS
+            }
+        }
+        uniqueBars.push_back(std::move(bar));
+    }
+
+    const uint64_t numBars = reader.getVarint();
+    if (!reader.ok() || numBars == 0 || numBars > reader.getRemaining()) return false;
+    bars.clear();
+    bars.reserve(numBars);
+    for (uint64_t i = 0; i < numBars; ++i) {
+        const uint64_t index = reader.getVarint();
+        if (index >= uniqueBars.size()) return false;
+        bars.push_back(uniqueBars[index]);
+    }
+    if (numDropped) {
+        std::cerr << "Attention: Sons au-delà de " << AdikPattern::maxTracks
+            << " pistes ignorés dans " << numDropped << " octets de pas (make PATTERN_TRACKS)" << std::endl;
+    }
+    return reader.ok();
+}
+//----------------------------------------
+
+bool readSections(Reader& reader, ProjectData& project) {
+    while (!reader.atEnd()) {
+        const uint8_t tag = reader.getByte();
+        const uint64_t size = reader.getVarint();
+        const uint8_t* bytes = reader.getBytes(size);
+        if (!bytes) return false;
+        Reader section(bytes, size);
+        switch (tag) {
+            case TagInfo: {
+                project.kitName = section.getString();
+                const uint64_t numFiles = section.getVarint();
+                if (numFiles > section.getRemaining()) return false;
+                project.kitFiles.clear();
+                for (uint64_t i = 0; i < numFiles; ++i) project.kitFiles.push_back(section.getString());
+                project.bpm = section.getRaw<double>();
+                project.globalVolume = section.getRaw<float>();
+                break;
+            }
+            case TagChannels: {
+                const uint64_t numChannels = section.getVarint();
+                if (numChannels > section.getRemaining()) return false;
+                project.channels.assign(numChannels, ProjectData::Channel());
+                for (auto& channel : project.channels) {
+                    channel.volume = section.getRaw<float>();
+                    channel.pan = section.getRaw<float>();
+                    channel.speed = section.getRaw<float>();
+                    const uint8_t flags = section.getByte();
+                    channel.delay = flags & 1;
+                    channel.muted = flags & 2;
+                }
+                break;
+            }
+            case TagPattern: {
+                project.patterns.emplace_back();
+                if (!readPattern(section, project.patterns.back())) return false;
+                break;
+            }
+            case TagSong: {
+                const uint64_t numSections = section.getVarint();
+                if (numSections > section.getRemaining()) return false;
+                project.songSections.assign(numSections, SongSection());
+                for (auto& songSection : project.songSections) {
+                    songSection.pattern = section.getVarint();
+                    songSection.repeats = section.getVarint();
+                    songSection.bpm = section.getRaw<double>();
+                    songSection.velocity = section.getByte();
+                    const uint64_t mutedBytes = section.getVarint();
+                    const uint8_t* muted = section.getBytes(mutedBytes);
+                    if (!muted || songSection.repeats == 0 || songSection.repeats > maxSongRepeats
+                            || !isValidSongBpm(songSection.bpm)) return false;
+                    std::memcpy(songSection.muted.words, muted, std::min<size_t>(mutedBytes, maskBytes));
+                }
+                break;
+            }
+            default:
+                break; // Section d'une version plus récente: sautée
+        }
+        if (!section.ok()) return false;
+    }
+    return reader.ok();
+}
+//----------------------------------------
+
+} // namespace
+
+bool write(const std::string& filePath, const ProjectData& project) {
+    Writer writer;
+    writer.putBytes(projectMagic, sizeof(projectMagic));
+    writer.putVarint(projectVersion);
+
+    Writer info;
+    info.putString(project.kitName);
+    info.putVarint(project.kitFiles.size());
+    for (const auto& file : project.kitFiles) info.putString(file);
+    info.putRaw<double>(project.bpm);
+    info.putRaw<float>(project.globalVolume);
+    writer.putSection(TagInfo, info);
+
+    Writer channels;
+    channels.putVarint(project.channels.size());
+    for (const auto& channel : project.channels) {
+        channels.putRaw<float>(channel.volume);
+        channels.putRaw<float>(channel.pan);
+        channels.putRaw<float>(channel.speed);
+        channels.putByte(static_cast<uint8_t>((channel.delay ? 1 : 0) | (channel.muted ? 2 : 0)));
+    }
+    writer.putSection(TagChannels, channels);
+
+    for (const auto& bars : project.patterns) {
+        Writer pattern;
+        writePattern(pattern, bars);
+        writer.putSection(TagPattern, pattern);
+    }
+
+    if (!project.songSections.empty()) {
+        Writer song;
+        song.putVarint(project.songSections.size());
+        for (const auto& section : project.songSections) {
+            song.putVarint(section.pattern);
+            song.putVarint(section.repeats);
+            song.putRaw<double>(section.bpm);
+            song.putByte(section.velocity);
+            song.putVarint(maskBytes);
+            song.putBytes(section.muted.words, maskBytes);
+        }
+        writer.putSection(TagSong, song);
+    }
+
+    std::ofstream file(filePath, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        std::cerr << "Erreur: Impossible de créer le fichier de projet: " << filePath << std::endl;
+        return false;
+    }
+    const auto& data = writer.getData();
+    file.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+    if (!file) {
+        std::cerr << "Erreur: Écriture du fichier de projet impossible: " << filePath << std::endl;
+        return false;
+    }
+    return true;
+}
+//----------------------------------------
+
+bool read(const std::string& filePath, ProjectData& project) {
+    std::ifstream file(filePath, std::ios::binary | std::ios::ate);
+    if (!file) {
+        std::cerr << "Erreur: Impossible d'ouvrir le fichier de projet: " << filePath << std::endl;
+        return false;
+    }
+    // Lu d'un bloc: le décodage se fait ensuite en mémoire
+    std::vector<uint8_t> data(static_cast<size_t>(file.tellg()));
+    file.seekg(0);
+    if (!file.read(reinterpret_cast<char*>(data.data()), static_cast<std::streamsize>(data.size()))) {
+        std::cerr << "Erreur: Lecture du fichier de projet impossible: " << filePath << std::endl;
+        return false;
+    }
+
+    Reader reader(data.data(), data.size());
+    const uint8_t* magic = reader.getBytes(sizeof(projectMagic));
+    const uint64_t version = reader.getVarint();
+    if (!magic || std::memcmp(magic, projectMagic, sizeof(projectMagic)) != 0 || !reader.ok()) {
+        std::cerr << "Erreur: Ce n'est pas un fichier de projet: " << filePath << std::endl;
+        return false;
+    }
+    if (version > projectVersion) {
+        std::cerr << "Erreur: Fichier de projet de version " << version << ", plus récente que "
+            << projectVersion << ": " << filePath << std::endl;
+        return false;
+    }
+
+    ProjectData loaded;
+    bool valid = readSections(reader, loaded);
+    for (const auto& section : loaded.songSections) {
+        if (section.pattern >= loaded.patterns.size()) valid = false;
+    }
+    if (!valid) {
+        std::cerr << "Erreur: Fichier de projet invalide: " << filePath << std::endl;
+        return false;
+    }
+    project = std::move(loaded);
+    return true;
+}
+//----------------------------------------
+
+bool writeText(const std::string& filePath, const ProjectData& project) {
+    std::ofstream file(filePath, std::ios::trunc);
+    if (!file) {
+        std::cerr << "Erreur: Impossible de créer le fichier: " << filePath << std::endl;
+        return false;
+    }
+    file << "# Projet Adik Drum Machine, version " << projectVersion << "\n";
+    file << "kit " << project.kitName << "\n";
+    for (size_t i = 0; i < project.kitFiles.size(); ++i) {
+        file << "sound " << i + 1 << " " << project.kitFiles[i] << "\n";
+    }
+    file << "bpm " << project.bpm << "\n";
+    file << "volume " << project.globalVolume << "\n";
+    for (size_t i = 0; i < project.channels.size(); ++i) {
+        const auto& channel = project.channels[i];
+        file << "channel " << i + 1 << " volume " << channel.volume << " pan " << channel.pan
+            << " speed " << channel.speed << " delay " << channel.delay << " mute " << channel.muted << "\n";
+    }
+    for (size_t s = 0; s < project.songSections.size(); ++s) {
+        const SongSection& section = project.songSections[s];
+        file << "section " << s + 1 << " pattern " << section.pattern + 1 << " repeats " << section.repeats
+            << " bpm " << section.bpm << " velocity " << static_cast<int>(section.velocity) << " mute";
+        section.muted.forEach([&](size_t sound) { file << " " << sound + 1; });
+        file << "\n";
+    }
+    // Une ligne par son actif et par barre: 'x' pour un pas actif, '.' sinon
+    for (size_t p = 0; p < project.patterns.size(); ++p) {
+        const auto& bars = project.patterns[p];
+        file << "pattern " << p + 1 << " bars " << bars.size() << "\n";
+        for (size_t b = 0; b < bars.size(); ++b) {
+            const Bar& bar = *bars[b];
+            file << "bar " << b + 1 << " steps " << bar.size() << "\n";
+            Mask used;
+            for (const Mask& mask : bar) {
+                for (size_t w = 0; w < Mask::numWords; ++w) used.words[w] |= mask.words[w];
+            }
+            used.forEach([&](size_t track) {
+                file << "  " << std::setw(3) << std::setfill('0') << track + 1 << " ";
+                for (const Mask& mask : bar) file << (mask.test(track) ? 'x' : '.');
+                file << "\n";
+            });
+        }
+    }
+    if (!file) {
+        std::cerr << "Erreur: Écriture impossible: " << filePath << std::endl;
+        return false;
+    }
+    return true;
+}
+//----------------------------------------
+
+} // namespace projectfile
+} // namespace adikdrum
@@ -0,0 +1,58 @@
+#ifndef PROJECTFILE_H
+#define PROJECTFILE_H
+
+#include "adikpattern.h"
+#include "song.h"
+
+#include <string>
+#include <vector>
+#include <cstddef> // Pour size_t
+
+// Fichier de projet (.adkp): patterns, morceau, tempo, paramètres des canaux et kit.
+//
+// Format binaire (little-endian), fait pour un chargement rapide:
+// - magic ADKP, puis version (varint);
+// - sections: étiquette (1 octet), taille (varint), contenu. Une section inconnue est sautée,
+//   pour qu'une version plus ancienne du programme lise encore les projets plus récents;
+// - section pattern: les barres identiques ne sont écrites qu'une fois (table des barres,
+//   puis un index par barre), et chaque pas est son masque de sons tronqué au dernier octet
+//   utilisé: 2 octets par pas pour 16 sons. Les barres lues sont partagées comme en mémoire.
+// - section morceau (si le projet en a un): sections désignant les patterns par leur index;
+//   le premier pattern est celui en cours d'édition.
+// Les entiers de taille variable (varint) prennent 1 octet jusqu'à 127.
+//
+// L'export texte (writeText) sert à comparer deux projets (diff); il n'est pas relu.
+
+namespace adikdrum {
+
+struct ProjectData {
+    // Paramètres d'un son; canal du mixer = index du son + 1
+    struct Channel {
+        float volume = 1.0f;
+        float pan = 0.0f;
+        float speed = 1.0f;
+        bool delay = false;
+        bool muted = false;
+    };
+
+    std::string kitName;
+    std::vector<std::string> kitFiles; // Fichiers des sons par pad, rechargés s'ils sont tous présents
+    double bpm = 120.0;
+    float globalVolume = 0.8f;
+    std::vector<Channel> channels;
+    std::vector<std::vector<AdikPattern::BarPtr>> patterns; // Barres de chaque pattern
+    std::vector<SongSection> songSections; // Morceau; SongSection::pattern est un index dans patterns
+};
+
+namespace projectfile {
+
+// Renvoient false en cas d'erreur, avec un message sur std::cerr
+bool write(const std::string& filePath, const ProjectData& project);
+// Un fichier invalide ou d'une version plus récente laisse project inchangé
+bool read(const std::string& filePath, ProjectData& project);
+bool writeText(const std::string& filePath, const ProjectData& project);
+
+} // namespace projectfile
+} // namespace adikdrum
+
+#endif // PROJECTFILE_H
@@ -26,6 +26,7 @@ class Quantizer {
 public:
     // Constructeur : aura besoin d'accéder au pattern et au BPM
     Quantizer(std::shared_ptr<AdikPattern> pattern, double& bpmRef, int numSounds);
+    void setPattern(std::shared_ptr<AdikPattern> pattern) { curPattern_ = pattern; }
     
     // Définir la résolution de quantification pour l'enregistrement
     void setRecQuantizeResolution(size_t resolution);
@@ -0,0 +1,108 @@
+#include "reclaimer.h"
+
+#include <chrono>
+#include <iostream>
+
+namespace adikdrum {
+
+Reclaimer::Reclaimer() {
+}
+//----------------------------------------
+
+Reclaimer::~Reclaimer() {
+    stop();
+    // Plus aucun lecteur: tout peut être libéré
+    detachReader();
+    collect();
+}
+//----------------------------------------
+
+void Reclaimer::retire(std::shared_ptr<const void> object, size_t numBytes) {
+    if (!object) return;
+    Node* node = new Node{std::move(object), numBytes, 0, nullptr};
+    // L'objet a été remplacé avant l'incrément: un bloc qui lit un epoch plus récent ne le voit plus
+    node->epoch = epoch_.fetch_add(1, std::memory_order_acq_rel);
+    bytesPending_.fetch_add(numBytes, std::memory_order_relaxed);
+    numPending_.fetch_add(1, std::memory_order_relaxed);
+
+    node->next = head_.load(std::memory_order_relaxed);
+    while (!head_.compare_exchange_weak(node->next, node,
+                std::memory_order_release, std::memory_order_relaxed)) {
+    }
+}
+//----------------------------------------
+
+size_t Reclaimer::collect() {
+    std::lock_guard<std::mutex> lock(collectMutex_);
+    // Récupère d'un coup tous les objets retirés depuis le dernier passage
+    Node* node = head_.exchange(nullptr, std::memory_order_acquire);
+    while (node) {
+        Node* next = node->next;
+        node->next = waiting_;
+        waiting_ = node;
+        node = next;
+    }
+
+    const uint64_t readerEpoch = readerEpoch_.load(std::memory_order_acquire);
+    size_t bytesFreed = 0;
+    size_t numFreed = 0;
+    Node** link = &waiting_;
+    while (*link) {
+        Node* cur = *link;
+        if (cur->epoch < readerEpoch) {
+            *link = cur->next;
+            bytesFreed += cur->numBytes;
+            ++numFreed;
+            delete cur; // Libère l'objet, hors du thread audio
+        } else {
+            link = &cur->next;
+        }
+    }
+
+    if (numFreed > 0) {
+        bytesPending_.fetch_sub(bytesFreed, std::memory_order_relaxed);
+        numPending_.fetch_sub(numFreed, std::memory_order_relaxed);
+        bytesFreed_.fetch_add(bytesFreed, std::memory_order_relaxed);
+        numFreed_.fetch_add(numFreed, std::memory_order_relaxed);
+    }
+    return bytesFreed;
+}
+//----------------------------------------
+
+bool Reclaimer::start(int periodMs) {
+    if (janitor_.joinable()) return true;
+    if (periodMs <= 0) {
+        std::cerr << "Erreur: Période du janitor invalide: " << periodMs << " ms." << std::endl;
+        return false;
+    }
+    stopping_ = false;
+    janitor_ = std::thread(&Reclaimer::janitorLoop, this, periodMs);
+    return true;
+}
+//----------------------------------------
+
+void Reclaimer::stop() {
+    if (!janitor_.joinable()) return;
+    {
+        std::lock_guard<std::mutex> lock(janitorMutex_);
+        stopping_ = true;
+    }
+    janitorCond_.notify_one();
+    janitor_.join();
+}
+//----------------------------------------
+
+void Reclaimer::janitorLoop(int periodMs) {
+    std::unique_lock<std::mutex> lock(janitorMutex_);
+    while (!stopping_) {
+        janitorCond_.wait_for(lock, std::chrono::milliseconds(periodMs), [this] { return stopping_; });
+        lock.unlock();
+        collect();
+        lock.lock();
+    }
+}
+//----------------------------------------
+
+//==== End of class Reclaimer ====
+
+} // namespace adikdrum
@@ -0,0 +1,89 @@
+#ifndef RECLAIMER_H
+#define RECLAIMER_H
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cstddef> // Pour size_t
+#include <cstdint>
+#include <limits>
+
+namespace adikdrum {
+
+// Libération différée des données lues par le thread audio (SampleBuffer, anciens sons).
+// Le thread UI retire un objet après l'avoir remplacé dans les structures lues par le mixer;
+// un thread de ménage (janitor) le libère quand le thread audio ne peut plus y accéder.
+// Le thread audio ne libère ainsi jamais de mémoire.
+//
+// Principe (epochs):
+// - chaque objet retiré reçoit l'epoch courant, qui est ensuite incrémenté;
+// - le thread audio lit l'epoch au début de chaque bloc (getEpoch), et marque ses voix avec;
+// - à la fin du bloc, il publie le plus ancien epoch encore utilisé par une voix (setReaderEpoch);
+// - un objet retiré à l'epoch E peut être libéré dès que cet epoch publié dépasse E.
+// Un seul thread lecteur (le thread audio) est pris en charge.
+class Reclaimer {
+public:
+    static constexpr uint64_t noReader = std::numeric_limits<uint64_t>::max();
+
+    Reclaimer();
+    ~Reclaimer();
+    Reclaimer(const Reclaimer&) = delete;
+    Reclaimer& operator=(const Reclaimer&) = delete;
+
+    // Thread UI (ou de chargement): l'objet ne doit plus être accessible par les nouveaux blocs.
+    // Sans lecteur attaché, l'objet est libéré par le prochain passage du janitor.
+    void retire(std::shared_ptr<const void> object, size_t numBytes);
+
+    // Thread audio, sans allocation ni verrou
+    uint64_t getEpoch() const { return epoch_.load(std::memory_order_acquire); }
+    void setReaderEpoch(uint64_t epoch) { readerEpoch_.store(epoch, std::memory_order_release); }
+    // A appeler avant le démarrage et après l'arrêt du flux audio
+    void attachReader() { setReaderEpoch(getEpoch()); }
+    void detachReader() { setReaderEpoch(noReader); }
+
+    // Thread de ménage: collect() toutes les periodMs millisecondes
+    bool start(int periodMs = 50);
+    void stop();
+    bool isRunning() const { return janitor_.joinable(); }
+    // Libère les objets qui ne sont plus lus; renvoie le nombre d'octets libérés.
+    // Appelée par le janitor, ou directement quand il n'est pas démarré (rendu hors ligne).
+    size_t collect();
+
+    size_t getBytesPending() const { return bytesPending_.load(std::memory_order_relaxed); }
+    size_t getNumPending() const { return numPending_.load(std::memory_order_relaxed); }
+    size_t getBytesFreed() const { return bytesFreed_.load(std::memory_order_relaxed); }
+    size_t getNumFreed() const { return numFreed_.load(std::memory_order_relaxed); }
+
+private:
+    struct Node {
+        std::shared_ptr<const void> object;
+        size_t numBytes;
+        uint64_t epoch;
+        Node* next;
+    };
+
+    std::atomic<Node*> head_{nullptr}; // Pile sans verrou: objets retirés depuis le dernier passage
+    Node* waiting_ = nullptr;           // Objets encore lus au dernier passage (janitor uniquement)
+    std::mutex collectMutex_;           // Entre le janitor et un appel direct à collect()
+    std::atomic<uint64_t> epoch_{1};
+    std::atomic<uint64_t> readerEpoch_{noReader};
+
+    std::atomic<size_t> bytesPending_{0};
+    std::atomic<size_t> numPending_{0};
+    std::atomic<size_t> bytesFreed_{0};
+    std::atomic<size_t> numFreed_{0};
+
+    std::thread janitor_;
+    std::mutex janitorMutex_;
+    std::condition_variable janitorCond_;
+    bool stopping_ = false;
+
+    void janitorLoop(int periodMs);
+};
+//==== End of class Reclaimer ====
+
+} // namespace adikdrum
+
+#endif // RECLAIMER_H
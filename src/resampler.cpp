@@ -0,0 +1,696 @@
+#include "resampler.h"
+#include "mixkernels.h"
+#include "constants.h" // Pour PI
+
+#include <cmath>
+#include <cstring> // Pour std::memcpy
+#include <algorithm>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define ADIK_RESAMPLER_X86 1
+#include <immintrin.h>
+#endif
+
+namespace adikdrum {
+namespace resampler {
+
+namespace {
+
+// Partie fractionnaire de la phase, sur 24 bits: conversion exacte en float, identique en SIMD
+constexpr float fracScale = 1.0f / (1 << 24);
+constexpr int sincPhaseShift = phaseBits - 9;
+// Fenêtre convertie en float pour la lecture des sons stockés en entiers (8 Ko sur la pile)
+constexpr size_t convertWindowSamples = 2048; // 512 lignes dans la table polyphase
+static_assert(sincPhases == (size_t(1) << (phaseBits - sincPhaseShift)), "sincPhases doit valoir 2^(32 - sincPhaseShift)");
+
+inline float phaseFrac(uint64_t phase) {
+    return static_cast<float>(static_cast<int32_t>((phase & phaseFracMask) >> 8)) * fracScale;
+}
+//----------------------------------------
+
+// Ligne la plus proche de la fraction; la dernière (fraction 1) reste dans les 8 points
+inline size_t sincRow(uint64_t phase) {
+    return static_cast<size_t>(((phase & phaseFracMask) + (uint64_t(1) << (sincPhaseShift - 1))) >> sincPhaseShift);
+}
+//----------------------------------------
+
+// Table du sinc fenêtré (Blackman), une ligne de 8 coefficients par phase.
+// La version stéréo duplique chaque coefficient (c0 c0 c1 c1 ...), pour les frames entrelacées.
+struct SincTable {
+    alignas(32) float mono[sincPhases + 1][sincTaps];
+    alignas(32) float stereo[sincPhases + 1][2 * sincTaps];
+
+    SincTable() {
+        const double cutoff = 0.9; // Fraction de la fréquence de Nyquist, marge contre le repliement
+        const double halfWidth = sincTaps / 2.0;
+        for (size_t r = 0; r <= sincPhases; ++r) {
+            const double frac = static_cast<double>(r) / sincPhases;
+            double coefs[sincTaps];
+            double sum = 0.0;
+            for (size_t k = 0; k < sincTaps; ++k) {
+                const double x = static_cast<double>(k) - 3.0 - frac;
+                const double sinc = (x == 0.0) ? 1.0 : std::sin(PI * cutoff * x) / (PI * cutoff * x);
+                const double window = 0.42 + 0.5 * std::cos(PI * x / halfWidth) + 0.08 * std::cos(2.0 * PI * x / halfWidth);
+                coefs[k] = cutoff * sinc * window;
+                sum += coefs[k];
+            }
+            for (size_t k = 0; k < sincTaps; ++k) {
+                // Gain unitaire en continu, pour toutes les phases
+                const float c = static_cast<float>(coefs[k] / sum);
+                mono[r][k] = c;
+                stereo[r][2 * k] = c;
+                stereo[r][2 * k + 1] = c;
+            }
+        }
+    }
+};
+//----------------------------------------
+
+const SincTable sincTable;
+
+// Points lus avant et après la position, selon l'interpolation
+inline size_t tapsBefore(Interpolation interp) {
+    switch (interp) {
+        case Interpolation::Hermite: return 1;
+        case Interpolation::Sinc: return 3;
+        default: return 0;
+    }
+}
+//----------------------------------------
+
+inline size_t tapsAfter(Interpolation interp) {
+    switch (interp) {
+        case Interpolation::Hermite: return 2;
+        case Interpolation::Sinc: return 4;
+        default: return 1;
+    }
+}
+//----------------------------------------
+
+inline float hermite(float xm1, float x0, float x1, float x2, float t) {
+    const float c1 = 0.5f * (x1 - xm1);
+    const float c2 = xm1 - 2.5f * x0 + 2.0f * x1 - 0.5f * x2;
+    const float c3 = 0.5f * (x2 - xm1) + 1.5f * (x0 - x1);
+    return ((c3 * t + c2) * t + c1) * t + x0;
+}
+//----------------------------------------
+
+// Une frame, avec les points hors du son ramenés au bord: pour les débuts et fins de son
+void interpolateEdge(float* out, const float* src, size_t numSrcFrames, size_t numChannels,
+        uint64_t phase, Interpolation interp) {
+    const int64_t idx = static_cast<int64_t>(phaseToFrames(phase));
+    const int64_t last = static_cast<int64_t>(numSrcFrames) - 1;
+    auto at = [&](int64_t i, size_t c) {
+        return src[static_cast<size_t>(std::clamp<int64_t>(i, 0, last)) * numChannels + c];
+    };
+    const float t = phaseFrac(phase);
+    for (size_t c = 0; c < numChannels; ++c) {
+        switch (interp) {
+            case Interpolation::Linear: {
+                const float x0 = at(idx, c);
+                out[c] = x0 + (at(idx + 1, c) - x0) * t;
+                break;
+            }
+            case Interpolation::Hermite:
+                out[c] = hermite(at(idx - 1, c), at(idx, c), at(idx + 1, c), at(idx + 2, c), t);
+                break;
+            case Interpolation::Sinc: {
+                const float* row = sincTable.mono[sincRow(phase)];
+                float acc = 0.0f;
+                for (size_t k = 0; k < sincTaps; ++k) {
+                    acc += at(idx - 3 + static_cast<int64_t>(k), c) * row[k];
+                }
+                out[c] = acc;
+                break;
+            }
+        }
+    }
+}
+//----------------------------------------
+
+// Noyau pour numFrames frames dont tous les points sont dans le son
+using InteriorFunc = void (*)(float* out, size_t numFrames, const float* src, size_t numChannels,
+        uint64_t phase, uint64_t increment);
+
+struct InteriorTable {
+    InteriorFunc linear;
+    InteriorFunc hermite;
+    InteriorFunc sinc;
+};
+
+InteriorFunc selectInterior(const InteriorTable& table, Interpolation interp) {
+    switch (interp) {
+        case Interpolation::Hermite: return table.hermite;
+        case Interpolation::Sinc: return table.sinc;
+        default: return table.linear;
+    }
+}
+//----------------------------------------
+
+// Découpe le bloc: copie directe à vitesse 1, noyau rapide à l'intérieur du son, bords frame par frame
+size_t run(float* out, size_t numFrames, const float* src, size_t numSrcFrames, size_t numChannels,
+        uint64_t& phase, uint64_t increment, Interpolation interp, InteriorFunc interior) {
+    if (!src || numChannels == 0 || increment == 0) return 0;
+    const size_t before = tapsBefore(interp);
+    const size_t after = tapsAfter(interp);
+    size_t framesDone = 0;
+    while (framesDone < numFrames) {
+        const size_t idx = phaseToFrames(phase);
+        if (idx >= numSrcFrames) break;
+        const size_t remaining = numFrames - framesDone;
+        float* dest = out + framesDone * numChannels;
+
+        if (increment == phaseOne && (phase & phaseFracMask) == 0) {
+            // Vitesse normale, sur une frame entière: copie directe
+            const size_t count = std::min(remaining, numSrcFrames - idx);
+            std::memcpy(dest, src + idx * numChannels, count * numChannels * sizeof(float));
+            phase += framesToPhase(count);
+            framesDone += count;
+            continue;
+        }
+
+        size_t count = 0;
+        if (idx >= before && idx + after < numSrcFrames) {
+            // Dernière phase dont tous les points sont dans le son
+            const uint64_t lastPhase = framesToPhase(numSrcFrames - after) - 1;
+            count = static_cast<size_t>(std::min<uint64_t>(remaining, (lastPhase - phase) / increment + 1));
+        }
+        if (count > 0) {
+            interior(dest, count, src, numChannels, phase, increment);
+            phase += count * increment;
+            framesDone += count;
+        } else {
+            interpolateEdge(dest, src, numSrcFrames, numChannels, phase, interp);
+            phase += increment;
+            ++framesDone;
+        }
+    }
+    return framesDone;
+}
+//----------------------------------------
+
+} // namespace
+
+namespace scalar {
+
+void linearInterior(float* out, size_t numFrames, const float* src, size_t numChannels, uint64_t phase, uint64_t increment) {
+    for (size_t i = 0; i < numFrames; ++i, phase += increment) {
+        const float* s = src + phaseToFrames(phase) * numChannels;
+        const float t = phaseFrac(phase);
+        for (size_t c = 0; c < numChannels; ++c) {
+            out[i * numChannels + c] = s[c] + (s[numChannels + c] - s[c]) * t;
+        }
+    }
+}
+//----------------------------------------
+
+void hermiteInterior(float* out, size_t numFrames, const float* src, size_t numChannels, uint64_t phase, uint64_t increment) {
+    for (size_t i = 0; i < numFrames; ++i, phase += increment) {
+        const float* s = src + phaseToFrames(phase) * numChannels;
+        const float* prev = s - numChannels;
+        const float t = phaseFrac(phase);
+        for (size_t c = 0; c < numChannels; ++c) {
+            out[i * numChannels + c] = hermite(prev[c], s[c], s[numChannels + c], s[2 * numChannels + c], t);
+        }
+    }
+}
+//----------------------------------------
+
+void sincInterior(float* out, size_t numFrames, const float* src, size_t numChannels, uint64_t phase, uint64_t increment) {
+    for (size_t i = 0; i < numFrames; ++i, phase += increment) {
+        const float* s = src + (phaseToFrames(phase) - 3) * numChannels;
+        const float* row = sincTable.mono[sincRow(phase)];
+        for (size_t c = 0; c < numChannels; ++c) {
+            float acc = 0.0f;
+            for (size_t k = 0; k < sincTaps; ++k) {
+                acc += s[k * numChannels + c] * row[k];
+            }
+            out[i * numChannels + c] = acc;
+        }
+    }
+}
+//----------------------------------------
+
+const InteriorTable interiors = {linearInterior, hermiteInterior, sincInterior};
+
+size_t process(float* out, size_t numFrames, const float* src, size_t numSrcFrames, size_t numChannels,
+        uint64_t& phase, uint64_t increment, Interpolation interp) {
+    return run(out, numFrames, src, numSrcFrames, numChannels, phase, increment, interp, selectInterior(interiors, interp));
+}
+//----------------------------------------
+
+} // namespace scalar
+
+#ifdef ADIK_RESAMPLER_X86
+
+// Linéaire et Hermite: plusieurs frames de sortie par itération (4 en SSE2, 8 en AVX2).
+// Sinc: les 8 points d'une frame en un ou deux vecteurs.
+// Seuls les sons mono et stéréo ont une version vectorisée; les fins de bloc passent par le scalaire.
+namespace sse2 {
+
+// Indices et fractions de 4 frames consécutives
+__attribute__((target("sse2")))
+inline __m128 loadFrac4(uint64_t phase, uint64_t increment, size_t* idx) {
+    alignas(16) float t[4];
+    for (int j = 0; j < 4; ++j) {
+        const uint64_t p = phase + j * increment;
+        idx[j] = phaseToFrames(p);
+        t[j] = phaseFrac(p);
+    }
+    return _mm_load_ps(t);
+}
+//----------------------------------------
+
+__attribute__((target("sse2")))
+inline __m128 gather4(const float* src, const size_t* idx, size_t stride, ptrdiff_t offset) {
+    auto at = [&](size_t j) { return src[static_cast<ptrdiff_t>(idx[j] * stride) + offset]; };
+    return _mm_setr_ps(at(0), at(1), at(2), at(3));
+}
+//----------------------------------------
+
+__attribute__((target("sse2")))
+inline __m128 hermite4(__m128 xm1, __m128 x0, __m128 x1, __m128 x2, __m128 t) {
+    const __m128 half = _mm_set1_ps(0.5f);
+    const __m128 c1 = _mm_mul_ps(half, _mm_sub_ps(x1, xm1));
+    const __m128 c2 = _mm_sub_ps(_mm_add_ps(_mm_sub_ps(xm1, _mm_mul_ps(_mm_set1_ps(2.5f), x0)),
+                _mm_mul_ps(_mm_set1_ps(2.0f), x1)), _mm_mul_ps(half, x2));
+    const __m128 c3 = _mm_add_ps(_mm_mul_ps(half, _mm_sub_ps(x2, xm1)), _mm_mul_ps(_mm_set1_ps(1.5f), _mm_sub_ps(x0, x1)));
+    return _mm_add_ps(_mm_mul_ps(_mm_add_ps(_mm_mul_ps(_mm_add_ps(_mm_mul_ps(c3, t), c2), t), c1), t), x0);
+}
+//----------------------------------------
+
+__attribute__((target("sse2")))
+inline void storeFrames4(float* out, size_t numChannels, __m128 left, __m128 right) {
+    if (numChannels == 1) {
+        _mm_storeu_ps(out, left);
+    } else {
+        _mm_storeu_ps(out, _mm_unpacklo_ps(left, right));
+        _mm_storeu_ps(out + 4, _mm_unpackhi_ps(left, right));
+    }
+}
+//----------------------------------------
+
+__attribute__((target("sse2")))
+void linearInterior(float* out, size_t numFrames, const float* src, size_t numChannels, uint64_t phase, uint64_t increment) {
+    if (numChannels > 2) return scalar::linearInterior(out, numFrames, src, numChannels, phase, increment);
+    const ptrdiff_t nc = static_cast<ptrdiff_t>(numChannels);
+    size_t i = 0;
+    size_t idx[4];
+    for (; i + 4 <= numFrames; i += 4, phase += 4 * increment) {
+        const __m128 t = loadFrac4(phase, increment, idx);
+        __m128 res[2] = {};
+        for (ptrdiff_t c = 0; c < nc; ++c) {
+            const __m128 x0 = gather4(src, idx, numChannels, c);
+            const __m128 x1 = gather4(src, idx, numChannels, nc + c);
+            res[c] = _mm_add_ps(x0, _mm_mul_ps(_mm_sub_ps(x1, x0), t));
+        }
+        storeFrames4(out + i * numChannels, numChannels, res[0], res[nc - 1]);
+    }
+    scalar::linearInterior(out + i * numChannels, numFrames - i, src, numChannels, phase, increment);
+}
+//----------------------------------------
+
+__attribute__((target("sse2")))
+void hermiteInterior(float* out, size_t numFrames, const float* src, size_t numChannels, uint64_t phase, uint64_t increment) {
+    if (numChannels > 2) return scalar::hermiteInterior(out, numFrames, src, numChannels, phase, increment);
+    const ptrdiff_t nc = static_cast<ptrdiff_t>(numChannels);
+    size_t i = 0;
+    size_t idx[4];
+    for (; i + 4 <= numFrames; i += 4, phase += 4 * increment) {
+        const __m128 t = loadFrac4(phase, increment, idx);
+        __m128 res[2] = {};
+        for (ptrdiff_t c = 0; c < nc; ++c) {
+            res[c] = hermite4(gather4(src, idx, numChannels, c - nc), gather4(src, idx, numChannels, c),
+                    gather4(src, idx, numChannels, nc + c), gather4(src, idx, numChannels, 2 * nc + c), t);
+        }
+        storeFrames4(out + i * numChannels, numChannels, res[0], res[nc - 1]);
+    }
+    scalar::hermiteInterior(out + i * numChannels, numFrames - i, src, numChannels, phase, increment);
+}
+//----------------------------------------
+
+__attribute__((target("sse2")))
+void sincInterior(float* out, size_t numFrames, const float* src, size_t numChannels, uint64_t phase, uint64_t increment) {
+    if (numChannels > 2) return scalar::sincInterior(out, numFrames, src, numChannels, phase, increment);
+    for (size_t i = 0; i < numFrames; ++i, phase += increment) {
+        const float* s = src + (phaseToFrames(phase) - 3) * numChannels;
+        if (numChannels == 1) {
+            const float* row = sincTable.mono[sincRow(phase)];
+            __m128 acc = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(s), _mm_load_ps(row)),
+                    _mm_mul_ps(_mm_loadu_ps(s + 4), _mm_load_ps(row + 4)));
+            acc = _mm_add_ps(acc, _mm_movehl_ps(acc, acc));
+            acc = _mm_add_ss(acc, _mm_shuffle_ps(acc, acc, 1));
+            _mm_store_ss(out + i, acc);
+        } else {
+            // Frames entrelacées: L R L R, avec les coefficients dupliqués
+            const float* row = sincTable.stereo[sincRow(phase)];
+            __m128 acc = _mm_mul_ps(_mm_loadu_ps(s), _mm_load_ps(row));
+            acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(s + 4), _mm_load_ps(row + 4)));
+            acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(s + 8), _mm_load_ps(row + 8)));
+            acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(s + 12), _mm_load_ps(row + 12)));
+            acc = _mm_add_ps(acc, _mm_movehl_ps(acc, acc));
+            _mm_storel_pi(reinterpret_cast<__m64*>(out + 2 * i), acc);
+        }
+    }
+}
+//----------------------------------------
+
+const InteriorTable interiors = {linearInterior, hermiteInterior, sincInterior};
+
+} // namespace sse2
+
+namespace avx2 {
+
+// Indices (en échantillons, décalés de offset) et fractions de 8 frames consécutives
+__attribute__((target("avx2")))
+inline __m256 loadFrac8(uint64_t phase, uint64_t increment, size_t numChannels, __m256i& base) {
+    alignas(32) int32_t idx[8];
+    for (int j = 0; j < 8; ++j) {
+        idx[j] = static_cast<int32_t>(phaseToFrames(phase + j * increment) * numChannels);
+    }
+    base = _mm256_load_si256(reinterpret_cast<const __m256i*>(idx));
+    // Les 32 bits de poids faible de la phase suffisent pour la fraction
+    const __m256i steps = _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7),
+            _mm256_set1_epi32(static_cast<int32_t>(increment & phaseFracMask)));
+    const __m256i frac = _mm256_add_epi32(_mm256_set1_epi32(static_cast<int32_t>(phase & phaseFracMask)), steps);
+    return _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_srli_epi32(frac, 8)), _mm256_set1_ps(fracScale));
+}
+//----------------------------------------
+
+__attribute__((target("avx2")))
+inline __m256 gather8(const float* src, __m256i base, int offset) {
+    return _mm256_i32gather_ps(src + offset, base, 4);
+}
+//----------------------------------------
+
+__attribute__((target("avx2")))
+inline __m256 hermite8(__m256 xm1, __m256 x0, __m256 x1, __m256 x2, __m256 t) {
+    const __m256 half = _mm256_set1_ps(0.5f);
+    const __m256 c1 = _mm256_mul_ps(half, _mm256_sub_ps(x1, xm1));
+    const __m256 c2 = _mm256_sub_ps(_mm256_add_ps(_mm256_sub_ps(xm1, _mm256_mul_ps(_mm256_set1_ps(2.5f), x0)),
+                _mm256_mul_ps(_mm256_set1_ps(2.0f), x1)), _mm256_mul_ps(half, x2));
+    const __m256 c3 = _mm256_add_ps(_mm256_mul_ps(half, _mm256_sub_ps(x2, xm1)),
+            _mm256_mul_ps(_mm256_set1_ps(1.5f), _mm256_sub_ps(x0, x1)));
+    return _mm256_add_ps(_mm256_mul_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_add_ps(_mm256_mul_ps(c3, t), c2), t), c1), t), x0);
+}
+//----------------------------------------
+
+__attribute__((target("avx2")))
+inline void storeFrames8(float* out, size_t numChannels, __m256 left, __m256 right) {
+    if (numChannels == 1) {
+        _mm256_storeu_ps(out, left);
+    } else {
+        // unpack travaille par moitiés de 128 bits: on recompose l'ordre des frames ensuite
+        const __m256 lo = _mm256_unpacklo_ps(left, right);
+        const __m256 hi = _mm256_unpackhi_ps(left, right);
+        _mm256_storeu_ps(out, _mm256_permute2f128_ps(lo, hi, 0x20));
+        _mm256_storeu_ps(out + 8, _mm256_permute2f128_ps(lo, hi, 0x31));
+    }
+}
+//----------------------------------------
+
+__attribute__((target("avx2")))
+void linearInterior(float* out, size_t numFrames, const float* src, size_t numChannels, uint64_t phase, uint64_t increment) {
+    if (numChannels > 2) return scalar::linearInterior(out, numFrames, src, numChannels, phase, increment);
+    const int nc = static_cast<int>(numChannels);
+    size_t i = 0;
+    __m256i base;
+    for (; i + 8 <= numFrames; i += 8, phase += 8 * increment) {
+        const __m256 t = loadFrac8(phase, increment, numChannels, base);
+        __m256 res[2] = {};
+        for (int c = 0; c < nc; ++c) {
+            const __m256 x0 = gather8(src, base, c);
+            const __m256 x1 = gather8(src, base, nc + c);
+            res[c] = _mm256_add_ps(x0, _mm256_mul_ps(_mm256_sub_ps(x1, x0), t));
+        }
+        storeFrames8(out + i * numChannels, numChannels, res[0], res[nc - 1]);
+    }
+    sse2::linearInterior(out + i * numChannels, numFrames - i, src, numChannels, phase, increment);
+}
+//----------------------------------------
+
+__attribute__((target("avx2")))
+void hermiteInterior(float* out, size_t numFrames, const float* src, size_t numChannels, uint64_t phase, uint64_t increment) {
+    if (numChannels > 2) return scalar::hermiteInterior(out, numFrames, src, numChannels, phase, increment);
+    const int nc = static_cast<int>(numChannels);
+    size_t i = 0;
+    __m256i base;
+    for (; i + 8 <= numFrames; i += 8, phase += 8 * increment) {
+        const __m256 t = loadFrac8(phase, increment, numChannels, base);
+        __m256 res[2] = {};
+        for (int c = 0; c < nc; ++c) {
+            res[c] = hermite8(gather8(src, base, c - nc), gather8(src, base, c),
+                    gather8(src, base, nc + c), gather8(src, base, 2 * nc + c), t);
+        }
+        storeFrames8(out + i * numChannels, numChannels, res[0], res[nc - 1]);
+    }
+    sse2::hermiteInterior(out + i * numChannels, numFrames - i, src, numChannels, phase, increment);
+}
+//----------------------------------------
+
+__attribute__((target("avx2")))
+void sincInterior(float* out, size_t numFrames, const float* src, size_t numChannels, uint64_t phase, uint64_t increment) {
+    if (numChannels > 2) return scalar::sincInterior(out, numFrames, src, numChannels, phase, increment);
+    for (size_t i = 0; i < numFrames; ++i, phase += increment) {
+        const float* s = src + (phaseToFrames(phase) - 3) * numChannels;
+        __m256 acc;
+        if (numChannels == 1) {
+            acc = _mm256_mul_ps(_mm256_loadu_ps(s), _mm256_load_ps(sincTable.mono[sincRow(phase)]));
+        } else {
+            const float* row = sincTable.stereo[sincRow(phase)];
+            acc = _mm256_add_ps(_mm256_mul_ps(_mm256_loadu_ps(s), _mm256_load_ps(row)),
+                    _mm256_mul_ps(_mm256_loadu_ps(s + 8), _mm256_load_ps(row + 8)));
+        }
+        __m128 sum = _mm_add_ps(_mm256_castps256_ps128(acc), _mm256_extractf128_ps(acc, 1));
+        sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+        if (numChannels == 1) {
+            sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 1));
+            _mm_store_ss(out + i, sum);
+        } else {
+            _mm_storel_pi(reinterpret_cast<__m64*>(out + 2 * i), sum);
+        }
+    }
+}
+//----------------------------------------
+
+const InteriorTable interiors = {linearInterior, hermiteInterior, sincInterior};
+
+} // namespace avx2
+
+#endif // ADIK_RESAMPLER_X86
+
+uint64_t speedToIncrement(double speed) {
+    if (!(speed > 0.0)) return 1; // Vitesse nulle ou invalide: la voix avance au minimum
+    const double increment = std::round(speed * static_cast<double>(phaseOne));
+    return increment < 1.0 ? 1 : static_cast<uint64_t>(increment);
+}
+//----------------------------------------
+
+size_t getSampleFormatSize(SampleFormat format) {
+    return format == SampleFormat::Int16 ? sizeof(int16_t) : sizeof(float); // Int24: int32
+}
+//----------------------------------------
+
+const char* getSampleFormatName(SampleFormat format) {
+    switch (format) {
+        case SampleFormat::Int16: return "int16";
+        case SampleFormat::Int24: return "int24";
+        default: return "float32";
+    }
+}
+//----------------------------------------
+
+namespace {
+
+// Même niveau SIMD que les noyaux de mixage (forçable avec mixkernels::setSimdLevel)
+const InteriorTable& getInteriorTable() {
+#ifdef ADIK_RESAMPLER_X86
+    switch (mixkernels::getSimdLevel()) {
+        case mixkernels::SimdLevel::AVX2: return avx2::interiors;
+        case mixkernels::SimdLevel::SSE2: return sse2::interiors;
+        default: break;
+    }
+#endif
+    return scalar::interiors;
+}
+//----------------------------------------
+
+} // namespace
+
+size_t process(float* out, size_t numFrames, const float* src, size_t numSrcFrames, size_t numChannels,
+        uint64_t& phase, uint64_t increment, Interpolation interp) {
+    return run(out, numFrames, src, numSrcFrames, numChannels, phase, increment, interp,
+            selectInterior(getInteriorTable(), interp));
+}
+//----------------------------------------
+
+void convertSamples(float* out, const void* src, SampleFormat format, size_t offset, size_t count) {
+    switch (format) {
+        case SampleFormat::Int16:
+            mixkernels::int16ToFloat(out, static_cast<const int16_t*>(src) + offset, count);
+            break;
+        case SampleFormat::Int24:
+            mixkernels::int24ToFloat(out, static_cast<const int32_t*>(src) + offset, count);
+            break;
+        default:
+            std::memcpy(out, static_cast<const float*>(src) + offset, count * sizeof(float));
+            break;
+    }
+}
+//----------------------------------------
+
+size_t process(float* out, size_t numFrames, const void* src, SampleFormat format, size_t numSrcFrames,
+        size_t numChannels, uint64_t& phase, uint64_t increment, Interpolation interp) {
+    if (format == SampleFormat::Float32) {
+        return process(out, numFrames, static_cast<const float*>(src), numSrcFrames, numChannels, phase, increment, interp);
+    }
+    if (!src || numChannels == 0 || increment == 0) return 0;
+    const size_t before = tapsBefore(interp);
+    const size_t after = tapsAfter(interp);
+    const size_t maxWindowFrames = convertWindowSamples / numChannels;
+    if (maxWindowFrames <= before + after) return 0; // Trop de canaux pour la fenêtre
+    const InteriorFunc interior = selectInterior(getInteriorTable(), interp);
+    float window[convertWindowSamples];
+    size_t framesDone = 0;
+    while (framesDone < numFrames) {
+        const size_t idx = phaseToFrames(phase);
+        if (idx >= numSrcFrames) break;
+        const size_t remaining = numFrames - framesDone;
+        // Fenêtre: les points de toutes les frames restantes, dans la limite du buffer
+        const size_t first = idx > before ? idx - before : 0;
+        const size_t lastNeeded = phaseToFrames(phase + (remaining - 1) * increment) + after;
+        const size_t windowFrames = std::min({maxWindowFrames, numSrcFrames - first, lastNeeded + 1 - first});
+        size_t count = remaining;
+        if (first + windowFrames < numSrcFrames) {
+            // Les bords de la fenêtre ne sont pas ceux du son: seulement les frames dont tous les points y sont
+            const uint64_t lastPhase = framesToPhase(first + windowFrames - after) - 1;
+            count = static_cast<size_t>(std::min<uint64_t>(count, (lastPhase - phase) / increment + 1));
+        }
+        convertSamples(window, src, format, first * numChannels, windowFrames * numChannels);
+        uint64_t windowPhase = phase - framesToPhase(first);
+        const size_t framesRead = run(out + framesDone * numChannels, count, window, windowFrames, numChannels,
+                windowPhase, increment, interp, interior);
+        phase = windowPhase + framesToPhase(first);
+        framesDone += framesRead;
+        if (framesRead < count) break; // Fin du son
+    }
+    return framesDone;
+}
+//----------------------------------------
+
+namespace {
+
+// Demi-noyau du sinc fenêtré de convertRate, de 0 à convertZeroCrossings passages par zéro,
+// convertOversample points par passage, lu par interpolation linéaire
+constexpr size_t convertZeroCrossings = 32;
+constexpr size_t convertOversample = 512;
+constexpr double convertKaiserBeta = 9.0; // Environ -90 dB hors de la bande passante
+constexpr double convertRolloff = 0.95;   // Fraction de la fréquence de Nyquist conservée
+
+// Fonction de Bessel modifiée d'ordre 0, pour la fenêtre de Kaiser
+double besselI0(double x) {
+    double sum = 1.0;
+    double term = 1.0;
+    for (int k = 1; k < 50; ++k) {
+        term *= (x / (2.0 * k)) * (x / (2.0 * k));
+        sum += term;
+        if (term < sum * 1e-16) break;
+    }
+    return sum;
+}
+//----------------------------------------
+
+std::vector<double> makeConvertKernel() {
+    const size_t size = convertZeroCrossings * convertOversample + 1;
+    std::vector<double> kernel(size);
+    const double i0Beta = besselI0(convertKaiserBeta);
+    for (size_t i = 0; i < size; ++i) {
+        const double u = static_cast<double>(i) / convertOversample;
+        const double sinc = (i == 0) ? 1.0 : std::sin(PI * u) / (PI * u);
+        const double r = u / convertZeroCrossings;
+        const double window = besselI0(convertKaiserBeta * std::sqrt(std::max(0.0, 1.0 - r * r))) / i0Beta;
+        kernel[i] = sinc * window;
+    }
+    return kernel;
+}
+//----------------------------------------
+
+} // namespace
+
+AlignedVector<float> convertRate(const float* src, size_t numFrames, size_t numChannels, size_t srcRate, size_t dstRate) {
+    if (!src || numFrames == 0 || numChannels == 0 || srcRate == 0 || dstRate == 0) return {};
+    if (srcRate == dstRate) return AlignedVector<float>(src, src + numFrames * numChannels);
+
+    static const std::vector<double> kernel = makeConvertKernel();
+    // Coupure relative à la fréquence de Nyquist de la source
+    const double cutoff = convertRolloff * std::min(1.0, static_cast<double>(dstRate) / srcRate);
+    const double halfWidth = convertZeroCrossings / cutoff; // En frames de la source
+    const size_t maxTaps = static_cast<size_t>(std::ceil(2.0 * halfWidth)) + 2;
+
+    const size_t numOutFrames = static_cast<size_t>((static_cast<uint64_t>(numFrames) * dstRate + srcRate - 1) / srcRate);
+    AlignedVector<float> out(numOutFrames * numChannels);
+    std::vector<double> weights(maxTaps);
+    std::vector<double> acc(numChannels);
+    const ptrdiff_t lastFrame = static_cast<ptrdiff_t>(numFrames) - 1;
+
+    for (size_t n = 0; n < numOutFrames; ++n) {
+        // Position exacte dans la source: n * srcRate / dstRate, partie entière et fraction
+        const uint64_t num = static_cast<uint64_t>(n) * srcRate;
+        const ptrdiff_t idx = static_cast<ptrdiff_t>(num / dstRate);
+        const double t = idx + static_cast<double>(num % dstRate) / dstRate;
+        const ptrdiff_t first = static_cast<ptrdiff_t>(std::floor(t - halfWidth)) + 1;
+        const ptrdiff_t last = static_cast<ptrdiff_t>(std::floor(t + halfWidth));
+
+        // Poids du noyau, calculés une fois pour tous les canaux
+        size_t numTaps = 0;
+        for (ptrdiff_t i = first; i <= last && numTaps < maxTaps; ++i, ++numTaps) {
+            const double pos = std::fabs(t - i) * cutoff * convertOversample;
+            const size_t k = static_cast<size_t>(pos);
+            if (k + 1 >= kernel.size()) {
+                weights[numTaps] = 0.0;
+            } else {
+                const double f = pos - k;
+                weights[numTaps] = cutoff * (kernel[k] + f * (kernel[k + 1] - kernel[k]));
+            }
+        }
+
+        // Hors du son: silence
+        std::fill(acc.begin(), acc.end(), 0.0);
+        for (size_t j = 0; j < numTaps; ++j) {
+            const ptrdiff_t i = first + static_cast<ptrdiff_t>(j);
+            if (i < 0 || i > lastFrame) continue;
+            const float* frame = src + static_cast<size_t>(i) * numChannels;
+            for (size_t c = 0; c < numChannels; ++c) acc[c] += weights[j] * frame[c];
+        }
+        float* outFrame = out.data() + n * numChannels;
+        for (size_t c = 0; c < numChannels; ++c) outFrame[c] = static_cast<float>(acc[c]);
+    }
+    return out;
+}
+//----------------------------------------
+
+const char* getInterpolationName(Interpolation interp) {
+    switch (interp) {
+        case Interpolation::Hermite: return "hermite";
+        case Interpolation::Sinc: return "sinc";
+        default: return "linear";
+    }
+}
+//----------------------------------------
+
+bool parseInterpolation(const std::string& name, Interpolation& interp) {
+    if (name == "linear") {
+        interp = Interpolation::Linear;
+    } else if (name == "hermite") {
+        interp = Interpolation::Hermite;
+    } else if (name == "sinc") {
+        interp = Interpolation::Sinc;
+    } else {
+        return false;
+    }
+    return true;
+}
+//----------------------------------------
+
+} // namespace resampler
+} // namespace adikdrum
@@ -0,0 +1,73 @@
+#ifndef RESAMPLER_H
+#define RESAMPLER_H
+
+#include <cstddef> // Pour size_t
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "alignedbuffer.h"
+
+namespace adikdrum {
+namespace resampler {
+
+// Lecture d'un son à vitesse variable, par blocs.
+// La position est un nombre à virgule fixe 32.32 (frames, fraction): pas de perte
+// de précision sur les sons longs, et pas de std::floor par frame.
+// Les sons sont mono ou stéréo entrelacé. En dehors du son, l'échantillon
+// le plus proche est répété (comme l'ancienne interpolation linéaire).
+enum class Interpolation { Linear, Hermite, Sinc };
+
+constexpr int phaseBits = 32;
+constexpr uint64_t phaseOne = uint64_t(1) << phaseBits;
+constexpr uint64_t phaseFracMask = phaseOne - 1;
+// Noyau sinc: 8 points (de -3 à +4 autour de la position), table polyphase
+constexpr size_t sincTaps = 8;
+constexpr size_t sincPhases = 512;
+// Points lus au plus avant et après la position (sinc), pour qui fournit les données par morceaux
+constexpr size_t maxTapsBefore = 3;
+constexpr size_t maxTapsAfter = 4;
+
+// Format des échantillons d'un son en mémoire. Int24: 24 bits signés dans un int32.
+enum class SampleFormat { Float32, Int16, Int24 };
+size_t getSampleFormatSize(SampleFormat format); // En octets
+const char* getSampleFormatName(SampleFormat format);
+
+inline uint64_t framesToPhase(size_t frames) { return static_cast<uint64_t>(frames) << phaseBits; }
+inline size_t phaseToFrames(uint64_t phase) { return static_cast<size_t>(phase >> phaseBits); }
+uint64_t speedToIncrement(double speed);
+
+// Ecrit au plus numFrames frames dans out, lues dans src (numSrcFrames frames de numChannels canaux)
+// à partir de phase, avancée de increment par frame. S'arrête à la fin du son.
+// Renvoie le nombre de frames écrites. Vitesse 1 sur une frame entière: copie directe.
+size_t process(float* out, size_t numFrames, const float* src, size_t numSrcFrames, size_t numChannels,
+        uint64_t& phase, uint64_t increment, Interpolation interp);
+// Même lecture, pour un son stocké dans un autre format (Int16, Int24).
+// Les points lus sont convertis en float par fenêtres (noyaux mixkernels), dans un buffer sur la pile:
+// rien n'est alloué, et le son reste compact en mémoire. Résultat identique à celui du son en float.
+size_t process(float* out, size_t numFrames, const void* src, SampleFormat format, size_t numSrcFrames,
+        size_t numChannels, uint64_t& phase, uint64_t increment, Interpolation interp);
+// Copie count échantillons de src à partir de offset (en échantillons), convertis en float
+void convertSamples(float* out, const void* src, SampleFormat format, size_t offset, size_t count);
+
+const char* getInterpolationName(Interpolation interp);
+// "linear", "hermite" ou "sinc"; renvoie false si le nom est inconnu
+bool parseInterpolation(const std::string& name, Interpolation& interp);
+
+// Conversion de fréquence d'échantillonnage, hors ligne (au chargement d'un son, jamais sur le thread audio).
+// Sinc fenêtré Kaiser de 32 passages par zéro de chaque côté; en descendant de fréquence,
+// la coupure suit la nouvelle fréquence de Nyquist (anti-repliement).
+// Renvoie numFrames * dstRate / srcRate frames (arrondi supérieur), entrelacées comme src,
+// dans un buffer aligné que SampleBuffer reprend sans copie.
+AlignedVector<float> convertRate(const float* src, size_t numFrames, size_t numChannels, size_t srcRate, size_t dstRate);
+
+// Version scalaire, référence pour la vérification des versions vectorisées
+namespace scalar {
+size_t process(float* out, size_t numFrames, const float* src, size_t numSrcFrames, size_t numChannels,
+        uint64_t& phase, uint64_t increment, Interpolation interp);
+} // namespace scalar
+
+} // namespace resampler
+} // namespace adikdrum
+
+#endif // RESAMPLER_H
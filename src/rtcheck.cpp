@@ -0,0 +1,158 @@
+#include "rtcheck.h"
+
+#include <cstdlib>
+#include <cstddef>
+#include <new>
+#include <cerrno>
+#include <unistd.h> // Pour write (pas d'allocation)
+
+namespace adikdrum {
+namespace rtcheck {
+
+static thread_local bool audioThread_ = false;
+
+void setAudioThread(bool active) {
+    audioThread_ = active;
+}
+//----------------------------------------
+
+bool isAudioThread() {
+    return audioThread_;
+}
+//----------------------------------------
+
+} // namespace rtcheck
+} // namespace adikdrum
+
+#ifdef ADIK_RT_ALLOC_CHECK
+
+// Note: on ne peut pas utiliser std::cerr ici, il risquerait lui-même d'allouer.
+static void rtTrap(const char* what) {
+    // On désactive le contrôle pour que abort() et ses handlers puissent allouer.
+    adikdrum::rtcheck::setAudioThread(false);
+    const char prefix[] = "RTCHECK: allocation interdite sur le thread audio: ";
+    ssize_t ret = write(2, prefix, sizeof(prefix) - 1);
+    size_t len = 0;
+    while (what[len]) len++;
+    ret = write(2, what, len);
+    ret = write(2, "\n", 1);
+    (void)ret;
+    std::abort();
+}
+//----------------------------------------
+
+#if defined(__GLIBC__)
+// Avec la glibc, on intercepte directement malloc/free,
+// ce qui couvre aussi les allocations faites par le C (strdup, printf, etc).
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t num, size_t size);
+void* __libc_realloc(void* ptr, size_t size);
+void* __libc_memalign(size_t alignment, size_t size);
+void __libc_free(void* ptr);
+
+void* malloc(size_t size) {
+    if (adikdrum::rtcheck::isAudioThread()) rtTrap("malloc");
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t num, size_t size) {
+    if (adikdrum::rtcheck::isAudioThread()) rtTrap("calloc");
+    return __libc_calloc(num, size);
+}
+
+void* realloc(void* ptr, size_t size) {
+    if (adikdrum::rtcheck::isAudioThread()) rtTrap("realloc");
+    return __libc_realloc(ptr, size);
+}
+
+void free(void* ptr) {
+    if (ptr && adikdrum::rtcheck::isAudioThread()) rtTrap("free");
+    __libc_free(ptr);
+}
+
+// Allocations alignées (AlignedAllocator, operator new aligné): la glibc n'exporte que __libc_memalign,
+// les contrôles des arguments sont donc refaits ici
+void* memalign(size_t alignment, size_t size) {
+    if (adikdrum::rtcheck::isAudioThread()) rtTrap("memalign");
+    return __libc_memalign(alignment, size);
+}
+
+void* aligned_alloc(size_t alignment, size_t size) {
+    if (adikdrum::rtcheck::isAudioThread()) rtTrap("aligned_alloc");
+    if (alignment == 0 || (alignment & (alignment - 1)) != 0) {
+        errno = EINVAL;
+        return nullptr;
+    }
+    return __libc_memalign(alignment, size);
+}
+
+int posix_memalign(void** memptr, size_t alignment, size_t size) {
+    if (adikdrum::rtcheck::isAudioThread()) rtTrap("posix_memalign");
+    if (alignment % sizeof(void*) != 0 || (alignment & (alignment - 1)) != 0 || alignment == 0) return EINVAL;
+    void* ptr = __libc_memalign(alignment, size);
+    if (!ptr) return ENOMEM;
+    *memptr = ptr;
+    return 0;
+}
+} // extern "C"
+#endif // __GLIBC__
+
+// Les opérateurs new/delete globaux sont remplacés dans tous les cas,
+// y compris les versions alignées utilisées par AlignedAllocator.
+void* operator new(size_t size) {
+    if (adikdrum::rtcheck::isAudioThread()) rtTrap("operator new");
+    if (void* ptr = std::malloc(size ? size : 1)) return ptr;
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size) {
+    return ::operator new(size);
+}
+
+void* operator new(size_t size, std::align_val_t align) {
+    if (adikdrum::rtcheck::isAudioThread()) rtTrap("operator new (aligné)");
+    size_t alignment = static_cast<size_t>(align);
+    size = (size + alignment - 1) & ~(alignment - 1);
+    if (void* ptr = std::aligned_alloc(alignment, size ? size : alignment)) return ptr;
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size, std::align_val_t align) {
+    return ::operator new(size, align);
+}
+
+void operator delete(void* ptr) noexcept {
+    if (ptr && adikdrum::rtcheck::isAudioThread()) rtTrap("operator delete");
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+    ::operator delete(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+    ::operator delete(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept {
+    ::operator delete(ptr);
+}
+
+void operator delete(void* ptr, std::align_val_t) noexcept {
+    ::operator delete(ptr);
+}
+
+void operator delete[](void* ptr, std::align_val_t) noexcept {
+    ::operator delete(ptr);
+}
+
+void operator delete(void* ptr, size_t, std::align_val_t) noexcept {
+    ::operator delete(ptr);
+}
+
+void operator delete[](void* ptr, size_t, std::align_val_t) noexcept {
+    ::operator delete(ptr);
+}
+
+#endif // ADIK_RT_ALLOC_CHECK
@@ -0,0 +1,29 @@
+#ifndef RTCHECK_H
+#define RTCHECK_H
+
+// Détection des allocations sur le thread audio.
+// Compilé avec ADIK_RT_ALLOC_CHECK (make RTCHECK=1), tout malloc/free ou new/delete
+// effectué pendant le callback audio affiche un message et arrête le programme.
+// Sans ce flag, ces fonctions ne coûtent qu'une écriture dans une variable thread_local.
+
+namespace adikdrum {
+namespace rtcheck {
+
+// Marque (ou démarque) le thread courant comme thread audio.
+void setAudioThread(bool active);
+bool isAudioThread();
+
+// Active le contrôle pour la durée d'un bloc (par exemple le callback audio).
+class AudioThreadScope {
+public:
+    AudioThreadScope() { setAudioThread(true); }
+    ~AudioThreadScope() { setAudioThread(false); }
+    AudioThreadScope(const AudioThreadScope&) = delete;
+    AudioThreadScope& operator=(const AudioThreadScope&) = delete;
+};
+//==== End of class AudioThreadScope ====
+
+} // namespace rtcheck
+} // namespace adikdrum
+
+#endif // RTCHECK_H
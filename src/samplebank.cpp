@@ -0,0 +1,320 @@
+#include "samplebank.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring> // Pour std::memcmp, std::strncpy
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <thread>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace adikdrum {
+
+namespace {
+
+const char bankMagic[4] = {'A', 'D', 'K', 'B'};
+constexpr uint32_t bankVersion = 2; // 2: int16 à l'échelle 1/32768
+constexpr uint32_t maxBankChannels = 2; // Sons mono ou stéréo
+
+struct BankHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t numEntries;
+    uint32_t sampleRate;
+    uint64_t tocOffset;
+    uint64_t fileSize;
+    uint8_t reserved[32];
+};
+static_assert(sizeof(BankHeader) == 64, "BankHeader doit faire 64 octets");
+
+struct BankEntry {
+    char name[184]; // Terminé par un zéro
+    uint64_t dataOffset;
+    uint64_t numFrames;
+    uint64_t sourceSize;
+    int64_t sourceMtime;
+    int64_t loopStart;
+    int64_t loopEnd;
+    uint32_t numChannels;
+    uint32_t sampleRate;
+    uint32_t format;
+    uint32_t bitDepth;
+    float peak;
+    uint32_t reserved;
+};
+static_assert(sizeof(BankEntry) == 256, "BankEntry doit faire 256 octets");
+
+size_t getSampleSize(SampleBank::Format format) {
+    return format == SampleBank::Format::Int16 ? sizeof(int16_t) : sizeof(float);
+}
+
+uint64_t alignUp(uint64_t value, uint64_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+} // namespace
+
+// Projection du fichier, libérée quand plus aucun son ne la lit
+struct SampleBank::Mapping {
+    void* address = nullptr;
+    size_t size = 0;
+    ~Mapping() {
+        if (address) munmap(address, size);
+    }
+};
+//----------------------------------------
+
+SampleBank::SampleBank() {
+}
+//----------------------------------------
+
+SampleBank::~SampleBank() {
+    close();
+}
+//----------------------------------------
+
+bool SampleBank::open(const std::string& filePath) {
+    close();
+    const int fd = ::open(filePath.c_str(), O_RDONLY);
+    if (fd < 0) {
+        std::cerr << "Erreur: Impossible d'ouvrir la banque de sons: " << filePath << std::endl;
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(BankHeader)) {
+        std::cerr << "Erreur: Banque de sons invalide: " << filePath << std::endl;
+        ::close(fd);
+        return false;
+    }
+    auto mapping = std::make_shared<Mapping>();
+    mapping->size = static_cast<size_t>(st.st_size);
+    void* address = mmap(nullptr, mapping->size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd); // La projection reste valide
+    if (address == MAP_FAILED) {
+        std::cerr << "Erreur: Impossible de projeter la banque de sons: " << filePath << std::endl;
+        return false;
+    }
+    mapping->address = address;
+    // Les sons seront lus en entier dès leur chargement
+    madvise(address, mapping->size, MADV_WILLNEED);
+
+    const auto* bytes = static_cast<const uint8_t*>(address);
+    BankHeader header;
+    std::memcpy(&header, bytes, sizeof(header));
+    if (std::memcmp(header.magic, bankMagic, sizeof(bankMagic)) != 0 || header.version != bankVersion
+            || header.fileSize != mapping->size || header.tocOffset > mapping->size
+            || header.numEntries > (mapping->size - header.tocOffset) / sizeof(BankEntry)) {
+        std::cerr << "Erreur: En-tête de la banque de sons invalide (ou autre version): " << filePath << std::endl;
+        return false;
+    }
+
+    std::vector<Entry> entries;
+    entries.reserve(header.numEntries);
+    for (uint32_t i = 0; i < header.numEntries; ++i) {
+        BankEntry raw;
+        std::memcpy(&raw, bytes + header.tocOffset + i * sizeof(BankEntry), sizeof(raw));
+        raw.name[sizeof(raw.name) - 1] = '\0';
+        const Format format = static_cast<Format>(raw.format);
+        const bool validFormat = format == Format::Float32 || format == Format::Int16;
+        // Taille des données comparée par division: numFrames vient du fichier, le produit pourrait déborder
+        if (!validFormat || raw.numChannels == 0 || raw.numChannels > maxBankChannels
+                || raw.dataOffset % dataAlignment != 0 || raw.dataOffset > mapping->size
+                || raw.numFrames > (mapping->size - raw.dataOffset) / (raw.numChannels * getSampleSize(format))) {
+            std::cerr << "Erreur: Entrée invalide dans la banque de sons: " << raw.name << std::endl;
+            return false;
+        }
+        Entry entry;
+        entry.name = raw.name;
+        entry.numFrames = raw.numFrames;
+        entry.numChannels = raw.numChannels;
+        entry.sampleRate = raw.sampleRate;
+        entry.bitDepth = raw.bitDepth;
+        entry.format = format;
+        entry.loopStart = raw.loopStart;
+        entry.loopEnd = raw.loopEnd;
+        entry.peak = raw.peak;
+        entry.sourceSize = raw.sourceSize;
+        entry.sourceMtime = raw.sourceMtime;
+        entry.data = bytes + raw.dataOffset;
+        entries.push_back(std::move(entry));
+    }
+
+    entries_ = std::move(entries);
+    for (size_t i = 0; i < entries_.size(); ++i) {
+        index_[entries_[i].name] = i;
+    }
+    mapping_ = std::move(mapping);
+    filePath_ = filePath;
+    baseDir_ = std::filesystem::absolute(filePath).lexically_normal().parent_path().string();
+    sampleRate_ = header.sampleRate;
+    return true;
+}
+//----------------------------------------
+
+void SampleBank::close() {
+    mapping_.reset();
+    entries_.clear();
+    index_.clear();
+    filePath_.clear();
+    baseDir_.clear();
+    sampleRate_ = 0;
+}
+//----------------------------------------
+
+size_t SampleBank::getMappedBytes() const {
+    return mapping_ ? mapping_->size : 0;
+}
+//----------------------------------------
+
+const SampleBank::Entry* SampleBank::findEntry(const std::string& name) const {
+    auto it = index_.find(name);
+    return it != index_.end() ? &entries_[it->second] : nullptr;
+}
+//----------------------------------------
+
+std::string SampleBank::getEntryName(const std::string& filePath) const {
+    const auto path = std::filesystem::absolute(filePath).lexically_normal();
+    return path.lexically_relative(baseDir_).generic_string();
+}
+//----------------------------------------
+
+bool SampleBank::getSourceInfo(const std::string& filePath, uint64_t& size, int64_t& mtime) {
+    struct stat st;
+    if (stat(filePath.c_str(), &st) != 0) return false;
+    size = static_cast<uint64_t>(st.st_size);
+    mtime = static_cast<int64_t>(st.st_mtime);
+    return true;
+}
+//----------------------------------------
+
+SoundPtr SampleBank::getSound(const std::string& filePath, size_t sampleRate, SampleStorage storage) const {
+    if (!mapping_) return nullptr;
+    const Entry* entry = findEntry(getEntryName(filePath));
+    if (!entry || entry->sampleRate != sampleRate) return nullptr;
+    uint64_t sourceSize = 0;
+    int64_t sourceMtime = 0;
+    // Fichier source absent: la banque fait foi
+    if (getSourceInfo(filePath, sourceSize, sourceMtime)
+            && (sourceSize != entry->sourceSize || sourceMtime != entry->sourceMtime)) {
+        std::cerr << "Warning: " << filePath << " a changé depuis la construction de la banque, il est rechargé." << std::endl;
+        return nullptr;
+    }
+
+    const size_t numSamples = entry->numFrames * entry->numChannels;
+    SampleBufferPtr buffer;
+    if (entry->format == Format::Float32 || storage == SampleStorage::Compact) {
+        // Lit chaque page dès maintenant: le thread audio ne doit pas attendre le disque
+        const auto* bytes = static_cast<const volatile char*>(entry->data);
+        const size_t numBytes = numSamples * getSampleSize(entry->format);
+        const size_t pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        for (size_t i = 0; i < numBytes; i += pageSize) {
+            (void)bytes[i];
+        }
+        if (entry->format == Format::Float32) {
+            buffer = std::make_shared<const SampleBuffer>(static_cast<const float*>(entry->data), numSamples,
+                    entry->numChannels, entry->sampleRate, mapping_);
+        } else {
+            buffer = std::make_shared<const SampleBuffer>(static_cast<const int16_t*>(entry->data), numSamples,
+                    entry->numChannels, entry->sampleRate, mapping_);
+        }
+    } else {
+        // int16 vers float32: converti dans un buffer à part
+        AlignedVector<float> samples(numSamples);
+        resampler::convertSamples(samples.data(), entry->data, SampleFormat::Int16, 0, numSamples);
+        buffer = std::make_shared<const SampleBuffer>(std::move(samples), entry->numChannels, entry->sampleRate);
+    }
+    numHits_.fetch_add(1, std::memory_order_relaxed);
+    return std::make_shared<AudioSound>(std::move(buffer), entry->bitDepth);
+}
+//----------------------------------------
+
+bool SampleBank::write(const std::string& filePath, const std::vector<Source>& sources, Format format, size_t sampleRate) {
+    BankHeader header{};
+    std::memcpy(header.magic, bankMagic, sizeof(bankMagic));
+    header.version = bankVersion;
+    header.numEntries = static_cast<uint32_t>(sources.size());
+    header.sampleRate = static_cast<uint32_t>(sampleRate);
+    header.tocOffset = sizeof(BankHeader);
+
+    std::vector<BankEntry> toc(sources.size());
+    uint64_t offset = alignUp(header.tocOffset + toc.size() * sizeof(BankEntry), dataAlignment);
+    for (size_t i = 0; i < sources.size(); ++i) {
+        const Source& source = sources[i];
+        BankEntry& raw = toc[i];
+        raw = BankEntry{};
+        if (source.name.size() >= sizeof(raw.name) || source.numChannels == 0 || source.numChannels > maxBankChannels) {
+            std::cerr << "Erreur: Nom trop long, son vide ou de plus de " << maxBankChannels
+                << " canaux pour la banque: " << source.name << std::endl;
+            return false;
+        }
+        std::strncpy(raw.name, source.name.c_str(), sizeof(raw.name) - 1);
+        raw.dataOffset = offset;
+        raw.numFrames = source.numFrames;
+        raw.numChannels = static_cast<uint32_t>(source.numChannels);
+        raw.sampleRate = static_cast<uint32_t>(source.sampleRate);
+        raw.format = static_cast<uint32_t>(format);
+        raw.bitDepth = static_cast<uint32_t>(source.bitDepth);
+        raw.loopStart = source.loopStart;
+        raw.loopEnd = source.loopEnd;
+        const size_t numSamples = source.numFrames * source.numChannels;
+        for (size_t k = 0; k < numSamples; ++k) {
+            raw.peak = std::max(raw.peak, std::fabs(source.data[k]));
+        }
+        getSourceInfo(source.filePath, raw.sourceSize, raw.sourceMtime);
+        offset = alignUp(offset + numSamples * getSampleSize(format), dataAlignment);
+    }
+    header.fileSize = offset;
+
+    // Écrite à côté, puis renommée: un moteur qui la projette ne voit jamais une banque à moitié écrite
+    const std::string tmpPath = filePath + ".tmp" + std::to_string(std::hash<std::thread::id>{}(std::this_thread::get_id()));
+    std::error_code ec;
+    {
+        std::ofstream file(tmpPath, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(toc.data()), toc.size() * sizeof(BankEntry));
+        const char padding[dataAlignment] = {};
+        std::vector<int16_t> pcm16;
+        for (size_t i = 0; i < sources.size() && file; ++i) {
+            file.write(padding, toc[i].dataOffset - static_cast<uint64_t>(file.tellp()));
+            const Source& source = sources[i];
+            const size_t numSamples = source.numFrames * source.numChannels;
+            if (format == Format::Float32) {
+                file.write(reinterpret_cast<const char*>(source.data), numSamples * sizeof(float));
+            } else {
+                pcm16.resize(numSamples);
+                for (size_t k = 0; k < numSamples; ++k) {
+                    // Échelle de libsndfile: un son 16 bits est écrit à l'identique
+                    pcm16[k] = static_cast<int16_t>(std::clamp(std::lrint(source.data[k] * 32768.0f), -32768L, 32767L));
+                }
+                file.write(reinterpret_cast<const char*>(pcm16.data()), numSamples * sizeof(int16_t));
+            }
+        }
+        if (file) {
+            file.write(padding, header.fileSize - static_cast<uint64_t>(file.tellp()));
+        }
+        if (!file) {
+            std::cerr << "Erreur: Impossible d'écrire la banque de sons: " << tmpPath << std::endl;
+            file.close();
+            std::filesystem::remove(tmpPath, ec);
+            return false;
+        }
+    }
+    std::filesystem::rename(tmpPath, filePath, ec);
+    if (ec) {
+        std::cerr << "Erreur: Impossible de renommer la banque de sons: " << filePath << " - " << ec.message() << std::endl;
+        std::filesystem::remove(tmpPath, ec);
+        return false;
+    }
+    return true;
+}
+//----------------------------------------
+
+//==== End of class SampleBank ====
+
+} // namespace adikdrum
@@ -0,0 +1,105 @@
+#ifndef SAMPLEBANK_H
+#define SAMPLEBANK_H
+
+#include "audiosound.h"
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <cstddef> // Pour size_t
+#include <cstdint>
+
+namespace adikdrum {
+
+// Banque de sons précompilée (fichier .adkbank, construit par l'outil adikbank).
+// Les sons y sont déjà décodés et convertis à la fréquence de la banque: le chargement
+// ne passe plus par libsndfile. Le fichier est projeté en mémoire (mmap) et les SampleBuffer
+// des sons en float32 pointent directement dans la projection: pas de copie, et les pages
+// sont partagées entre les processus par le cache du système.
+//
+// Format (little-endian):
+// - en-tête (magic ADKB, version, nombre d'entrées, fréquence, position de la table);
+// - table des entrées: nom, position et longueur des données, canaux, fréquence, format,
+//   points de boucle, crête, taille et date du fichier source;
+// - données PCM entrelacées (float32 ou int16 à l'échelle 1/32768, comme libsndfile),
+//   chacune alignée sur 64 octets.
+// Les noms sont les chemins des fichiers source, relatifs au répertoire de la banque.
+class SampleBank {
+public:
+    enum class Format : uint32_t { Float32 = 0, Int16 = 1 };
+    static constexpr size_t dataAlignment = CACHE_LINE_SIZE;
+
+    struct Entry {
+        std::string name;
+        size_t numFrames = 0;
+        size_t numChannels = 1;
+        size_t sampleRate = 0;
+        size_t bitDepth = 16;   // Du fichier source
+        Format format = Format::Float32;
+        int64_t loopStart = -1; // En frames, -1: pas de boucle
+        int64_t loopEnd = -1;
+        float peak = 0.0f;      // Crête absolue
+        uint64_t sourceSize = 0;
+        int64_t sourceMtime = 0;
+        const void* data = nullptr; // Dans la projection
+    };
+
+    // Son à écrire dans une banque (outil adikbank)
+    struct Source {
+        std::string name;
+        const float* data = nullptr;
+        size_t numFrames = 0;
+        size_t numChannels = 1;
+        size_t sampleRate = 0;
+        size_t bitDepth = 16;
+        int64_t loopStart = -1;
+        int64_t loopEnd = -1;
+        std::string filePath; // Fichier source, pour sa taille et sa date
+    };
+
+    SampleBank();
+    ~SampleBank();
+    SampleBank(const SampleBank&) = delete;
+    SampleBank& operator=(const SampleBank&) = delete;
+
+    // Projette la banque en mémoire et vérifie sa table; à faire avant le chargement des sons
+    bool open(const std::string& filePath);
+    // Les sons déjà créés gardent la projection jusqu'à leur libération
+    void close();
+    bool isOpen() const { return mapping_ != nullptr; }
+    const std::string& getFilePath() const { return filePath_; }
+    size_t getNumEntries() const { return entries_.size(); }
+    size_t getSampleRate() const { return sampleRate_; }
+    size_t getMappedBytes() const;
+
+    const Entry* findEntry(const std::string& name) const;
+    // Son du fichier filePath, s'il est dans la banque à la fréquence sampleRate et à jour
+    // (même taille et même date que le fichier source); nullptr sinon.
+    // Stockage compact: les sons en int16 sont lus dans la projection, sans conversion.
+    // Thread-safe: appelée par les threads de chargement.
+    SoundPtr getSound(const std::string& filePath, size_t sampleRate,
+            SampleStorage storage = SampleStorage::Float32) const;
+    size_t getNumHits() const { return numHits_.load(std::memory_order_relaxed); }
+
+    static bool write(const std::string& filePath, const std::vector<Source>& sources, Format format, size_t sampleRate);
+
+private:
+    struct Mapping;
+    std::shared_ptr<const Mapping> mapping_; // Partagée avec les SampleBuffer des sons
+    std::string filePath_;
+    std::string baseDir_;
+    size_t sampleRate_ = 0;
+    std::vector<Entry> entries_;
+    std::unordered_map<std::string, size_t> index_;
+    mutable std::atomic<size_t> numHits_{0};
+
+    std::string getEntryName(const std::string& filePath) const;
+    static bool getSourceInfo(const std::string& filePath, uint64_t& size, int64_t& mtime);
+};
+//==== End of class SampleBank ====
+
+} // namespace adikdrum
+
+#endif // SAMPLEBANK_H
@@ -0,0 +1,151 @@
+#include "samplebuffer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+namespace adikdrum {
+
+const char* getSampleStorageName(SampleStorage storage) {
+    return storage == SampleStorage::Compact ? "compact" : "float32";
+}
+//----------------------------------------
+
+bool parseSampleStorage(const std::string& name, SampleStorage& storage) {
+    if (name == "float32" || name == "float") {
+        storage = SampleStorage::Float32;
+    } else if (name == "compact") {
+        storage = SampleStorage::Compact;
+    } else {
+        return false;
+    }
+    return true;
+}
+//----------------------------------------
+
+namespace {
+
+// Vrai si chaque échantillon, multiplié par scale, est un entier de [-scale, scale - 1]:
+// c'est le cas des fichiers PCM relus par libsndfile, pas des sons convertis ou modifiés
+bool fitsInteger(const float* data, size_t numSamples, float scale) {
+    for (size_t i = 0; i < numSamples; ++i) {
+        const float x = data[i] * scale;
+        if (x != std::nearbyint(x) || x < -scale || x > scale - 1.0f) return false;
+    }
+    return true;
+}
+//----------------------------------------
+
+template <typename T>
+AlignedVector<T> toInteger(const float* data, size_t numSamples, float scale) {
+    AlignedVector<T> out(numSamples);
+    for (size_t i = 0; i < numSamples; ++i) {
+        out[i] = static_cast<T>(data[i] * scale);
+    }
+    return out;
+}
+//----------------------------------------
+
+} // namespace
+
+SampleBuffer::SampleBuffer(AlignedVector<float> data, size_t numChannels, size_t sampleRate)
+    : data_(std::move(data)),
+      samples_(data_.data()),
+      numSamples_(data_.size()),
+      numChannels_(numChannels),
+      numFrames_(numChannels > 0 ? numSamples_ / numChannels : 0),
+      sampleRate_(sampleRate),
+      totalFrames_(numFrames_) {
+}
+//----------------------------------------
+
+SampleBuffer::SampleBuffer(const float* data, size_t numSamples, size_t numChannels, size_t sampleRate)
+    : SampleBuffer(AlignedVector<float>(data, data + numSamples), numChannels, sampleRate) {
+}
+//----------------------------------------
+
+SampleBuffer::SampleBuffer(AlignedVector<float> data, size_t numChannels, size_t sampleRate,
+        const StreamSource* stream, size_t totalFrames)
+    : SampleBuffer(std::move(data), numChannels, sampleRate) {
+    stream_ = stream;
+    totalFrames_ = stream ? std::max(totalFrames, numFrames_) : numFrames_;
+}
+//----------------------------------------
+
+SampleBuffer::SampleBuffer(const float* data, size_t numSamples, size_t numChannels, size_t sampleRate,
+        std::shared_ptr<const void> owner)
+    : owner_(std::move(owner)),
+      samples_(data),
+      numSamples_(numSamples),
+      numChannels_(numChannels),
+      numFrames_(numChannels > 0 ? numSamples / numChannels : 0),
+      sampleRate_(sampleRate),
+      totalFrames_(numFrames_) {
+}
+//----------------------------------------
+
+SampleBuffer::SampleBuffer(AlignedVector<int16_t> data, size_t numChannels, size_t sampleRate)
+    : data16_(std::move(data)),
+      samples_(data16_.data()),
+      format_(SampleFormat::Int16),
+      numSamples_(data16_.size()),
+      numChannels_(numChannels),
+      numFrames_(numChannels > 0 ? numSamples_ / numChannels : 0),
+      sampleRate_(sampleRate),
+      totalFrames_(numFrames_) {
+}
+//----------------------------------------
+
+SampleBuffer::SampleBuffer(AlignedVector<int32_t> data, size_t numChannels, size_t sampleRate)
+    : data24_(std::move(data)),
+      samples_(data24_.data()),
+      format_(SampleFormat::Int24),
+      numSamples_(data24_.size()),
+      numChannels_(numChannels),
+      numFrames_(numChannels > 0 ? numSamples_ / numChannels : 0),
+      sampleRate_(sampleRate),
+      totalFrames_(numFrames_) {
+}
+//----------------------------------------
+
+SampleBuffer::SampleBuffer(const int16_t* data, size_t numSamples, size_t numChannels, size_t sampleRate,
+        std::shared_ptr<const void> owner)
+    : owner_(std::move(owner)),
+      samples_(data),
+      format_(SampleFormat::Int16),
+      numSamples_(numSamples),
+      numChannels_(numChannels),
+      numFrames_(numChannels > 0 ? numSamples / numChannels : 0),
+      sampleRate_(sampleRate),
+      totalFrames_(numFrames_) {
+}
+//----------------------------------------
+
+std::shared_ptr<const SampleBuffer> SampleBuffer::makeCompact(const SampleBuffer& src) {
+    const float* data = src.getData();
+    if (!data || src.isStreamed() || src.numSamples_ == 0) return nullptr;
+    constexpr float int16Scale = 32768.0f;
+    constexpr float int24Scale = 8388608.0f;
+    if (fitsInteger(data, src.numSamples_, int16Scale)) {
+        return std::make_shared<const SampleBuffer>(toInteger<int16_t>(data, src.numSamples_, int16Scale),
+                src.numChannels_, src.sampleRate_);
+    }
+    if (fitsInteger(data, src.numSamples_, int24Scale)) {
+        return std::make_shared<const SampleBuffer>(toInteger<int32_t>(data, src.numSamples_, int24Scale),
+                src.numChannels_, src.sampleRate_);
+    }
+    return nullptr;
+}
+//----------------------------------------
+
+std::shared_ptr<const SampleBuffer> SampleBuffer::makeFloat(const SampleBuffer& src) {
+    if (src.format_ == SampleFormat::Float32) return nullptr;
+    AlignedVector<float> data(src.numSamples_);
+    src.copySamples(data.data(), 0, src.numSamples_);
+    return std::make_shared<const SampleBuffer>(std::move(data), src.numChannels_, src.sampleRate_);
+}
+//----------------------------------------
+
+//==== End of class SampleBuffer ====
+
+} // namespace adikdrum
@@ -0,0 +1,102 @@
+#ifndef SAMPLEBUFFER_H
+#define SAMPLEBUFFER_H
+
+#include "alignedbuffer.h"
+#include "resampler.h"
+
+#include <memory>
+#include <string>
+#include <cstddef> // Pour size_t
+#include <cstdint>
+
+namespace adikdrum {
+
+struct StreamSource; // diskstreamer.h
+
+using resampler::SampleFormat;
+
+// Stockage des sons d'un kit: tout en float32, ou compact (int16, ou 24 bits dans un int32,
+// quand les échantillons y tiennent sans perte: sons 16 et 24 bits lus à la fréquence du moteur).
+enum class SampleStorage { Float32, Compact };
+const char* getSampleStorageName(SampleStorage storage);
+// "float32" ou "compact"; renvoie false si le nom est inconnu
+bool parseSampleStorage(const std::string& name, SampleStorage& storage);
+
+// Données d'un son, entrelacées, alignées sur une ligne de cache: en float, ou en entiers (SampleFormat)
+// convertis à la lecture, dans les noyaux du resampler.
+// Immuables après la construction: plusieurs voix peuvent les lire en même temps,
+// chacune avec sa propre position (VoiceState), sans verrou.
+class SampleBuffer {
+public:
+    // Reprend data sans copie (décodage ou conversion faits directement dans un buffer aligné)
+    SampleBuffer(AlignedVector<float> data, size_t numChannels, size_t sampleRate);
+    SampleBuffer(const float* data, size_t numSamples, size_t numChannels, size_t sampleRate);
+    // Son lu en continu: data ne contient que la tête, la suite est lue dans stream (DiskStreamer)
+    SampleBuffer(AlignedVector<float> data, size_t numChannels, size_t sampleRate,
+            const StreamSource* stream, size_t totalFrames);
+    // Données externes, non copiées (banque projetée en mémoire): owner les garde valides
+    SampleBuffer(const float* data, size_t numSamples, size_t numChannels, size_t sampleRate,
+            std::shared_ptr<const void> owner);
+    // Données en entiers: int16, ou 24 bits dans un int32
+    SampleBuffer(AlignedVector<int16_t> data, size_t numChannels, size_t sampleRate);
+    SampleBuffer(AlignedVector<int32_t> data, size_t numChannels, size_t sampleRate);
+    SampleBuffer(const int16_t* data, size_t numSamples, size_t numChannels, size_t sampleRate,
+            std::shared_ptr<const void> owner);
+
+    // Copie de src dans le plus petit format qui garde ses échantillons à l'identique;
+    // nullptr s'il n'y en a pas de plus petit (ou si src est lu en continu).
+    static std::shared_ptr<const SampleBuffer> makeCompact(const SampleBuffer& src);
+    // Copie de src en float; nullptr s'il l'est déjà
+    static std::shared_ptr<const SampleBuffer> makeFloat(const SampleBuffer& src);
+
+    // Données en float; nullptr pour les autres formats (voir copySamples)
+    const float* getData() const {
+        return format_ == SampleFormat::Float32 ? static_cast<const float*>(samples_) : nullptr;
+    }
+    SampleFormat getFormat() const { return format_; }
+    size_t getNumSamples() const { return numSamples_; }
+    // Taille en mémoire des données
+    size_t getNumBytes() const { return numSamples_ * resampler::getSampleFormatSize(format_); }
+    // Copie count échantillons à partir de offset, convertis en float
+    void copySamples(float* out, size_t offset, size_t count) const {
+        resampler::convertSamples(out, samples_, format_, offset, count);
+    }
+    // Données hors du tas (projection): rien à libérer pour ce buffer lui-même
+    bool isExternal() const { return owner_ != nullptr; }
+    size_t getNumFrames() const { return numFrames_; }
+    size_t getNumChannels() const { return numChannels_; }
+    size_t getSampleRate() const { return sampleRate_; }
+    bool isStreamed() const { return stream_ != nullptr; }
+    const StreamSource* getStreamSource() const { return stream_; }
+    // Longueur du son, y compris la partie lue en continu
+    size_t getTotalFrames() const { return totalFrames_; }
+
+    // Lit au plus numFrames frames à partir de phase (position en virgule fixe 32.32),
+    // avancée de increment par frame lue. Renvoie le nombre de frames lues.
+    size_t readFrames(float* bufData, size_t numFrames, uint64_t& phase, uint64_t increment,
+            resampler::Interpolation interp = resampler::Interpolation::Linear) const {
+        return resampler::process(bufData, numFrames, samples_, format_, numFrames_, numChannels_, phase, increment, interp);
+    }
+
+private:
+    // Un seul des trois est utilisé, selon format_; vides pour des données externes
+    AlignedVector<float> data_;
+    AlignedVector<int16_t> data16_;
+    AlignedVector<int32_t> data24_;
+    std::shared_ptr<const void> owner_;
+    const void* samples_;
+    SampleFormat format_ = SampleFormat::Float32;
+    size_t numSamples_;
+    size_t numChannels_;
+    size_t numFrames_;
+    size_t sampleRate_;
+    const StreamSource* stream_ = nullptr; // Possédé par le DiskStreamer
+    size_t totalFrames_;
+};
+//==== End of class SampleBuffer ====
+
+using SampleBufferPtr = std::shared_ptr<const SampleBuffer>;
+
+} // namespace adikdrum
+
+#endif // SAMPLEBUFFER_H
@@ -0,0 +1,149 @@
+#include "samplecache.h"
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <filesystem>
+#include <functional>
+#include <thread>
+#include <cstring> // Pour std::memcmp
+#include <algorithm>
+
+namespace adikdrum {
+
+namespace {
+
+const char cacheMagic[4] = {'A', 'D', 'K', 'S'};
+constexpr uint32_t maxCacheChannels = 2; // Sons mono ou stéréo, comme la banque de sons
+
+struct CacheHeader {
+    char magic[4];
+    uint32_t version;
+    uint64_t fileHash;
+    uint32_t sampleRate;
+    uint32_t numChannels;
+    uint64_t numFrames;
+};
+
+} // namespace
+
+SampleCache::SampleCache(const std::string& dirPath)
+    : dirPath_(dirPath) {
+}
+//----------------------------------------
+
+bool SampleCache::hashFile(const std::string& filePath, uint64_t& hash) {
+    std::ifstream file(filePath, std::ios::binary);
+    if (!file) return false;
+    // FNV-1a 64 bits
+    hash = 14695981039346656037ULL;
+    char buf[65536];
+    while (file) {
+        file.read(buf, sizeof(buf));
+        const std::streamsize count = file.gcount();
+        for (std::streamsize i = 0; i < count; ++i) {
+            hash ^= static_cast<unsigned char>(buf[i]);
+            hash *= 1099511628211ULL;
+        }
+    }
+    return file.eof();
+}
+//----------------------------------------
+
+std::string SampleCache::getEntryPath(uint64_t fileHash, size_t sampleRate) const {
+    std::ostringstream oss;
+    oss << dirPath_ << "/" << std::hex << std::setw(16) << std::setfill('0') << fileHash
+        << std::dec << "_" << sampleRate << ".raw";
+    return oss.str();
+}
+//----------------------------------------
+
+size_t SampleCache::getDataOffset() {
+    return sizeof(CacheHeader);
+}
+//----------------------------------------
+
+bool SampleCache::read(uint64_t fileHash, size_t sampleRate, AlignedVector<float>& data, size_t& numChannels,
+        size_t maxFrames, size_t* numFrames) {
+    if (!isEnabled()) return false;
+    const std::string entryPath = getEntryPath(fileHash, sampleRate);
+    std::error_code ec;
+    const uintmax_t fileSize = std::filesystem::file_size(entryPath, ec);
+    std::ifstream file(entryPath, std::ios::binary);
+    if (ec || !file) {
+        numMisses_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    CacheHeader header;
+    file.read(reinterpret_cast<char*>(&header), sizeof(header));
+    if (!file || std::memcmp(header.magic, cacheMagic, sizeof(cacheMagic)) != 0
+            || header.version != formatVersion || header.fileHash != fileHash
+            || header.sampleRate != sampleRate || header.numChannels == 0 || header.numChannels > maxCacheChannels
+            || fileSize < sizeof(header)
+            // Par division: numFrames vient du fichier, le produit pourrait déborder
+            || header.numFrames > (fileSize - sizeof(header)) / (header.numChannels * sizeof(float))) {
+        // Entrée d'une autre version, tronquée ou corrompue: elle sera réécrite
+        numMisses_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    const size_t framesToRead = static_cast<size_t>(std::min<uint64_t>(header.numFrames, maxFrames));
+    AlignedVector<float> samples(framesToRead * header.numChannels);
+    file.read(reinterpret_cast<char*>(samples.data()), samples.size() * sizeof(float));
+    if (static_cast<size_t>(file.gcount()) != samples.size() * sizeof(float)) {
+        numMisses_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    data = std::move(samples);
+    numChannels = header.numChannels;
+    if (numFrames) *numFrames = header.numFrames;
+    numHits_.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+//----------------------------------------
+
+bool SampleCache::write(uint64_t fileHash, size_t sampleRate, const AlignedVector<float>& data, size_t numChannels) {
+    if (!isEnabled() || numChannels == 0 || numChannels > maxCacheChannels) return false;
+    std::error_code ec;
+    std::filesystem::create_directories(dirPath_, ec);
+    if (ec) {
+        std::cerr << "Erreur: Impossible de créer le répertoire du cache: " << dirPath_ << " - " << ec.message() << std::endl;
+        return false;
+    }
+
+    const std::string entryPath = getEntryPath(fileHash, sampleRate);
+    // Nom temporaire propre au thread: un lecteur ne voit jamais une entrée à moitié écrite
+    const std::string tmpPath = entryPath + ".tmp" + std::to_string(std::hash<std::thread::id>{}(std::this_thread::get_id()));
+    {
+        std::ofstream file(tmpPath, std::ios::binary | std::ios::trunc);
+        CacheHeader header;
+        std::memcpy(header.magic, cacheMagic, sizeof(cacheMagic));
+        header.version = formatVersion;
+        header.fileHash = fileHash;
+        header.sampleRate = static_cast<uint32_t>(sampleRate);
+        header.numChannels = static_cast<uint32_t>(numChannels);
+        header.numFrames = data.size() / numChannels;
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(data.data()), header.numFrames * numChannels * sizeof(float));
+        if (!file) {
+            std::cerr << "Erreur: Impossible d'écrire dans le cache: " << tmpPath << std::endl;
+            file.close();
+            std::filesystem::remove(tmpPath, ec);
+            return false;
+        }
+    }
+    std::filesystem::rename(tmpPath, entryPath, ec);
+    if (ec) {
+        std::cerr << "Erreur: Impossible de renommer l'entrée du cache: " << entryPath << " - " << ec.message() << std::endl;
+        std::filesystem::remove(tmpPath, ec);
+        return false;
+    }
+    return true;
+}
+//----------------------------------------
+
+//==== End of class SampleCache ====
+
+} // namespace adikdrum
@@ -0,0 +1,57 @@
+#ifndef SAMPLECACHE_H
+#define SAMPLECACHE_H
+
+#include <string>
+#include <vector>
+#include <atomic>
+#include <cstddef> // Pour size_t
+#include <cstdint>
+
+#include "alignedbuffer.h"
+
+namespace adikdrum {
+
+// Cache disque des sons convertis à la fréquence du moteur audio.
+// Un son dont la fréquence diffère de celle du moteur est converti une seule fois
+// (resampler::convertRate), puis relu tel quel aux lancements suivants.
+// Clé: empreinte du contenu du fichier source (FNV-1a 64 bits) et fréquence cible;
+// un fichier modifié change donc de clé, sans invalidation à gérer.
+// Format: en-tête (magic, version, empreinte, fréquence, canaux, frames), puis les floats entrelacés.
+// Thread-safe: chaque entrée est écrite dans un fichier temporaire, puis renommée.
+class SampleCache {
+public:
+    explicit SampleCache(const std::string& dirPath);
+
+    // Répertoire vide: cache désactivé (conversion à chaque chargement)
+    const std::string& getDirPath() const { return dirPath_; }
+    void setDirPath(const std::string& dirPath) { dirPath_ = dirPath; }
+    bool isEnabled() const { return !dirPath_.empty(); }
+
+    // Empreinte du contenu d'un fichier; renvoie false si le fichier ne peut être lu
+    static bool hashFile(const std::string& filePath, uint64_t& hash);
+    std::string getEntryPath(uint64_t fileHash, size_t sampleRate) const;
+    // Position des données dans une entrée, en octets (lecture en continu, DiskStreamer)
+    static size_t getDataOffset();
+
+    // Lit une entrée, ou ses maxFrames premières frames (numFrames: longueur totale de l'entrée);
+    // renvoie false si elle est absente ou invalide
+    // Les données sont lues directement dans le buffer aligné repris ensuite par SampleBuffer.
+    bool read(uint64_t fileHash, size_t sampleRate, AlignedVector<float>& data, size_t& numChannels,
+            size_t maxFrames = SIZE_MAX, size_t* numFrames = nullptr);
+    // Sons mono ou stéréo seulement: les autres ne sont pas mis en cache
+    bool write(uint64_t fileHash, size_t sampleRate, const AlignedVector<float>& data, size_t numChannels);
+
+    size_t getNumHits() const { return numHits_.load(std::memory_order_relaxed); }
+    size_t getNumMisses() const { return numMisses_.load(std::memory_order_relaxed); }
+
+private:
+    static constexpr uint32_t formatVersion = 1;
+    std::string dirPath_;
+    std::atomic<size_t> numHits_{0};
+    std::atomic<size_t> numMisses_{0};
+};
+//==== End of class SampleCache ====
+
+} // namespace adikdrum
+
+#endif // SAMPLECACHE_H
@@ -0,0 +1,150 @@
+#include "sampleloader.h"
+#include "memusage.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+
+namespace adikdrum {
+
+SampleLoader::SampleLoader(size_t numThreads)
+    : maxThreads_(numThreads) {
+    if (maxThreads_ == 0) {
+        maxThreads_ = std::max(1u, std::thread::hardware_concurrency());
+    }
+}
+//----------------------------------------
+
+SampleLoader::~SampleLoader() {
+    cancel();
+}
+//----------------------------------------
+
+bool SampleLoader::start(const std::vector<std::string>& filePaths, LoadFunc loadFunc) {
+    if (!loadFunc) return false;
+    if (isLoading()) {
+        std::cerr << "Erreur: Un chargement de sons est déjà en cours." << std::endl;
+        return false;
+    }
+    join();
+
+    filePaths_ = filePaths;
+    loadFunc_ = std::move(loadFunc);
+    numTotal_ = filePaths_.size();
+    nextIndex_.store(0, std::memory_order_relaxed);
+    cancelled_.store(false, std::memory_order_relaxed);
+    numDone_.store(0, std::memory_order_relaxed);
+    numFailed_.store(0, std::memory_order_relaxed);
+    loadedBytes_.store(0, std::memory_order_relaxed);
+    const size_t numThreads = std::min(maxThreads_, numTotal_);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        done_.assign(numTotal_, false);
+        numFirstDone_ = 0;
+        numRunning_ = numThreads;
+        ready_.clear();
+        startTime_ = std::chrono::steady_clock::now();
+        endTime_ = startTime_;
+        startRssKb_ = memusage::getCurrentRssKb();
+        endPeakRssKb_ = startRssKb_;
+    }
+    for (size_t i = 0; i < numThreads; ++i) {
+        workers_.emplace_back(&SampleLoader::workerLoop, this);
+    }
+    return true;
+}
+//----------------------------------------
+
+void SampleLoader::waitFor(size_t count) {
+    count = std::min(count, numTotal_);
+    std::unique_lock<std::mutex> lock(mutex_);
+    doneCond_.wait(lock, [this, count] { return numFirstDone_ >= count || numRunning_ == 0; });
+}
+//----------------------------------------
+
+void SampleLoader::cancel() {
+    cancelled_.store(true, std::memory_order_relaxed);
+    join();
+}
+//----------------------------------------
+
+void SampleLoader::join() {
+    for (auto& worker : workers_) {
+        worker.join();
+    }
+    workers_.clear();
+}
+//----------------------------------------
+
+size_t SampleLoader::takeLoaded(std::vector<std::pair<size_t, SoundPtr>>& loaded) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const size_t count = ready_.size();
+    std::move(ready_.begin(), ready_.end(), std::back_inserter(loaded));
+    ready_.clear();
+    return count;
+}
+//----------------------------------------
+
+double SampleLoader::getElapsedMs() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const auto endTime = isLoading() ? std::chrono::steady_clock::now() : endTime_;
+    return std::chrono::duration<double, std::milli>(endTime - startTime_).count();
+}
+//----------------------------------------
+
+size_t SampleLoader::getPeakRssGrowthKb() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const size_t peakKb = isLoading() ? memusage::getPeakRssKb() : endPeakRssKb_;
+    return peakKb > startRssKb_ ? peakKb - startRssKb_ : 0;
+}
+//----------------------------------------
+
+double SampleLoader::getPeakRssRatio() const {
+    const size_t numBytes = getLoadedBytes();
+    return numBytes > 0 ? getPeakRssGrowthKb() * 1024.0 / numBytes : 0.0;
+}
+//----------------------------------------
+
+std::string SampleLoader::getMemoryReport() const {
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(2)
+        << "Mémoire: " << getLoadedBytes() / 1024 << " Ko de sons, pic +" << getPeakRssGrowthKb()
+        << " Ko (" << getPeakRssRatio() << "x)";
+    return oss.str();
+}
+//----------------------------------------
+
+void SampleLoader::workerLoop() {
+    while (!cancelled_.load(std::memory_order_relaxed)) {
+        const size_t index = nextIndex_.fetch_add(1, std::memory_order_relaxed);
+        if (index >= numTotal_) break;
+        SoundPtr sound = loadFunc_(filePaths_[index]);
+        if (sound && sound->getLength() == 0) sound = nullptr;
+        if (!sound) {
+            numFailed_.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            loadedBytes_.fetch_add(sound->getNumBytes(), std::memory_order_relaxed);
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        done_[index] = true;
+        while (numFirstDone_ < numTotal_ && done_[numFirstDone_]) ++numFirstDone_;
+        ready_.emplace_back(index, std::move(sound));
+        if (numDone_.fetch_add(1, std::memory_order_release) + 1 == numTotal_) {
+            endTime_ = std::chrono::steady_clock::now();
+            endPeakRssKb_ = memusage::getPeakRssKb();
+        }
+        doneCond_.notify_all();
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    --numRunning_;
+    doneCond_.notify_all();
+}
+//----------------------------------------
+
+//==== End of class SampleLoader ====
+
+} // namespace adikdrum
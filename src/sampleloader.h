@@ -0,0 +1,95 @@
+#ifndef SAMPLELOADER_H
+#define SAMPLELOADER_H
+
+#include "audiosound.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <cstddef> // Pour size_t
+
+namespace adikdrum {
+
+// Chargement des sons en parallèle, par une réserve de threads.
+// Les fichiers sont pris dans l'ordre de la liste: les premiers pads sont prêts les premiers,
+// et le flux audio peut démarrer sans attendre la fin du kit (waitFor).
+// Les sons chargés sont récupérés par un seul thread (UI), avec takeLoaded():
+// c'est lui qui les transmet ensuite au thread audio.
+class SampleLoader {
+public:
+    using LoadFunc = std::function<SoundPtr(const std::string& filePath)>;
+
+    explicit SampleLoader(size_t numThreads = 0); // 0: un thread par cœur
+    ~SampleLoader();
+    SampleLoader(const SampleLoader&) = delete;
+    SampleLoader& operator=(const SampleLoader&) = delete;
+
+    // Lance le chargement; l'index de chaque son est sa position dans filePaths.
+    // loadFunc est appelée en même temps par plusieurs threads.
+    bool start(const std::vector<std::string>& filePaths, LoadFunc loadFunc);
+    // Attend que les count premiers sons soient chargés (ou en échec)
+    void waitFor(size_t count);
+    void wait() { waitFor(numTotal_); }
+    // Abandonne les fichiers pas encore commencés, et attend la fin des threads
+    void cancel();
+
+    // Ajoute à loaded les sons chargés depuis le dernier appel: (index, son), son nul en cas d'échec.
+    // Renvoie le nombre de sons ajoutés.
+    size_t takeLoaded(std::vector<std::pair<size_t, SoundPtr>>& loaded);
+
+    bool isLoading() const { return getNumDone() < numTotal_ && !cancelled_.load(std::memory_order_relaxed); }
+    size_t getNumDone() const { return numDone_.load(std::memory_order_acquire); }
+    size_t getNumFailed() const { return numFailed_.load(std::memory_order_relaxed); }
+    size_t getNumTotal() const { return numTotal_; }
+    size_t getNumThreads() const { return workers_.size(); }
+    // Durée du chargement complet (ou en cours)
+    double getElapsedMs() const;
+    // Taille des données des sons chargés, en octets
+    size_t getLoadedBytes() const { return loadedBytes_.load(std::memory_order_relaxed); }
+    // Hausse du pic de mémoire résidente pendant le chargement, en Ko (mesurée à la fin).
+    // Le pic du processus ne redescend jamais: c'est une borne supérieure si un pic plus haut
+    // a eu lieu avant le chargement.
+    size_t getPeakRssGrowthKb() const;
+    // Hausse du pic rapportée à la taille des sons: 1 si les données ne sont jamais copiées
+    double getPeakRssRatio() const;
+    // Taille des sons, hausse du pic et rapport, pour l'affichage
+    std::string getMemoryReport() const;
+
+private:
+    size_t maxThreads_;
+    std::vector<std::thread> workers_;
+    std::vector<std::string> filePaths_;
+    LoadFunc loadFunc_;
+    size_t numTotal_ = 0;
+    std::atomic<size_t> nextIndex_{0};
+    std::atomic<bool> cancelled_{false};
+
+    mutable std::mutex mutex_; // Protège les membres suivants
+    std::condition_variable doneCond_;
+    std::vector<bool> done_;
+    size_t numFirstDone_ = 0; // Les numFirstDone_ premiers sons sont tous chargés
+    size_t numRunning_ = 0;   // Threads pas encore terminés
+    std::vector<std::pair<size_t, SoundPtr>> ready_; // Pas encore récupérés par takeLoaded
+    std::chrono::steady_clock::time_point startTime_;
+    std::chrono::steady_clock::time_point endTime_;
+    size_t startRssKb_ = 0;
+    size_t endPeakRssKb_ = 0;
+
+    std::atomic<size_t> numDone_{0};
+    std::atomic<size_t> numFailed_{0};
+    std::atomic<size_t> loadedBytes_{0};
+
+    void workerLoop();
+    void join();
+};
+//==== End of class SampleLoader ====
+
+} // namespace adikdrum
+
+#endif // SAMPLELOADER_H
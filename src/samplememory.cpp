@@ -0,0 +1,299 @@
+#include "samplememory.h"
+#include "audiomixer.h"
+#include "audiofile.h"
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+namespace adikdrum {
+
+SampleMemoryManager::SampleMemoryManager(AudioMixer& mixer)
+    : mixer_(mixer) {}
+//----------------------------------------
+
+SampleMemoryManager::~SampleMemoryManager() {
+    stop();
+}
+//----------------------------------------
+
+void SampleMemoryManager::addSound(const SoundPtr& sound, const std::string& filePath) {
+    if (!sound) return;
+    const SampleBufferPtr buffer = sound->getSampleBuffer();
+    // Rien à évincer: la mémoire n'est pas celle du processus, ou seule la tête est chargée
+    if (!buffer || buffer->isExternal() || buffer->isStreamed()) return;
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& entry : entries_) {
+        if (entry.sound == sound) return;
+    }
+    Entry entry;
+    entry.sound = sound;
+    entry.filePath = filePath;
+    entries_.push_back(std::move(entry));
+    updateResidentBytes();
+}
+//----------------------------------------
+
+void SampleMemoryManager::removeSound(const SoundPtr& sound) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    entries_.erase(std::remove_if(entries_.begin(), entries_.end(),
+                [&sound](const Entry& entry) { return entry.sound == sound; }), entries_.end());
+    updateResidentBytes();
+}
+//----------------------------------------
+
+void SampleMemoryManager::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    entries_.clear();
+    updateResidentBytes();
+}
+//----------------------------------------
+
+size_t SampleMemoryManager::convertSounds(const std::vector<SoundPtr>& sounds, SampleStorage storage) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_t numConverted = 0;
+    for (const auto& sound : sounds) {
+        if (!sound) continue;
+        auto it = std::find_if(entries_.begin(), entries_.end(),
+                [&sound](const Entry& entry) { return entry.sound == sound; });
+        // Son évincé: il n'en reste que la tête, rechargée ensuite avec le stockage du mixer
+        if (it != entries_.end() && it->evicted) continue;
+        if (sound->setSampleStorage(storage)) ++numConverted;
+    }
+    updateResidentBytes();
+    return numConverted;
+}
+//----------------------------------------
+
+bool SampleMemoryManager::start(int periodMs) {
+    if (thread_.joinable()) return false;
+    stopping_ = false;
+    thread_ = std::thread(&SampleMemoryManager::threadLoop, this, periodMs);
+    return true;
+}
+//----------------------------------------
+
+void SampleMemoryManager::stop() {
+    if (!thread_.joinable()) return;
+    {
+        std::lock_guard<std::mutex> lock(threadMutex_);
+        stopping_ = true;
+    }
+    threadCond_.notify_one();
+    thread_.join();
+}
+//----------------------------------------
+
+void SampleMemoryManager::threadLoop(int periodMs) {
+    std::unique_lock<std::mutex> lock(threadMutex_);
+    while (!stopping_) {
+        threadCond_.wait_for(lock, std::chrono::milliseconds(periodMs), [this] { return stopping_; });
+        lock.unlock();
+        service();
+        lock.lock();
+    }
+}
+//----------------------------------------
+
+void SampleMemoryManager::service() {
+    // Sons évincés rejoués depuis: rechargés hors du verrou (décodage, disque)
+    std::vector<std::pair<SoundPtr, std::string>> toReload;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (const auto& entry : entries_) {
+            if (entry.evicted && entry.sound->getLastTrigger() > entry.evictedAt) {
+                toReload.emplace_back(entry.sound, entry.filePath);
+            }
+        }
+    }
+    for (const auto& [sound, filePath] : toReload) {
+        SoundPtr fresh = mixer_.loadSound(filePath);
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = std::find_if(entries_.begin(), entries_.end(),
+                [&sound](const Entry& entry) { return entry.sound == sound; });
+        if (it == entries_.end() || !it->evicted) continue; // Retiré entre-temps
+        if (!fresh || !reload(*it, fresh)) {
+            // Fichier disparu ou modifié: le son garde sa tête, on ne réessaie qu'au prochain coup
+            it->evictedAt = AudioSound::getClockNs();
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    updateResidentBytes();
+    const size_t budget = getBudget();
+    if (budget == 0 || residentBytes_.load(std::memory_order_relaxed) <= budget) return;
+
+    // Les moins récemment joués d'abord (jamais joués: date nulle)
+    const uint64_t now = AudioSound::getClockNs();
+    const uint64_t minIdleNs = static_cast<uint64_t>(minIdleMs * 1e6);
+    std::vector<Entry*> candidates;
+    for (auto& entry : entries_) {
+        if (entry.evicted) continue;
+        const uint64_t lastTrigger = entry.sound->getLastTrigger();
+        if (lastTrigger != 0 && now - lastTrigger < minIdleNs) continue;
+        candidates.push_back(&entry);
+    }
+    std::sort(candidates.begin(), candidates.end(), [](const Entry* a, const Entry* b) {
+        return a->sound->getLastTrigger() < b->sound->getLastTrigger();
+    });
+    for (Entry* entry : candidates) {
+        if (residentBytes_.load(std::memory_order_relaxed) <= budget) break;
+        if (evict(*entry)) updateResidentBytes();
+    }
+}
+//----------------------------------------
+
+bool SampleMemoryManager::evict(Entry& entry) {
+    const SampleBufferPtr buffer = entry.sound->getSampleBuffer();
+    if (!buffer || buffer->isExternal() || buffer->isStreamed()) return false;
+    const size_t numChannels = buffer->getNumChannels();
+    const size_t numFrames = buffer->getNumFrames();
+    const size_t headFrames = getHeadFrames();
+    // Sons courts: la tête ne libérerait presque rien
+    if (numChannels == 0 || numFrames < 2 * headFrames) return false;
+
+    if (!entry.streamChecked) {
+        entry.stream = findStreamSource(entry.filePath, *buffer);
+        entry.streamChecked = true;
+    }
+    // La tête en float, comme celle des sons lus en continu (DiskStreamer::readFrames)
+    AlignedVector<float> head(headFrames * numChannels);
+    buffer->copySamples(head.data(), 0, head.size());
+    SampleBufferPtr headBuffer = entry.stream
+        ? std::make_shared<const SampleBuffer>(std::move(head), numChannels, buffer->getSampleRate(), entry.stream, numFrames)
+        : std::make_shared<const SampleBuffer>(std::move(head), numChannels, buffer->getSampleRate());
+    // Les voix en cours finissent sur le son entier, libéré ensuite par le Reclaimer
+    entry.sound->setSampleBuffer(std::move(headBuffer));
+    entry.evicted = true;
+    entry.evictedAt = AudioSound::getClockNs();
+    numEvicted_.fetch_add(1, std::memory_order_relaxed);
+    numEvictions_.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+//----------------------------------------
+
+bool SampleMemoryManager::reload(Entry& entry, const SoundPtr& fresh) {
+    const SampleBufferPtr current = entry.sound->getSampleBuffer();
+    const SampleBufferPtr buffer = fresh->getSampleBuffer();
+    if (!current || !buffer || buffer->getNumChannels() != current->getNumChannels()
+            || buffer->getTotalFrames() * buffer->getNumChannels() != entry.sound->getLength()) {
+        std::cerr << "Erreur: Impossible de recharger " << entry.filePath << ": le fichier a changé." << std::endl;
+        return false;
+    }
+    const uint64_t triggeredAt = entry.sound->getLastTrigger();
+    // Les voix en cours finissent sur la tête; les coups suivants jouent le son entier
+    entry.sound->setSampleBuffer(buffer);
+    entry.evicted = false;
+    numEvicted_.fetch_sub(1, std::memory_order_relaxed);
+
+    const double latencyMs = (AudioSound::getClockNs() - triggeredAt) / 1e6;
+    lastReloadMs_.store(latencyMs, std::memory_order_relaxed);
+    if (latencyMs > maxReloadMs_.load(std::memory_order_relaxed)) {
+        maxReloadMs_.store(latencyMs, std::memory_order_relaxed);
+    }
+    totalReloadMs_.store(totalReloadMs_.load(std::memory_order_relaxed) + latencyMs, std::memory_order_relaxed);
+    numReloads_.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+//----------------------------------------
+
+const StreamSource* SampleMemoryManager::findStreamSource(const std::string& filePath, const SampleBuffer& buffer) {
+    DiskStreamer& streamer = mixer_.getDiskStreamer();
+    if (!streamer.isEnabled()) return nullptr;
+    StreamSource source;
+    source.numChannels = buffer.getNumChannels();
+    source.numFrames = buffer.getNumFrames();
+
+    AudioFile file;
+    if (file.open(filePath) && file.getSampleRate().value_or(0) == buffer.getSampleRate()
+            && file.getNumChannels().value_or(0) == source.numChannels
+            && file.getNumFrames().value_or(0) == source.numFrames) {
+        // Même fréquence: la suite est lue dans le fichier audio
+        source.filePath = filePath;
+        return streamer.addSource(std::move(source));
+    }
+    // Son converti: la suite est lue dans l'entrée du cache, si elle existe
+    const SampleCache& cache = mixer_.getSampleCache();
+    uint64_t fileHash = 0;
+    if (!cache.isEnabled() || !SampleCache::hashFile(filePath, fileHash)) return nullptr;
+    const std::string entryPath = cache.getEntryPath(fileHash, buffer.getSampleRate());
+    std::error_code ec;
+    const uintmax_t entrySize = std::filesystem::file_size(entryPath, ec);
+    if (ec || entrySize != SampleCache::getDataOffset() + buffer.getNumSamples() * sizeof(float)) return nullptr;
+    source.filePath = entryPath;
+    source.rawFloat = true;
+    source.dataOffset = SampleCache::getDataOffset();
+    return streamer.addSource(std::move(source));
+}
+//----------------------------------------
+
+size_t SampleMemoryManager::getHeadFrames() const {
+    const double headMs = headMs_.load(std::memory_order_relaxed);
+    const size_t sampleRate = mixer_.getSampleRate();
+    return headMs > 0.0 ? static_cast<size_t>(headMs * sampleRate / 1000.0)
+        : mixer_.getDiskStreamer().getHeadFrames(sampleRate);
+}
+//----------------------------------------
+
+void SampleMemoryManager::updateResidentBytes() {
+    // Un buffer partagé par plusieurs sons (SamplePool) n'est compté qu'une fois
+    std::vector<const SampleBuffer*> buffers;
+    buffers.reserve(entries_.size());
+    for (const auto& entry : entries_) {
+        const SampleBufferPtr buffer = entry.sound->getSampleBuffer();
+        if (buffer && !buffer->isExternal()) buffers.push_back(buffer.get());
+    }
+    std::sort(buffers.begin(), buffers.end());
+    buffers.erase(std::unique(buffers.begin(), buffers.end()), buffers.end());
+    size_t numBytes = 0;
+    for (const SampleBuffer* buffer : buffers) {
+        numBytes += buffer->getNumBytes();
+    }
+    residentBytes_.store(numBytes, std::memory_order_relaxed);
+}
+//----------------------------------------
+
+size_t SampleMemoryManager::getNumSounds() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return entries_.size();
+}
+//----------------------------------------
+
+double SampleMemoryManager::getAvgReloadMs() const {
+    const size_t numReloads = getNumReloads();
+    return numReloads > 0 ? totalReloadMs_.load(std::memory_order_relaxed) / numReloads : 0.0;
+}
+//----------------------------------------
+
+std::string SampleMemoryManager::getReport() const {
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(2) << "Budget: ";
+    const size_t budget = getBudget();
+    if (budget == 0) {
+        oss << "illimité";
+    } else {
+        oss << budget / 1024 << " Ko";
+    }
+    oss << ", résident: " << getResidentBytes() / 1024 << " Ko (" << getNumSounds() << " sons, "
+        << getNumEvicted() << " évincés), évictions: " << getNumEvictions()
+        << ", rechargements: " << getNumReloads() << " (dernier " << getLastReloadMs()
+        << " ms, moyen " << getAvgReloadMs() << " ms, max " << getMaxReloadMs() << " ms)";
+    return oss.str();
+}
+//----------------------------------------
+
+void SampleMemoryManager::resetStats() {
+    numEvictions_.store(0, std::memory_order_relaxed);
+    numReloads_.store(0, std::memory_order_relaxed);
+    lastReloadMs_.store(0.0, std::memory_order_relaxed);
+    maxReloadMs_.store(0.0, std::memory_order_relaxed);
+    totalReloadMs_.store(0.0, std::memory_order_relaxed);
+}
+//----------------------------------------
+
+//==== End of class SampleMemoryManager ====
+
+} // namespace adikdrum
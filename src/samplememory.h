@@ -0,0 +1,119 @@
+#ifndef SAMPLEMEMORY_H
+#define SAMPLEMEMORY_H
+
+#include "audiosound.h"
+
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cstddef> // Pour size_t
+#include <cstdint>
+
+namespace adikdrum {
+
+class AudioMixer;
+struct StreamSource; // diskstreamer.h
+
+// Budget de mémoire des sons décodés (LRU).
+// Les sons des kits chargés sont enregistrés ici; au-delà du budget, les moins récemment joués
+// sont évincés: leur SampleBuffer est remplacé par une tête (l'attaque), lue en continu
+// par le DiskStreamer pour la suite quand le fichier le permet. Un son évincé reste donc jouable
+// tout de suite. Dès qu'il est rejoué, il est rechargé en entier en arrière-plan
+// (AudioMixer::loadSound: fichier, cache ou banque projetée) et publié pour les coups suivants.
+//
+// Le thread du gestionnaire fait toutes les évictions et tous les rechargements, comme une
+// modification des données (AudioSound::setSampleBuffer, anciens buffers libérés par le Reclaimer).
+// Les sons enregistrés ne doivent pas être modifiés ailleurs (voir convertSounds).
+// Le thread audio ne fait que dater chaque déclenchement (AudioSound::markTriggered).
+class SampleMemoryManager {
+public:
+    static constexpr int defaultPeriodMs = 10;
+    static constexpr double minIdleMs = 1000.0; // Un son joué depuis moins longtemps n'est pas évincé
+
+    explicit SampleMemoryManager(AudioMixer& mixer);
+    ~SampleMemoryManager();
+    SampleMemoryManager(const SampleMemoryManager&) = delete;
+    SampleMemoryManager& operator=(const SampleMemoryManager&) = delete;
+
+    // Octets des sons décodés à ne pas dépasser (0: pas de limite)
+    size_t getBudget() const { return budget_.load(std::memory_order_relaxed); }
+    void setBudget(size_t numBytes) { budget_.store(numBytes, std::memory_order_relaxed); }
+    // Tête gardée en mémoire par un son évincé (défaut: celle du DiskStreamer)
+    void setHeadMs(double ms) { headMs_.store(ms, std::memory_order_relaxed); }
+
+    // Son chargé depuis filePath (thread UI). Les sons lus en continu ou projetés (banque float32)
+    // ne sont pas comptés: ils n'occupent pas de mémoire décodée.
+    void addSound(const SoundPtr& sound, const std::string& filePath);
+    void removeSound(const SoundPtr& sound);
+    void clear();
+    // Change le stockage des sons (voir AudioSound::setSampleStorage), enregistrés ou non;
+    // les sons évincés le prendront au rechargement. Renvoie le nombre de sons convertis.
+    size_t convertSounds(const std::vector<SoundPtr>& sounds, SampleStorage storage);
+    // Les buffers restent ceux du moment tant que le verrou est gardé (rapports cohérents)
+    std::unique_lock<std::mutex> lockSounds() const { return std::unique_lock<std::mutex>(mutex_); }
+
+    // Thread du gestionnaire: service() toutes les periodMs millisecondes
+    bool start(int periodMs = defaultPeriodMs);
+    void stop();
+    bool isRunning() const { return thread_.joinable(); }
+    // Un passage: recharge les sons évincés rejoués, puis évince jusqu'à revenir sous le budget.
+    // Appelée par le thread du gestionnaire, ou directement (rendu hors ligne).
+    void service();
+
+    size_t getNumSounds() const;
+    size_t getResidentBytes() const { return residentBytes_.load(std::memory_order_relaxed); }
+    size_t getNumEvicted() const { return numEvicted_.load(std::memory_order_relaxed); }
+    size_t getNumEvictions() const { return numEvictions_.load(std::memory_order_relaxed); }
+    size_t getNumReloads() const { return numReloads_.load(std::memory_order_relaxed); }
+    // Du déclenchement d'un son évincé à la publication du son rechargé
+    double getLastReloadMs() const { return lastReloadMs_.load(std::memory_order_relaxed); }
+    double getMaxReloadMs() const { return maxReloadMs_.load(std::memory_order_relaxed); }
+    double getAvgReloadMs() const;
+    std::string getReport() const;
+    void resetStats();
+
+private:
+    struct Entry {
+        SoundPtr sound;
+        std::string filePath;
+        bool evicted = false;
+        uint64_t evictedAt = 0;               // AudioSound::getClockNs
+        const StreamSource* stream = nullptr; // Suite d'un son évincé, créée à la première éviction
+        bool streamChecked = false;
+    };
+
+    AudioMixer& mixer_;
+    std::atomic<size_t> budget_{0};
+    std::atomic<double> headMs_{0.0};
+
+    mutable std::mutex mutex_; // Protège entries_ et les buffers des sons enregistrés
+    std::vector<Entry> entries_;
+
+    std::atomic<size_t> residentBytes_{0};
+    std::atomic<size_t> numEvicted_{0};
+    std::atomic<size_t> numEvictions_{0};
+    std::atomic<size_t> numReloads_{0};
+    std::atomic<double> lastReloadMs_{0.0};
+    std::atomic<double> maxReloadMs_{0.0};
+    std::atomic<double> totalReloadMs_{0.0};
+
+    std::thread thread_;
+    std::mutex threadMutex_;
+    std::condition_variable threadCond_;
+    bool stopping_ = false;
+
+    void threadLoop(int periodMs);
+    bool reload(Entry& entry, const SoundPtr& fresh);
+    bool evict(Entry& entry);
+    const StreamSource* findStreamSource(const std::string& filePath, const SampleBuffer& buffer);
+    size_t getHeadFrames() const;
+    void updateResidentBytes(); // mutex_ pris
+};
+//==== End of class SampleMemoryManager ====
+
+} // namespace adikdrum
+
+#endif // SAMPLEMEMORY_H
@@ -0,0 +1,115 @@
+#include "samplepool.h"
+#include "samplecache.h"
+
+#include <sstream>
+#include <sys/stat.h>
+
+namespace adikdrum {
+
+SamplePool& SamplePool::getInstance() {
+    static SamplePool pool;
+    return pool;
+}
+//----------------------------------------
+
+bool SamplePool::getFileInfo(const std::string& filePath, uint64_t& size, int64_t& mtimeNs) {
+    struct stat st;
+    if (stat(filePath.c_str(), &st) != 0) return false;
+    size = static_cast<uint64_t>(st.st_size);
+    mtimeNs = static_cast<int64_t>(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+    return true;
+}
+//----------------------------------------
+
+bool SamplePool::findHash(const std::string& filePath, uint64_t& hash) {
+    uint64_t size = 0;
+    int64_t mtimeNs = 0;
+    if (!getFileInfo(filePath, size, mtimeNs)) return false;
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = files_.find(filePath);
+    if (it == files_.end() || it->second.size != size || it->second.mtimeNs != mtimeNs) return false;
+    hash = it->second.hash;
+    numHashSkips_.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+//----------------------------------------
+
+bool SamplePool::hashFile(const std::string& filePath, uint64_t& hash) {
+    if (findHash(filePath, hash)) return true;
+    uint64_t size = 0;
+    int64_t mtimeNs = 0;
+    // Fichier nouveau ou modifié: son contenu est relu, hors du verrou
+    if (!getFileInfo(filePath, size, mtimeNs) || !SampleCache::hashFile(filePath, hash)) return false;
+    std::lock_guard<std::mutex> lock(mutex_);
+    files_[filePath] = {size, mtimeNs, hash};
+    return true;
+}
+//----------------------------------------
+
+SoundPtr SamplePool::getSound(uint64_t fileHash, size_t sampleRate, SampleStorage storage) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = entries_.find(Key(fileHash, sampleRate, storage));
+    if (it == entries_.end()) return nullptr;
+    SampleBufferPtr buffer = it->second.buffer.lock();
+    if (!buffer) {
+        entries_.erase(it);
+        return nullptr;
+    }
+    numHits_.fetch_add(1, std::memory_order_relaxed);
+    bytesShared_.fetch_add(buffer->getNumBytes(), std::memory_order_relaxed);
+    return makeSound(buffer, it->second.bitDepth);
+}
+//----------------------------------------
+
+SoundPtr SamplePool::addSound(uint64_t fileHash, size_t sampleRate, SampleStorage storage, const SoundPtr& sound) {
+    if (!sound) return sound;
+    const SampleBufferPtr buffer = sound->getSampleBuffer();
+    if (!buffer || buffer->isStreamed()) return sound;
+    std::lock_guard<std::mutex> lock(mutex_);
+    purgeExpired();
+    Entry& entry = entries_[Key(fileHash, sampleRate, storage)];
+    if (SampleBufferPtr existing = entry.buffer.lock()) {
+        // Décodé en même temps par un autre thread: on garde le premier
+        numHits_.fetch_add(1, std::memory_order_relaxed);
+        bytesShared_.fetch_add(existing->getNumBytes(), std::memory_order_relaxed);
+        return makeSound(existing, entry.bitDepth);
+    }
+    entry.buffer = buffer;
+    entry.bitDepth = sound->getBitDepth();
+    return sound;
+}
+//----------------------------------------
+
+SoundPtr SamplePool::makeSound(const SampleBufferPtr& buffer, size_t bitDepth) {
+    return std::make_shared<AudioSound>(buffer, bitDepth);
+}
+//----------------------------------------
+
+void SamplePool::purgeExpired() {
+    for (auto it = entries_.begin(); it != entries_.end();) {
+        it = it->second.buffer.expired() ? entries_.erase(it) : std::next(it);
+    }
+}
+//----------------------------------------
+
+size_t SamplePool::getNumEntries() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_t count = 0;
+    for (const auto& [key, entry] : entries_) {
+        if (!entry.buffer.expired()) ++count;
+    }
+    return count;
+}
+//----------------------------------------
+
+std::string SamplePool::getReport() const {
+    std::ostringstream oss;
+    oss << "Sons partagés: " << getNumEntries() << " buffers, " << getNumHits() << " réutilisés ("
+        << getBytesShared() / 1024 << " Ko évités), " << getNumHashSkips() << " empreintes reprises";
+    return oss.str();
+}
+//----------------------------------------
+
+//==== End of class SamplePool ====
+
+} // namespace adikdrum
@@ -0,0 +1,79 @@
+#ifndef SAMPLEPOOL_H
+#define SAMPLEPOOL_H
+
+#include "audiosound.h"
+
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <cstddef> // Pour size_t
+#include <cstdint>
+
+namespace adikdrum {
+
+// Sons décodés partagés par tout le processus, par contenu.
+// Clé: empreinte du contenu du fichier (FNV-1a 64 bits, comme SampleCache), fréquence et stockage:
+// deux fichiers identiques (le même coup dans plusieurs kits), un kit rechargé,
+// ou plusieurs AdikDrum dans le même processus se partagent un seul SampleBuffer, immuable.
+// Le chemin, la taille et la date d'un fichier déjà vu évitent de relire son contenu pour l'empreinte.
+// Les buffers ne sont gardés que tant qu'un son les utilise (weak_ptr): la réserve ne retient
+// aucune mémoire. Les sons lus en continu n'y sont pas: leur source appartient à un DiskStreamer.
+// Thread-safe: appelée par les threads de chargement.
+class SamplePool {
+public:
+    static SamplePool& getInstance();
+    SamplePool(const SamplePool&) = delete;
+    SamplePool& operator=(const SamplePool&) = delete;
+
+    // Empreinte déjà calculée de filePath, si le fichier n'a pas changé depuis (taille, date):
+    // sans lire le fichier
+    bool findHash(const std::string& filePath, uint64_t& hash);
+    // Empreinte du contenu de filePath, relue seulement si le fichier a changé;
+    // renvoie false si le fichier ne peut être lu
+    bool hashFile(const std::string& filePath, uint64_t& hash);
+    // Nouveau son sur le buffer déjà décodé pour ce contenu; nullptr s'il n'y en a plus
+    SoundPtr getSound(uint64_t fileHash, size_t sampleRate, SampleStorage storage);
+    // Enregistre le buffer d'un son qui vient d'être décodé. Si un autre thread a décodé
+    // le même contenu entre-temps, renvoie un son sur ce buffer-là (sound est abandonné).
+    SoundPtr addSound(uint64_t fileHash, size_t sampleRate, SampleStorage storage, const SoundPtr& sound);
+
+    size_t getNumEntries() const; // Buffers encore utilisés
+    size_t getNumHits() const { return numHits_.load(std::memory_order_relaxed); }
+    size_t getNumHashSkips() const { return numHashSkips_.load(std::memory_order_relaxed); }
+    // Octets non alloués grâce au partage
+    size_t getBytesShared() const { return bytesShared_.load(std::memory_order_relaxed); }
+    std::string getReport() const;
+
+private:
+    SamplePool() = default;
+
+    using Key = std::tuple<uint64_t, size_t, SampleStorage>;
+    struct Entry {
+        std::weak_ptr<const SampleBuffer> buffer;
+        size_t bitDepth = 16;
+    };
+    struct FileInfo {
+        uint64_t size = 0;
+        int64_t mtimeNs = 0;
+        uint64_t hash = 0;
+    };
+
+    mutable std::mutex mutex_;
+    std::map<Key, Entry> entries_;
+    std::unordered_map<std::string, FileInfo> files_;
+    std::atomic<size_t> numHits_{0};
+    std::atomic<size_t> numHashSkips_{0};
+    std::atomic<size_t> bytesShared_{0};
+
+    SoundPtr makeSound(const SampleBufferPtr& buffer, size_t bitDepth);
+    void purgeExpired(); // mutex_ pris
+    static bool getFileInfo(const std::string& filePath, uint64_t& size, int64_t& mtimeNs);
+};
+//==== End of class SamplePool ====
+
+} // namespace adikdrum
+
+#endif // SAMPLEPOOL_H
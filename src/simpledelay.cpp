@@ -38,7 +38,7 @@ void SimpleDelay::setActive(bool active) {
 //----------------------------------------
 
 // Fonction process modifiée pour traiter un buffer:
-void SimpleDelay::processData(std::vector<float>& bufData, size_t numFrames, int numChannels) {
+void SimpleDelay::processData(float* bufData, size_t numFrames, int numChannels) {
     float delayInSamples = delayTimeSec_ * sampleRate_;
     if (delayInSamples < 1) return;
     // std::cout << "voici bufferSize: " << bufferSize_ << "\n";
@@ -16,7 +16,7 @@ public:
     void setActive(bool active);
 
     // Fonction process modifiée pour traiter un buffer:
-    void processData(std::vector<float>& bufData, size_t numFrames, int numChannels);
+    void processData(float* bufData, size_t numFrames, int numChannels);
 
 private:
     std::vector<float> delayBuffer_;
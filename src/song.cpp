@@ -0,0 +1,145 @@
+#include "song.h"
+
+#include <algorithm> // Pour std::find
+#include <cmath>
+#include <bit>       // Pour std::popcount
+#include <sstream>
+
+namespace adikdrum {
+
+bool isValidSongBpm(double bpm) {
+    return bpm == 0.0 || (std::isfinite(bpm) && bpm >= minSongBpm && bpm <= maxSongBpm);
+}
+//----------------------------------------
+
+size_t Song::addSection(const Bars& bars, const SongSection& section) {
+    SongSection added = section;
+    // Mêmes pointeurs de barres: même pattern, pas encore modifié depuis son dernier ajout
+    auto it = std::find(patterns_.begin(), patterns_.end(), bars);
+    added.pattern = static_cast<size_t>(it - patterns_.begin());
+    if (it == patterns_.end()) patterns_.push_back(bars);
+    if (added.repeats == 0) added.repeats = 1;
+    sections_.push_back(added);
+    return sections_.size() - 1;
+}
+//----------------------------------------
+
+bool Song::removeSection(size_t index) {
+    if (index >= sections_.size()) return false;
+    sections_.erase(sections_.begin() + static_cast<std::ptrdiff_t>(index));
+    removeUnusedPatterns();
+    return true;
+}
+//----------------------------------------
+
+void Song::clear() {
+    sections_.clear();
+    patterns_.clear();
+}
+//----------------------------------------
+
+bool Song::setContent(std::vector<Bars> patterns, std::vector<SongSection> sections) {
+    for (const auto& section : sections) {
+        if (section.pattern >= patterns.size() || patterns[section.pattern].empty()
+                || section.repeats == 0 || !isValidSongBpm(section.bpm)) return false;
+    }
+    patterns_ = std::move(patterns);
+    sections_ = std::move(sections);
+    removeUnusedPatterns();
+    return true;
+}
+//----------------------------------------
+
+void Song::removeUnusedPatterns() {
+    std::vector<size_t> newIndexes(patterns_.size(), patterns_.size());
+    for (const auto& section : sections_) newIndexes[section.pattern] = 0;
+    size_t numKept = 0;
+    for (size_t i = 0; i < patterns_.size(); ++i) {
+        if (newIndexes[i] == patterns_.size()) continue;
+        newIndexes[i] = numKept;
+        // Pas de déplacement sur soi-même: libstdc++ viderait le vecteur
+        if (numKept != i) patterns_[numKept] = std::move(patterns_[i]);
+        ++numKept;
+    }
+    patterns_.resize(numKept);
+    for (auto& section : sections_) section.pattern = newIndexes[section.pattern];
+}
+//----------------------------------------
+
+std::shared_ptr<const SongTimeline> Song::compile(double sampleRate, double defaultBpm) const {
+    auto timeline = std::make_shared<SongTimeline>();
+    timeline->sampleRate = sampleRate;
+
+    // Premier passage: nombre exact de coups et de mesures, pour une seule allocation par tableau
+    size_t numEvents = 0;
+    size_t numBars = 0;
+    size_t numBeats = 0;
+    for (const auto& section : sections_) {
+        const Bars& bars = patterns_[section.pattern];
+        size_t numRepeatEvents = 0;
+        size_t numRepeatBeats = 0;
+        for (const auto& bar : bars) {
+            numRepeatBeats += (bar->size() + 3) / 4;
+            for (const AdikPattern::Mask& mask : *bar) {
+                for (size_t w = 0; w < AdikPattern::Mask::numWords; ++w) {
+                    numRepeatEvents += static_cast<size_t>(std::popcount(mask.words[w] & ~section.muted.words[w]));
+                }
+            }
+        }
+        numEvents += numRepeatEvents * section.repeats;
+        numBars += bars.size() * section.repeats;
+        numBeats += numRepeatBeats * section.repeats;
+    }
+    timeline->events.reserve(numEvents);
+    timeline->bars.reserve(numBars);
+    timeline->beats.reserve(numBeats);
+
+    double position = 0.0; // En frames, avec la partie fractionnaire
+    for (size_t s = 0; s < sections_.size(); ++s) {
+        const SongSection& section = sections_[s];
+        const double bpm = section.bpm > 0.0 ? section.bpm : defaultBpm;
+        const double framesPerStep = sampleRate * ((60.0 / bpm) / 4.0);
+        const Bars& bars = patterns_[section.pattern];
+        for (size_t repeat = 0; repeat < section.repeats; ++repeat) {
+            for (size_t b = 0; b < bars.size(); ++b) {
+                timeline->bars.push_back({static_cast<uint64_t>(position), static_cast<uint32_t>(s), static_cast<uint32_t>(b)});
+                const AdikPattern::Bar& bar = *bars[b];
+                for (size_t step = 0; step < bar.size(); ++step) {
+                    const uint64_t frame = static_cast<uint64_t>(position);
+                    if (step % 4 == 0) timeline->beats.push_back({frame, (step / 4) % 4 == 0});
+                    const AdikPattern::Mask& mask = bar[step];
+                    AdikPattern::Mask active = mask;
+                    for (size_t w = 0; w < AdikPattern::Mask::numWords; ++w) active.words[w] &= ~section.muted.words[w];
+                    active.forEach([&](size_t sound) {
+                        timeline->events.push_back({frame, static_cast<uint32_t>(sound), section.velocity});
+                    });
+                    position += framesPerStep;
+                }
+            }
+        }
+    }
+    timeline->numFrames = static_cast<uint64_t>(position);
+    return timeline;
+}
+//----------------------------------------
+
+std::string Song::getReport() const {
+    std::ostringstream oss;
+    oss << "Morceau: " << sections_.size() << " sections, " << patterns_.size() << " patterns";
+    for (size_t s = 0; s < sections_.size(); ++s) {
+        const SongSection& section = sections_[s];
+        oss << "; " << s + 1 << ": pattern " << section.pattern + 1 << " x" << section.repeats;
+        if (section.bpm > 0.0) oss << ", " << section.bpm << " BPM";
+        if (section.velocity != 127) oss << ", vélocité " << static_cast<int>(section.velocity);
+        if (section.muted.any()) {
+            oss << ", coupés:";
+            section.muted.forEach([&](size_t sound) { oss << " " << sound + 1; });
+        }
+    }
+    return oss.str();
+}
+//----------------------------------------
+
+//==== End of class Song ====
+
+} // namespace adikdrum
@@ -0,0 +1,95 @@
+#ifndef SONG_H
+#define SONG_H
+
+#include "adikpattern.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstddef> // Pour size_t
+#include <cstdint>
+
+namespace adikdrum {
+
+// Section d'un morceau: un pattern joué repeats fois, avec son tempo, sa vélocité et ses sons coupés
+struct SongSection {
+    size_t pattern = 0;       // Index dans Song::getPatterns
+    size_t repeats = 1;
+    double bpm = 0.0;         // 0: tempo du lecteur au moment de la compilation
+    uint8_t velocity = 127;   // 1 à 127
+    AdikPattern::Mask muted;  // Sons coupés pendant la section
+};
+
+// Tempo d'une section: 0 (tempo du lecteur) ou de minSongBpm à maxSongBpm
+constexpr double minSongBpm = 5.0;
+constexpr double maxSongBpm = 800.0;
+bool isValidSongBpm(double bpm);
+
+// Coup du morceau compilé. Structure POD de 16 octets, lue par le thread audio.
+struct SongEvent {
+    uint64_t frame = 0; // Depuis le début du morceau
+    uint32_t sound = 0;
+    uint8_t velocity = 127;
+};
+
+// Début d'une mesure du morceau compilé: position affichée et changement de kit
+struct SongBar {
+    uint64_t frame = 0;
+    uint32_t section = 0;
+    uint32_t bar = 0; // Dans le pattern de la section
+};
+
+// Temps du métronome dans le morceau compilé: un tous les 4 pas, accentué en début de mesure
+// comme DrumPlayer::playMetronome
+struct SongBeat {
+    uint64_t frame = 0;
+    bool accent = false;
+};
+
+// Morceau compilé: la lecture ne fait qu'avancer un curseur dans des tableaux triés par frame,
+// sans parcourir les sections, les répétitions ni les masques des pas.
+// Immuable une fois publié (DrumPlayer::setSong).
+struct SongTimeline {
+    std::vector<SongEvent> events;
+    std::vector<SongBar> bars;
+    std::vector<SongBeat> beats;
+    uint64_t numFrames = 0; // Longueur du morceau; 0: pas de morceau (lecture du pattern)
+    double sampleRate = 0.0;
+};
+
+// Morceau: suite de sections, chacune jouant un des patterns du morceau (thread UI).
+// Les patterns sont les barres d'une copie du pattern courant au moment de l'ajout:
+// partagées avec lui (AdikPattern::BarPtr), sans copie des pas.
+class Song {
+public:
+    using Bars = std::vector<AdikPattern::BarPtr>;
+
+    // Ajoute une section à la fin; un pattern aux mêmes barres est réutilisé. Renvoie son index.
+    size_t addSection(const Bars& bars, const SongSection& section);
+    bool removeSection(size_t index);
+    void clear();
+    // Contenu complet (fichier de projet); faux si une section désigne un pattern absent,
+    // n'a aucune répétition ou a un tempo invalide (isValidSongBpm)
+    bool setContent(std::vector<Bars> patterns, std::vector<SongSection> sections);
+
+    bool isEmpty() const { return sections_.empty(); }
+    const std::vector<SongSection>& getSections() const { return sections_; }
+    const std::vector<Bars>& getPatterns() const { return patterns_; }
+
+    // Compile les sections en coups triés, à la fréquence sampleRate; defaultBpm pour les sections sans tempo.
+    // Les pas sont placés comme par DrumPlayer::scheduleSteps (position cumulée en double, tronquée).
+    std::shared_ptr<const SongTimeline> compile(double sampleRate, double defaultBpm) const;
+    std::string getReport() const;
+
+private:
+    std::vector<Bars> patterns_;
+    std::vector<SongSection> sections_;
+
+    // Retire les patterns qu'aucune section ne joue plus
+    void removeUnusedPatterns();
+};
+//==== End of class Song ====
+
+} // namespace adikdrum
+
+#endif // SONG_H
@@ -22,6 +22,7 @@ SoundPtr SoundFactory::applyEnvelopeToAudioSound(SoundPtr audioSound, float deca
         float time = static_cast<float>(i) / sampleRate_;
         wave[i] *= expf(-time * decayRate);
     }
+    audioSound->updateSampleBuffer();
     return audioSound;
 }
 //----------------------------------------
@@ -38,6 +39,7 @@ SoundPtr SoundFactory::applySquareEnvelopeToAudioSound(SoundPtr audioSound, floa
         float time = static_cast<float>(i) / sampleRate_;
         wave[i] *= expf(-time * decayRate);
     }
+    audioSound->updateSampleBuffer();
     return audioSound;
 }
 //----------------------------------------
@@ -137,19 +139,19 @@ SoundPtr SoundFactory::generateBuzzer(float frequency, float duration) {
 
 SoundPtr SoundFactory::tone(const std::string& type, float frequency, float duration) {
     if (type == "sine") {
-        return std::make_shared<AudioSound>(generator_.generateSine(frequency, sampleRate_, duration));
+        return std::make_shared<AudioSound>(generator_.generateSine(frequency, sampleRate_, duration), 1, sampleRate_);
     } else if (type == "cosine") {
-        return std::make_shared<AudioSound>(generator_.generateCosine(frequency, sampleRate_, duration));
+        return std::make_shared<AudioSound>(generator_.generateCosine(frequency, sampleRate_, duration), 1, sampleRate_);
     } else if (type == "square") {
-        return std::make_shared<AudioSound>(generator_.generateSquare(frequency, sampleRate_, duration));
+        return std::make_shared<AudioSound>(generator_.generateSquare(frequency, sampleRate_, duration), 1, sampleRate_);
     } else if (type == "sawtooth") {
-        return std::make_shared<AudioSound>(generator_.generateSawtooth(frequency, sampleRate_, duration));
+        return std::make_shared<AudioSound>(generator_.generateSawtooth(frequency, sampleRate_, duration), 1, sampleRate_);
     } else if (type == "triangle") {
-        return std::make_shared<AudioSound>(generator_.generateTriangle(frequency, sampleRate_, duration));
+        return std::make_shared<AudioSound>(generator_.generateTriangle(frequency, sampleRate_, duration), 1, sampleRate_);
     } else if (type == "whitenoise") { // Ajout pour le bruit blanc
-        return std::make_shared<AudioSound>(generator_.generateWhiteNoise(sampleRate_, duration, 1.0f)); // Amplitude par défaut de 1.0
+        return std::make_shared<AudioSound>(generator_.generateWhiteNoise(sampleRate_, duration, 1.0f), 1, sampleRate_); // Amplitude par défaut de 1.0
     } else if (type == "silence") {
-        return std::make_shared<AudioSound>(generator_.generateSilence(duration));
+        return std::make_shared<AudioSound>(generator_.generateSilence(duration), 1, sampleRate_);
 
     } else if (type == "kick") {
         return generateKick();
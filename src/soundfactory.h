@@ -13,6 +13,9 @@ public:
     SoundFactory(int sampleRate, float defaultDuration);
     ~SoundFactory();
 
+    int getSampleRate() const { return sampleRate_; }
+    void setSampleRate(int sampleRate) { sampleRate_ = sampleRate; }
+
     SoundPtr applyEnvelopeToAudioSound(SoundPtr audioSound, float decayRate);
     SoundPtr applyNoiseEnvelopeToAudioSound(SoundPtr audioSound, float decayRate);
     SoundPtr applySquareEnvelopeToAudioSound(SoundPtr audioSound, float duration, float decayRate);
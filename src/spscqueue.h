@@ -0,0 +1,66 @@
+#ifndef SPSCQUEUE_H
+#define SPSCQUEUE_H
+
+#include <atomic>
+#include <array>
+#include <cstddef> // Pour size_t
+
+#include "alignedbuffer.h" // Pour CACHE_LINE_SIZE
+
+namespace adikdrum {
+
+// File circulaire bornée, sans verrou, pour un seul producteur et un seul consommateur.
+// Le producteur (thread UI) appelle push, le consommateur (thread audio) appelle pop.
+// Aucune allocation: la capacité est fixée à la compilation (Capacity doit être une puissance de 2).
+template <typename T, size_t Capacity>
+class SpscQueue {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "La capacité doit être une puissance de 2");
+
+public:
+    SpscQueue() : head_(0), tail_(0) {}
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    // Côté producteur. Retourne false si la file est pleine.
+    bool push(const T& item) {
+        const size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail - head_.load(std::memory_order_acquire) >= Capacity) {
+            return false;
+        }
+        buffer_[tail & (Capacity - 1)] = item;
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Côté consommateur. Retourne false si la file est vide.
+    bool pop(T& item) {
+        const size_t head = head_.load(std::memory_order_relaxed);
+        if (head == tail_.load(std::memory_order_acquire)) {
+            return false;
+        }
+        item = buffer_[head & (Capacity - 1)];
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool empty() const {
+        return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_acquire);
+    }
+
+    size_t size() const {
+        return tail_.load(std::memory_order_acquire) - head_.load(std::memory_order_acquire);
+    }
+
+    static constexpr size_t capacity() { return Capacity; }
+
+private:
+    // Les index sont sur des lignes de cache séparées pour éviter le faux partage entre les deux threads.
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> head_;
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> tail_;
+    alignas(CACHE_LINE_SIZE) std::array<T, Capacity> buffer_;
+};
+//==== End of class SpscQueue ====
+
+} // namespace adikdrum
+
+#endif // SPSCQUEUE_H
@@ -0,0 +1,86 @@
+#ifndef SPSCRING_H
+#define SPSCRING_H
+
+#include <atomic>
+#include <algorithm>
+#include <cstring> // Pour std::memcpy
+#include <cstddef> // Pour size_t
+
+#include "alignedbuffer.h"
+
+namespace adikdrum {
+
+// File circulaire d'échantillons, sans verrou, pour un seul producteur et un seul consommateur.
+// Contrairement à SpscQueue, la capacité est choisie à l'exécution (init, hors du thread audio)
+// et les données sont écrites et lues par blocs.
+class SpscRing {
+public:
+    SpscRing() : head_(0), tail_(0) {}
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    // Alloue au moins capacity échantillons (arrondi à une puissance de 2)
+    void init(size_t capacity) {
+        size_t size = 2;
+        while (size < capacity) size <<= 1;
+        buffer_.assign(size, 0.0f);
+        mask_ = size - 1;
+        reset();
+    }
+
+    // Vide la file: seulement quand ni le producteur ni le consommateur ne l'utilisent
+    void reset() {
+        head_.store(0, std::memory_order_relaxed);
+        tail_.store(0, std::memory_order_release);
+    }
+
+    // Côté producteur. Retourne le nombre d'échantillons écrits.
+    size_t write(const float* data, size_t count) {
+        const size_t tail = tail_.load(std::memory_order_relaxed);
+        count = std::min(count, buffer_.size() - (tail - head_.load(std::memory_order_acquire)));
+        const size_t start = tail & mask_;
+        const size_t first = std::min(count, buffer_.size() - start);
+        std::memcpy(buffer_.data() + start, data, first * sizeof(float));
+        std::memcpy(buffer_.data(), data + first, (count - first) * sizeof(float));
+        tail_.store(tail + count, std::memory_order_release);
+        return count;
+    }
+
+    // Côté consommateur. Retourne le nombre d'échantillons lus.
+    size_t read(float* data, size_t count) {
+        const size_t head = head_.load(std::memory_order_relaxed);
+        count = std::min(count, tail_.load(std::memory_order_acquire) - head);
+        const size_t start = head & mask_;
+        const size_t first = std::min(count, buffer_.size() - start);
+        std::memcpy(data, buffer_.data() + start, first * sizeof(float));
+        std::memcpy(data + first, buffer_.data(), (count - first) * sizeof(float));
+        head_.store(head + count, std::memory_order_release);
+        return count;
+    }
+
+    // Côté consommateur: saute au plus count échantillons
+    size_t skip(size_t count) {
+        const size_t head = head_.load(std::memory_order_relaxed);
+        count = std::min(count, tail_.load(std::memory_order_acquire) - head);
+        head_.store(head + count, std::memory_order_release);
+        return count;
+    }
+
+    size_t getReadAvailable() const {
+        return tail_.load(std::memory_order_acquire) - head_.load(std::memory_order_acquire);
+    }
+    size_t getWriteAvailable() const { return buffer_.size() - getReadAvailable(); }
+    size_t getCapacity() const { return buffer_.size(); }
+
+private:
+    // Les index sont sur des lignes de cache séparées pour éviter le faux partage entre les deux threads.
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> head_;
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> tail_;
+    AlignedVector<float> buffer_;
+    size_t mask_ = 1;
+};
+//==== End of class SpscRing ====
+
+} // namespace adikdrum
+
+#endif // SPSCRING_H
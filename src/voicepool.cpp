@@ -0,0 +1,133 @@
+#include "voicepool.h"
+
+namespace adikdrum {
+
+VoicePool::VoicePool(size_t maxVoices, size_t numTailVoices)
+    : voices_(maxVoices + numTailVoices),
+      maxVoices_(maxVoices) {
+}
+//----------------------------------------
+
+VoiceState* VoicePool::allocate(size_t channel, size_t maxPolyphony, size_t frameOffset) {
+    // Limite de polyphonie du canal: on libère une place parmi ses propres voix
+    if (maxPolyphony > 0) {
+        size_t count =0;
+        VoiceState* victim = nullptr;
+        for (auto& voice : voices_) {
+            if (voice.active && !voice.releasing && voice.channel == channel) {
+                ++count;
+                if (!victim || isBetterVictim(voice, *victim)) victim = &voice;
+            }
+        }
+        if (victim && count >= maxPolyphony) {
+            release(*victim, frameOffset);
+            ++numSteals_;
+        }
+    }
+
+    // Limite globale, et recherche d'une case libre
+    size_t numSounding =0;
+    VoiceState* victim = nullptr;
+    VoiceState* freeSlot = nullptr;
+    VoiceState* weakestTail = nullptr;
+    for (auto& voice : voices_) {
+        if (!voice.active) {
+            if (!freeSlot) freeSlot = &voice;
+        } else if (voice.releasing) {
+            if (!weakestTail || voice.releaseGain < weakestTail->releaseGain) weakestTail = &voice;
+        } else {
+            ++numSounding;
+            if (!victim || isBetterVictim(voice, *victim)) victim = &voice;
+        }
+    }
+    if (victim && numSounding >= maxVoices_) {
+        release(*victim, frameOffset);
+        ++numSteals_;
+        if (!weakestTail) weakestTail = victim;
+    }
+    if (!freeSlot) {
+        // Toutes les cases de fondu sont prises: on coupe le fondu le plus avancé
+        freeSlot = weakestTail;
+        if (!freeSlot) return nullptr;
+    }
+
+    VoiceState& voice = *freeSlot;
+    voice = VoiceState();
+    voice.channel = channel;
+    voice.startOffset = frameOffset;
+    voice.active = true;
+    voice.level = 1.0f; // Pas encore joué: ne doit pas passer pour la voix la plus faible
+    voice.serial = ++nextSerial_;
+    return &voice;
+}
+//----------------------------------------
+
+void VoicePool::releaseChannel(size_t channel, size_t frameOffset) {
+    for (auto& voice : voices_) {
+        if (voice.active && !voice.releasing && voice.channel == channel) {
+            release(voice, frameOffset);
+        }
+    }
+}
+//----------------------------------------
+
+void VoicePool::releaseAll() {
+    for (auto& voice : voices_) {
+        if (voice.active && !voice.releasing) {
+            release(voice, 0);
+        }
+    }
+}
+//----------------------------------------
+
+void VoicePool::clear() {
+    for (auto& voice : voices_) {
+        freeVoice(voice);
+    }
+}
+//----------------------------------------
+
+void VoicePool::freeVoice(VoiceState& voice) {
+    voice.active = false;
+    voice.releasing = false;
+    voice.buffer = nullptr;
+}
+//----------------------------------------
+
+size_t VoicePool::getNumActive() const {
+    size_t count =0;
+    for (const auto& voice : voices_) {
+        if (voice.active) ++count;
+    }
+    return count;
+}
+//----------------------------------------
+
+void VoicePool::setReleaseFrames(size_t numFrames) {
+    releaseStep_ = numFrames > 0 ? 1.0f / numFrames : 1.0f;
+}
+//----------------------------------------
+
+bool VoicePool::isBetterVictim(const VoiceState& candidate, const VoiceState& current) const {
+    if (stealMode_ == VoiceStealMode::Quietest && candidate.level != current.level) {
+        return candidate.level < current.level;
+    }
+    return candidate.serial < current.serial;
+}
+//----------------------------------------
+
+void VoicePool::release(VoiceState& voice, size_t frameOffset) {
+    if (voice.startOffset > frameOffset) {
+        // La voix n'a pas encore démarré: rien à faire entendre
+        freeVoice(voice);
+        return;
+    }
+    voice.releasing = true;
+    voice.releaseOffset = frameOffset;
+    voice.releaseGain = 1.0f;
+}
+//----------------------------------------
+
+//==== End of class VoicePool ====
+
+} // namespace adikdrum
@@ -0,0 +1,82 @@
+#ifndef VOICEPOOL_H
+#define VOICEPOOL_H
+
+#include "samplebuffer.h"
+
+#include <vector>
+#include <type_traits>
+#include <cstddef> // Pour size_t
+#include <cstdint>
+
+namespace adikdrum {
+
+// Choix de la voix à voler quand la limite de polyphonie est atteinte
+enum class VoiceStealMode { Oldest, Quietest };
+
+// Une voix: une lecture en cours d'un son sur un canal du mixer.
+// Plusieurs voix peuvent jouer le même son: la position de lecture est dans la voix, pas dans le son.
+// Structure POD: le déclenchement ne fait que remplir une case, sans allocation ni compteur de références.
+struct VoiceState {
+    const SampleBuffer* buffer = nullptr; // Non possédé: gardé en vie par le son (AudioSound)
+    size_t channel =0;        // Canal du mixer (volume, pan, délai, mute)
+    uint64_t phase =0;        // Position de lecture en frames du son, en virgule fixe 32.32
+    uint64_t increment = resampler::phaseOne; // Avance de la phase par frame de sortie (vitesse)
+    float soundSpeed =1.0f;   // Vitesse propre du son au déclenchement, multipliée par celle du canal
+    size_t startOffset =0;    // Frames à attendre avant le démarrage, dans le prochain bloc mixé
+    bool active =false;
+    bool releasing =false;    // Fondu de sortie en cours (voix volée ou arrêtée)
+    size_t releaseOffset =0;  // Frames avant le début du fondu, dans le prochain bloc mixé
+    float releaseGain =1.0f;
+    float gain =1.0f;         // Vélocité du déclenchement (0 à 1), avant le volume du canal
+    float level =0.0f;        // Niveau crête du dernier bloc, pour VoiceStealMode::Quietest
+    uint64_t serial =0;       // Ordre de déclenchement, pour VoiceStealMode::Oldest
+    uint64_t epoch =0;        // Epoch du Reclaimer au déclenchement: buffer gardé en vie jusqu'à la fin de la voix
+    int streamSlot =-1;       // Flux du DiskStreamer, pour un son lu en continu (-1: aucun)
+};
+static_assert(std::is_trivially_copyable_v<VoiceState>, "VoiceState doit rester POD");
+
+// Réserve de voix de taille fixe, allouée une fois: le déclenchement d'un son
+// ne fait que réutiliser une case du tableau, quel que soit le nombre de coups.
+// maxVoices voix peuvent sonner en même temps; numTailVoices cases de plus servent
+// aux voix volées pendant leur fondu de sortie.
+// Utilisée par le thread audio uniquement (via AudioMixer).
+class VoicePool {
+public:
+    VoicePool(size_t maxVoices = 128, size_t numTailVoices = 16);
+
+    // Réserve une voix pour le canal, en volant une voix si la limite du canal
+    // (maxPolyphony, 0 = pas de limite) ou la limite globale est atteinte.
+    // Les voix volées commencent leur fondu à frameOffset.
+    VoiceState* allocate(size_t channel, size_t maxPolyphony, size_t frameOffset);
+    // Fondu de sortie de toutes les voix du canal
+    void releaseChannel(size_t channel, size_t frameOffset =0);
+    void releaseAll();
+    void clear(); // Arrêt immédiat, sans fondu
+    void freeVoice(VoiceState& voice);
+
+    std::vector<VoiceState>& getVoices() { return voices_; }
+    size_t getMaxVoices() const { return maxVoices_; }
+    size_t getNumActive() const;
+    size_t getNumSteals() const { return numSteals_; }
+    VoiceStealMode getStealMode() const { return stealMode_; }
+    void setStealMode(VoiceStealMode mode) { stealMode_ = mode; }
+    // Durée du fondu de sortie, en frames
+    void setReleaseFrames(size_t numFrames);
+    float getReleaseStep() const { return releaseStep_; }
+
+private:
+    std::vector<VoiceState> voices_;
+    size_t maxVoices_;
+    uint64_t nextSerial_ =0;
+    size_t numSteals_ =0;
+    VoiceStealMode stealMode_ = VoiceStealMode::Oldest;
+    float releaseStep_ =1.0f / 220; // Décrément du gain par frame pendant le fondu
+
+    bool isBetterVictim(const VoiceState& candidate, const VoiceState& current) const;
+    void release(VoiceState& voice, size_t frameOffset);
+};
+//==== End of class VoicePool ====
+
+} // namespace adikdrum
+
+#endif // VOICEPOOL_H